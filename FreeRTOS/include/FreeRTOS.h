@@ -671,6 +671,30 @@ extern "C" {
 	#define configUSE_TICKLESS_IDLE 0
 #endif
 
+#ifndef configUSE_TICK_TIMERS
+	#define configUSE_TICK_TIMERS 0
+#endif
+
+#if ( configUSE_TICK_TIMERS == 1 ) && ( configUSE_TIMERS == 0 )
+	#error configUSE_TICK_TIMERS requires configUSE_TIMERS to be set to 1
+#endif
+
+#ifndef configTIMER_TASK_ON_DEMAND
+	#define configTIMER_TASK_ON_DEMAND 0
+#endif
+
+#if ( configTIMER_TASK_ON_DEMAND == 1 ) && ( INCLUDE_xTimerPendFunctionCall == 1 )
+	#error configTIMER_TASK_ON_DEMAND cannot be used with INCLUDE_xTimerPendFunctionCall
+#endif
+
+#ifndef configUSE_TIMING_WHEEL
+	#define configUSE_TIMING_WHEEL 0
+#endif
+
+#ifndef configTIMING_WHEEL_BITS
+	#define configTIMING_WHEEL_BITS 4
+#endif
+
 #ifndef configPRE_SLEEP_PROCESSING
 	#define configPRE_SLEEP_PROCESSING( x )
 #endif
@@ -259,6 +259,38 @@ typedef void (*PendedFunction_t)( void *, uint32_t );
  */
 TimerHandle_t xTimerCreate( const char * const pcTimerName, const TickType_t xTimerPeriodInTicks, const UBaseType_t uxAutoReload, void * const pvTimerID, TimerCallbackFunction_t pxCallbackFunction ) PRIVILEGED_FUNCTION; /*lint !e971 Unqualified char types are allowed for strings and single characters only. */
 
+#if ( configUSE_TICK_TIMERS == 1 )
+
+/**
+ * TimerHandle_t xTimerCreateTick( 	const char * const pcTimerName,
+ * 									TickType_t xTimerPeriodInTicks,
+ * 									UBaseType_t uxAutoReload,
+ * 									void * pvTimerID,
+ * 									TimerCallbackFunction_t pxCallbackFunction );
+ *
+ * Creates a software timer whose callback is called by the tick interrupt,
+ * instead of by the timer service/daemon task.  The parameters and the return
+ * value are the same as for xTimerCreate().
+ *
+ * The commands for such a timer (xTimerStart(), xTimerStop(), etc.) are not
+ * queued to the timer service task, they take effect at once and never
+ * block.  The timer period starts at the tick count of the command.
+ *
+ * The callback runs in the tick interrupt, with the interrupts masked: it
+ * must be short, and may only call the FreeRTOS API functions that end in
+ * "FromISR" (the context switches they request are performed at the end of
+ * the tick interrupt) and the commands of timers created by this function.
+ * A timer created by this function cannot be deleted from its own callback.
+ *
+ * With configTIMER_TASK_ON_DEMAND set to 1 in FreeRTOSConfig.h, the timer
+ * service task and its command queue are created only with the first timer
+ * created by xTimerCreate(), so an application using only the timers of this
+ * function has no timer service task.
+ */
+TimerHandle_t xTimerCreateTick( const char * const pcTimerName, const TickType_t xTimerPeriodInTicks, const UBaseType_t uxAutoReload, void * const pvTimerID, TimerCallbackFunction_t pxCallbackFunction ) PRIVILEGED_FUNCTION; /*lint !e971 Unqualified char types are allowed for strings and single characters only. */
+
+#endif /* configUSE_TICK_TIMERS */
+
 /**
  * void *pvTimerGetTimerID( TimerHandle_t xTimer );
  *
@@ -1116,6 +1148,11 @@ const char * pcTimerGetTimerName( TimerHandle_t xTimer ); /*lint !e971 Unqualifi
 BaseType_t xTimerCreateTimerTask( void ) PRIVILEGED_FUNCTION;
 BaseType_t xTimerGenericCommand( TimerHandle_t xTimer, const BaseType_t xCommandID, const TickType_t xOptionalValue, BaseType_t * const pxHigherPriorityTaskWoken, const TickType_t xTicksToWait ) PRIVILEGED_FUNCTION;
 
+#if ( configUSE_TICK_TIMERS == 1 )
+	void vTimerProcessTickTimers( const TickType_t xTimeNow ) PRIVILEGED_FUNCTION;
+	TickType_t xTimerGetTickTimersIdleTime( const TickType_t xTimeNow ) PRIVILEGED_FUNCTION;
+#endif
+
 #ifdef __cplusplus
 }
 #endif
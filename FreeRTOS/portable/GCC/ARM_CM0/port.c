@@ -104,6 +104,19 @@ debugger. */
 variable. */
 static UBaseType_t uxCriticalNesting = 0xaaaaaaaa;
 
+#if configUSE_PORT_OPTIMISED_TASK_SELECTION == 1
+
+	/* Bit position of the top bit of a word with all the lower bits set,
+	indexed by the top 5 bits of its product with the De Bruijn constant
+	0x07C4ACDD (see uxPortGetHighestPriority() in portmacro.h). */
+	const uint8_t ucPortDeBruijnLog2[ 32 ] =
+	{
+		0, 9, 1, 10, 13, 21, 2, 29, 11, 14, 16, 18, 22, 25, 3, 30,
+		8, 12, 20, 28, 15, 17, 24, 7, 19, 27, 23, 6, 26, 5, 4, 31
+	};
+
+#endif /* configUSE_PORT_OPTIMISED_TASK_SELECTION */
+
 /*
  * Setup the timer to generate the tick interrupts.
  */
@@ -112,8 +125,8 @@ static void prvSetupTimerInterrupt( void );
 /*
  * Exception handlers.
  */
-void xPortPendSVHandler( void ) __attribute__ (( naked ));
-void xPortSysTickHandler( void );
+void xPortPendSVHandler( void ) __attribute__ (( naked )) RAMFUNC;
+void xPortSysTickHandler( void ) RAMFUNC;
 void vPortSVCHandler( void );
 
 /*
@@ -143,6 +143,62 @@ extern void vClearInterruptMaskFromISR( uint32_t ulMask )  __attribute__((naked)
 
 /*-----------------------------------------------------------*/
 
+/* Architecture specific optimisations. */
+#ifndef configUSE_PORT_OPTIMISED_TASK_SELECTION
+	#define configUSE_PORT_OPTIMISED_TASK_SELECTION 1
+#endif
+
+#if configUSE_PORT_OPTIMISED_TASK_SELECTION == 1
+
+	/* The Cortex-M0 has no CLZ instruction, so the highest priority in the
+	ready bitmap is found with a De Bruijn multiply: the bits below the top
+	one are set, then the multiply places a unique 5 bit pattern in the top
+	bits of the product, used as index in a table of bit positions.  The M0
+	multiplier is single cycle, the lookup is constant time whatever the
+	number of ready priorities. */
+
+	/* Check the configuration. */
+	#if( configMAX_PRIORITIES > 32 )
+		#error configUSE_PORT_OPTIMISED_TASK_SELECTION can only be set to 1 when configMAX_PRIORITIES is less than or equal to 32.  It is very rare that a system requires more than 10 to 15 difference priorities as tasks that share a priority will time slice.
+	#endif
+
+	extern const uint8_t ucPortDeBruijnLog2[ 32 ];
+
+	static inline UBaseType_t uxPortGetHighestPriority( UBaseType_t uxReadyPriorities ) __attribute__(( always_inline ));
+	static inline UBaseType_t uxPortGetHighestPriority( UBaseType_t uxReadyPriorities )
+	{
+	uint32_t ulBits = ( uint32_t ) uxReadyPriorities;
+
+		/* Only the shifts needed to cover the configured priorities. */
+		ulBits |= ulBits >> 1UL;
+		#if( configMAX_PRIORITIES > 2 )
+			ulBits |= ulBits >> 2UL;
+		#endif
+		#if( configMAX_PRIORITIES > 4 )
+			ulBits |= ulBits >> 4UL;
+		#endif
+		#if( configMAX_PRIORITIES > 8 )
+			ulBits |= ulBits >> 8UL;
+		#endif
+		#if( configMAX_PRIORITIES > 16 )
+			ulBits |= ulBits >> 16UL;
+		#endif
+
+		return ( UBaseType_t ) ucPortDeBruijnLog2[ ( ulBits * 0x07C4ACDDUL ) >> 27UL ];
+	}
+
+	/* Store/clear the ready priorities in a bit map. */
+	#define portRECORD_READY_PRIORITY( uxPriority, uxReadyPriorities ) ( uxReadyPriorities ) |= ( 1UL << ( uxPriority ) )
+	#define portRESET_READY_PRIORITY( uxPriority, uxReadyPriorities ) ( uxReadyPriorities ) &= ~( 1UL << ( uxPriority ) )
+
+	/*-----------------------------------------------------------*/
+
+	#define portGET_HIGHEST_PRIORITY( uxTopPriority, uxReadyPriorities ) uxTopPriority = uxPortGetHighestPriority( ( uxReadyPriorities ) )
+
+#endif /* configUSE_PORT_OPTIMISED_TASK_SELECTION */
+
+/*-----------------------------------------------------------*/
+
 /* Task function macros as described on the FreeRTOS.org WEB site. */
 #define portTASK_FUNCTION_PROTO( vFunction, pvParameters ) void vFunction( void *pvParameters )
 #define portTASK_FUNCTION( vFunction, pvParameters ) void vFunction( void *pvParameters )
@@ -110,6 +110,28 @@ functions but without including stdio.h here. */
  */
 #define tskIDLE_STACK_SIZE	configMINIMAL_STACK_SIZE
 
+#if ( configUSE_TIMING_WHEEL == 1 )
+
+	#if ( configTIMING_WHEEL_BITS < 1 ) || ( configTIMING_WHEEL_BITS > 8 )
+		#error configTIMING_WHEEL_BITS must be between 1 and 8
+	#endif
+
+	/* The timing wheel has two levels of tskWHEEL_SLOTS lists: a slot of the
+	first level holds the tasks waking at one tick, a slot of the second the
+	tasks waking during one turn of the first level.  Tasks waking later than
+	tskWHEEL_SPAN ticks are kept in the sorted delayed lists. */
+	#define tskWHEEL_SLOTS		( ( TickType_t ) 1U << configTIMING_WHEEL_BITS )
+	#define tskWHEEL_MASK		( tskWHEEL_SLOTS - ( TickType_t ) 1U )
+	#define tskWHEEL_SPAN		( tskWHEEL_SLOTS * tskWHEEL_SLOTS )
+
+	#define taskIS_WHEEL_LIST( pxList ) ( ( ( pxList ) >= &( xTimingWheel[ 0 ][ 0 ] ) ) && ( ( pxList ) <= &( xTimingWheel[ 1 ][ tskWHEEL_MASK ] ) ) )
+
+#else
+
+	#define taskIS_WHEEL_LIST( pxList ) pdFALSE
+
+#endif /* configUSE_TIMING_WHEEL */
+
 #if( configUSE_PREEMPTION == 0 )
 	/* If the cooperative scheduler is being used then a yield should not be
 	performed just because a higher priority task has been woken. */
@@ -215,6 +237,12 @@ PRIVILEGED_DATA static List_t * volatile pxDelayedTaskList;				/*< Points to the
 PRIVILEGED_DATA static List_t * volatile pxOverflowDelayedTaskList;		/*< Points to the delayed task list currently being used to hold tasks that have overflowed the current tick count. */
 PRIVILEGED_DATA static List_t xPendingReadyList;						/*< Tasks that have been readied while the scheduler was suspended.  They will be moved to the ready list when the scheduler is resumed. */
 
+#if ( configUSE_TIMING_WHEEL == 1 )
+
+	PRIVILEGED_DATA static List_t xTimingWheel[ 2 ][ tskWHEEL_SLOTS ];	/*< Delayed tasks waking within tskWHEEL_SPAN ticks, unsorted. */
+
+#endif
+
 #if ( INCLUDE_vTaskDelete == 1 )
 
 	PRIVILEGED_DATA static List_t xTasksWaitingTermination;				/*< Tasks that have been deleted - but their memory not yet freed. */
@@ -533,6 +561,30 @@ static TCB_t *prvAllocateTCBAndStack( const uint16_t usStackDepth, StackType_t *
  */
 static void prvResetNextTaskUnblockTime( void );
 
+#if ( configUSE_TIMING_WHEEL == 1 )
+
+	/*
+	 * Place the list item of a delayed task, whose value is its wake time, in
+	 * the timing wheel, or in the sorted delayed lists if it wakes later than
+	 * the span of the wheel.
+	 */
+	static void prvWheelInsert( ListItem_t * const pxItem, const TickType_t xNow ) PRIVILEGED_FUNCTION;
+
+	/*
+	 * Return the tick at which the tick interrupt must next handle a task
+	 * placed at xNow: its wake time in the first level of the wheel, the start
+	 * of its slot in the second, its move to the wheel otherwise.
+	 */
+	static TickType_t prvWheelEventTime( const TickType_t xTimeToWake, const TickType_t xNow ) PRIVILEGED_FUNCTION;
+
+	/*
+	 * Advance the timing wheel to xNow and unblock the tasks that wake at
+	 * xNow.  Returns pdTRUE if a context switch is required.
+	 */
+	static BaseType_t prvWheelTick( const TickType_t xNow ) PRIVILEGED_FUNCTION;
+
+#endif
+
 #if ( ( configUSE_TRACE_FACILITY == 1 ) && ( configUSE_STATS_FORMATTING_FUNCTIONS > 0 ) )
 
 	/*
@@ -1002,7 +1054,7 @@ StackType_t *pxTopOfStack;
 			}
 			taskEXIT_CRITICAL();
 
-			if( ( pxStateList == pxDelayedTaskList ) || ( pxStateList == pxOverflowDelayedTaskList ) )
+			if( ( pxStateList == pxDelayedTaskList ) || ( pxStateList == pxOverflowDelayedTaskList ) || taskIS_WHEEL_LIST( pxStateList ) )
 			{
 				/* The task being queried is referenced from one of the Blocked
 				lists. */
@@ -1640,6 +1692,9 @@ void vTaskSuspendAll( void )
 	static TickType_t prvGetExpectedIdleTime( void )
 	{
 	TickType_t xReturn;
+	#if ( configUSE_TICK_TIMERS == 1 )
+		TickType_t xTicks;
+	#endif
 
 		if( pxCurrentTCB->uxPriority > tskIDLE_PRIORITY )
 		{
@@ -1655,6 +1710,21 @@ void vTaskSuspendAll( void )
 		else
 		{
 			xReturn = xNextTaskUnblockTime - xTickCount;
+
+			#if ( configUSE_TICK_TIMERS == 1 )
+			{
+				/* The timers run by the tick interrupt need their ticks too. */
+				xTicks = xTimerGetTickTimersIdleTime( xTickCount );
+				if( xTicks < xReturn )
+				{
+					xReturn = xTicks;
+				}
+				else
+				{
+					mtCOVERAGE_TEST_MARKER();
+				}
+			}
+			#endif /* configUSE_TICK_TIMERS */
 		}
 
 		return xReturn;
@@ -1850,6 +1920,20 @@ UBaseType_t uxTaskGetNumberOfTasks( void )
 				uxTask += prvListTaskWithinSingleList( &( pxTaskStatusArray[ uxTask ] ), ( List_t * ) pxDelayedTaskList, eBlocked );
 				uxTask += prvListTaskWithinSingleList( &( pxTaskStatusArray[ uxTask ] ), ( List_t * ) pxOverflowDelayedTaskList, eBlocked );
 
+				#if( configUSE_TIMING_WHEEL == 1 )
+				{
+				UBaseType_t uxLevel, uxSlot;
+
+					for( uxLevel = ( UBaseType_t ) 0U; uxLevel < ( UBaseType_t ) 2U; uxLevel++ )
+					{
+						for( uxSlot = ( UBaseType_t ) 0U; uxSlot < ( UBaseType_t ) tskWHEEL_SLOTS; uxSlot++ )
+						{
+							uxTask += prvListTaskWithinSingleList( &( pxTaskStatusArray[ uxTask ] ), &( xTimingWheel[ uxLevel ][ uxSlot ] ), eBlocked );
+						}
+					}
+				}
+				#endif
+
 				#if( INCLUDE_vTaskDelete == 1 )
 				{
 					/* Fill in an TaskStatus_t structure with information on
@@ -1931,10 +2015,12 @@ implementations require configUSE_TICKLESS_IDLE to be set to a value other than
 #endif /* configUSE_TICKLESS_IDLE */
 /*----------------------------------------------------------*/
 
-BaseType_t xTaskIncrementTick( void )
+RAMFUNC BaseType_t xTaskIncrementTick( void )
 {
-TCB_t * pxTCB;
-TickType_t xItemValue;
+#if ( configUSE_TIMING_WHEEL == 0 )
+	TCB_t * pxTCB;
+	TickType_t xItemValue;
+#endif
 BaseType_t xSwitchRequired = pdFALSE;
 
 	/* Called by the portable layer each time a tick interrupt occurs.
@@ -1961,6 +2047,26 @@ BaseType_t xSwitchRequired = pdFALSE;
 				mtCOVERAGE_TEST_MARKER();
 			}
 
+			#if ( configUSE_TIMING_WHEEL == 1 )
+			{
+				/* xNextTaskUnblockTime is the next tick at which the wheel
+				has work to do.  Wake times past the tick count overflow are not
+				recorded in it, so the wheel is also processed at the overflow. */
+				if( ( xConstTickCount >= xNextTaskUnblockTime ) || ( xConstTickCount == ( TickType_t ) 0U ) )
+				{
+					if( prvWheelTick( xConstTickCount ) != pdFALSE )
+					{
+						xSwitchRequired = pdTRUE;
+					}
+					else
+					{
+						mtCOVERAGE_TEST_MARKER();
+					}
+
+					prvResetNextTaskUnblockTime();
+				}
+			}
+			#else
 			/* See if this tick has made a timeout expire.  Tasks are stored in
 			the	queue in the order of their wake time - meaning once one task
 			has been found whose block time has not expired there is no need to
@@ -2042,8 +2148,17 @@ BaseType_t xSwitchRequired = pdFALSE;
 					}
 				}
 			}
+			#endif /* configUSE_TIMING_WHEEL */
 		}
 
+		/* The callbacks of the timers run by the tick interrupt.  The tasks
+		they unblock set xYieldPending, checked below. */
+		#if ( configUSE_TICK_TIMERS == 1 )
+		{
+			vTimerProcessTickTimers( xTickCount );
+		}
+		#endif /* configUSE_TICK_TIMERS */
+
 		/* Tasks of equal priority to the currently running task will share
 		processing time (time slice) if preemption is on, and the application
 		writer has not explicitly turned time slicing off. */
@@ -2195,7 +2310,7 @@ BaseType_t xSwitchRequired = pdFALSE;
 #endif /* configUSE_APPLICATION_TASK_TAG */
 /*-----------------------------------------------------------*/
 
-void vTaskSwitchContext( void )
+RAMFUNC void vTaskSwitchContext( void )
 {
 	if( uxSchedulerSuspended != ( UBaseType_t ) pdFALSE )
 	{
@@ -2475,7 +2590,7 @@ BaseType_t xReturn;
 		xReturn = pdFALSE;
 	}
 
-	#if( configUSE_TICKLESS_IDLE == 1 )
+	#if( ( configUSE_TICKLESS_IDLE == 1 ) && ( configUSE_TIMING_WHEEL == 0 ) )
 	{
 		/* If a task is blocked on a kernel object then xNextTaskUnblockTime
 		might be set to the blocked task's time out time.  If the task is
@@ -2484,7 +2599,9 @@ BaseType_t xReturn;
 		value when the tick count equals xNextTaskUnblockTime.  However if
 		tickless idling is used it might be more important to enter sleep mode
 		at the earliest possible time - so reset xNextTaskUnblockTime here to
-		ensure it is updated at the earliest possible time. */
+		ensure it is updated at the earliest possible time.  This is not done
+		with the timing wheel, where the update scans the wheel: the value left
+		is early, which costs at most one early wake up. */
 		prvResetNextTaskUnblockTime();
 	}
 	#endif
@@ -2926,6 +3043,18 @@ UBaseType_t uxPriority;
 	vListInitialise( &xDelayedTaskList2 );
 	vListInitialise( &xPendingReadyList );
 
+	#if ( configUSE_TIMING_WHEEL == 1 )
+	{
+	UBaseType_t uxSlot;
+
+		for( uxSlot = ( UBaseType_t ) 0U; uxSlot < ( UBaseType_t ) tskWHEEL_SLOTS; uxSlot++ )
+		{
+			vListInitialise( &( xTimingWheel[ 0 ][ uxSlot ] ) );
+			vListInitialise( &( xTimingWheel[ 1 ][ uxSlot ] ) );
+		}
+	}
+	#endif /* configUSE_TIMING_WHEEL */
+
 	#if ( INCLUDE_vTaskDelete == 1 )
 	{
 		vListInitialise( &xTasksWaitingTermination );
@@ -2991,6 +3120,26 @@ static void prvAddCurrentTaskToDelayedList( const TickType_t xTimeToWake )
 	/* The list item will be inserted in wake time order. */
 	listSET_LIST_ITEM_VALUE( &( pxCurrentTCB->xGenericListItem ), xTimeToWake );
 
+	#if ( configUSE_TIMING_WHEEL == 1 )
+	{
+	const TickType_t xConstTickCount = xTickCount;
+	TickType_t xEventTime;
+
+		prvWheelInsert( &( pxCurrentTCB->xGenericListItem ), xConstTickCount );
+
+		/* Events past the tick count overflow are not recorded, the wheel is
+		processed at the overflow anyway. */
+		xEventTime = prvWheelEventTime( xTimeToWake, xConstTickCount );
+		if( ( xEventTime > xConstTickCount ) && ( xEventTime < xNextTaskUnblockTime ) )
+		{
+			xNextTaskUnblockTime = xEventTime;
+		}
+		else
+		{
+			mtCOVERAGE_TEST_MARKER();
+		}
+	}
+	#else
 	if( xTimeToWake < xTickCount )
 	{
 		/* Wake time has overflowed.  Place this item in the overflow list. */
@@ -3013,9 +3162,144 @@ static void prvAddCurrentTaskToDelayedList( const TickType_t xTimeToWake )
 			mtCOVERAGE_TEST_MARKER();
 		}
 	}
+	#endif /* configUSE_TIMING_WHEEL */
 }
 /*-----------------------------------------------------------*/
 
+#if ( configUSE_TIMING_WHEEL == 1 )
+
+	static void prvWheelInsert( ListItem_t * const pxItem, const TickType_t xNow )
+	{
+	const TickType_t xTimeToWake = listGET_LIST_ITEM_VALUE( pxItem );
+	const TickType_t xDelta = xTimeToWake - xNow;
+
+		if( xDelta < tskWHEEL_SLOTS )
+		{
+			vListInsertEnd( &( xTimingWheel[ 0 ][ xTimeToWake & tskWHEEL_MASK ] ), pxItem );
+		}
+		else if( xDelta < tskWHEEL_SPAN )
+		{
+			vListInsertEnd( &( xTimingWheel[ 1 ][ ( xTimeToWake >> configTIMING_WHEEL_BITS ) & tskWHEEL_MASK ] ), pxItem );
+		}
+		else if( xTimeToWake < xNow )
+		{
+			/* Wake time has overflowed.  Place this item in the overflow list. */
+			vListInsert( pxOverflowDelayedTaskList, pxItem );
+		}
+		else
+		{
+			vListInsert( pxDelayedTaskList, pxItem );
+		}
+	}
+	/*-----------------------------------------------------------*/
+
+	static TickType_t prvWheelEventTime( const TickType_t xTimeToWake, const TickType_t xNow )
+	{
+	const TickType_t xDelta = xTimeToWake - xNow;
+	TickType_t xReturn;
+
+		if( xDelta < tskWHEEL_SLOTS )
+		{
+			xReturn = xTimeToWake;
+		}
+		else if( xDelta < tskWHEEL_SPAN )
+		{
+			/* Moved to the first level at the start of its turn. */
+			xReturn = xTimeToWake & ~tskWHEEL_MASK;
+		}
+		else
+		{
+			/* Moved to the wheel at the first turn that starts less than
+			tskWHEEL_SPAN ticks before the wake time. */
+			xReturn = ( ( xTimeToWake - tskWHEEL_SPAN ) | tskWHEEL_MASK ) + ( TickType_t ) 1U;
+		}
+
+		return xReturn;
+	}
+	/*-----------------------------------------------------------*/
+
+	static RAMFUNC BaseType_t prvWheelTick( const TickType_t xNow )
+	{
+	List_t *pxList;
+	ListItem_t *pxItem;
+	TCB_t *pxTCB;
+	UBaseType_t uxItems;
+	BaseType_t xSwitchRequired = pdFALSE;
+
+		if( ( xNow & tskWHEEL_MASK ) == ( TickType_t ) 0U )
+		{
+			/* A new turn of the first level starts: spread the tasks of the
+			matching second level slot over the first level, then move the
+			tasks of the sorted delayed list that now wake within the span of
+			the wheel.  The items are counted so that the loop ends even if an
+			item is put back in the same slot. */
+			pxList = &( xTimingWheel[ 1 ][ ( xNow >> configTIMING_WHEEL_BITS ) & tskWHEEL_MASK ] );
+			for( uxItems = listCURRENT_LIST_LENGTH( pxList ); uxItems > ( UBaseType_t ) 0U; uxItems-- )
+			{
+				pxItem = listGET_HEAD_ENTRY( pxList );
+				( void ) uxListRemove( pxItem );
+				prvWheelInsert( pxItem, xNow );
+			}
+
+			while( listLIST_IS_EMPTY( pxDelayedTaskList ) == pdFALSE )
+			{
+				pxItem = listGET_HEAD_ENTRY( pxDelayedTaskList );
+				if( ( listGET_LIST_ITEM_VALUE( pxItem ) - xNow ) >= tskWHEEL_SPAN )
+				{
+					break;
+				}
+				( void ) uxListRemove( pxItem );
+				prvWheelInsert( pxItem, xNow );
+			}
+		}
+		else
+		{
+			mtCOVERAGE_TEST_MARKER();
+		}
+
+		/* All the tasks in the current slot wake at this tick. */
+		pxList = &( xTimingWheel[ 0 ][ xNow & tskWHEEL_MASK ] );
+		while( listLIST_IS_EMPTY( pxList ) == pdFALSE )
+		{
+			pxTCB = ( TCB_t * ) listGET_OWNER_OF_HEAD_ENTRY( pxList );
+			configASSERT( listGET_LIST_ITEM_VALUE( &( pxTCB->xGenericListItem ) ) == xNow );
+			( void ) uxListRemove( &( pxTCB->xGenericListItem ) );
+
+			/* Is the task waiting on an event also?  If so remove it from the
+			event list. */
+			if( listLIST_ITEM_CONTAINER( &( pxTCB->xEventListItem ) ) != NULL )
+			{
+				( void ) uxListRemove( &( pxTCB->xEventListItem ) );
+			}
+			else
+			{
+				mtCOVERAGE_TEST_MARKER();
+			}
+
+			prvAddTaskToReadyList( pxTCB );
+
+			/* A task being unblocked cannot cause an immediate context switch
+			if preemption is turned off. */
+			#if (  configUSE_PREEMPTION == 1 )
+			{
+				if( pxTCB->uxPriority >= pxCurrentTCB->uxPriority )
+				{
+					xSwitchRequired = pdTRUE;
+				}
+				else
+				{
+					mtCOVERAGE_TEST_MARKER();
+				}
+			}
+			#endif /* configUSE_PREEMPTION */
+		}
+
+		return xSwitchRequired;
+	}
+
+#endif /* configUSE_TIMING_WHEEL */
+/*-----------------------------------------------------------*/
+
 static TCB_t *prvAllocateTCBAndStack( const uint16_t usStackDepth, StackType_t * const puxStackBuffer )
 {
 TCB_t *pxNewTCB;
@@ -3262,6 +3546,67 @@ TCB_t *pxNewTCB;
 #endif /* INCLUDE_vTaskDelete */
 /*-----------------------------------------------------------*/
 
+#if ( configUSE_TIMING_WHEEL == 1 )
+
+static void prvResetNextTaskUnblockTime( void )
+{
+const TickType_t xNow = xTickCount;
+TickType_t xNext = portMAX_DELAY, xTime, xDelta;
+
+	/* The next non-empty slot of the first level, the start of the turn of
+	the next non-empty slot of the second level, and the turn at which the
+	head of the sorted delayed list moves to the wheel.  Times past the tick
+	count overflow are ignored, the wheel is processed at the overflow. */
+	for( xDelta = ( TickType_t ) 1U; xDelta < tskWHEEL_SLOTS; xDelta++ )
+	{
+		if( listLIST_IS_EMPTY( &( xTimingWheel[ 0 ][ ( xNow + xDelta ) & tskWHEEL_MASK ] ) ) == pdFALSE )
+		{
+			xTime = xNow + xDelta;
+			if( xTime > xNow )
+			{
+				xNext = xTime;
+			}
+			break;
+		}
+	}
+
+	for( xDelta = ( TickType_t ) 1U; xDelta <= tskWHEEL_SLOTS; xDelta++ )
+	{
+		if( listLIST_IS_EMPTY( &( xTimingWheel[ 1 ][ ( ( xNow >> configTIMING_WHEEL_BITS ) + xDelta ) & tskWHEEL_MASK ] ) ) == pdFALSE )
+		{
+			xTime = ( ( xNow >> configTIMING_WHEEL_BITS ) + xDelta ) << configTIMING_WHEEL_BITS;
+			if( ( xTime > xNow ) && ( xTime < xNext ) )
+			{
+				xNext = xTime;
+			}
+			break;
+		}
+	}
+
+	if( listLIST_IS_EMPTY( pxDelayedTaskList ) == pdFALSE )
+	{
+		xTime = listGET_LIST_ITEM_VALUE( listGET_HEAD_ENTRY( pxDelayedTaskList ) );
+		if( ( xTime - xNow ) < tskWHEEL_SPAN )
+		{
+			/* Moves at the next turn. */
+			xTime = ( xNow | tskWHEEL_MASK ) + ( TickType_t ) 1U;
+		}
+		else
+		{
+			xTime = prvWheelEventTime( xTime, xNow );
+		}
+
+		if( ( xTime > xNow ) && ( xTime < xNext ) )
+		{
+			xNext = xTime;
+		}
+	}
+
+	xNextTaskUnblockTime = xNext;
+}
+
+#else
+
 static void prvResetNextTaskUnblockTime( void )
 {
 TCB_t *pxTCB;
@@ -3285,6 +3630,8 @@ TCB_t *pxTCB;
 		xNextTaskUnblockTime = listGET_LIST_ITEM_VALUE( &( ( pxTCB )->xGenericListItem ) );
 	}
 }
+
+#endif /* configUSE_TIMING_WHEEL */
 /*-----------------------------------------------------------*/
 
 #if ( ( INCLUDE_xTaskGetCurrentTaskHandle == 1 ) || ( configUSE_MUTEXES == 1 ) )
@@ -112,6 +112,9 @@ typedef struct tmrTimerControl
 	#if( configUSE_TRACE_FACILITY == 1 )
 		UBaseType_t			uxTimerNumber;		/*<< An ID assigned by trace tools such as FreeRTOS+Trace */
 	#endif
+	#if( configUSE_TICK_TIMERS == 1 )
+		UBaseType_t			uxInTick;			/*<< Set to pdTRUE if the callback is called by the tick interrupt rather than by the timer service task. */
+	#endif
 } xTIMER;
 
 /* The old xTIMER name is maintained above then typedefed to the new Timer_t
@@ -165,6 +168,18 @@ PRIVILEGED_DATA static List_t xActiveTimerList2;
 PRIVILEGED_DATA static List_t *pxCurrentTimerList;
 PRIVILEGED_DATA static List_t *pxOverflowTimerList;
 
+#if ( configUSE_TICK_TIMERS == 1 )
+
+	/* The lists of the active timers whose callback is called by the tick
+	interrupt, in expire time order.  They are accessed by the tick interrupt
+	and, with the interrupts masked, by the timer commands. */
+	PRIVILEGED_DATA static List_t xTickTimerList1;
+	PRIVILEGED_DATA static List_t xTickTimerList2;
+	PRIVILEGED_DATA static List_t *pxCurrentTickTimerList;
+	PRIVILEGED_DATA static List_t *pxOverflowTickTimerList;
+
+#endif
+
 /* A queue that is used to send commands to the timer service task. */
 PRIVILEGED_DATA static QueueHandle_t xTimerQueue = NULL;
 
@@ -174,15 +189,30 @@ PRIVILEGED_DATA static QueueHandle_t xTimerQueue = NULL;
 
 #endif
 
+#if ( configTIMER_TASK_ON_DEMAND == 1 )
+
+	/* Set once the timer service task exists; it is created with the first
+	timer that needs it, so an application using only tick timers doesn't pay
+	for its stack, TCB and queue. */
+	PRIVILEGED_DATA static BaseType_t xTimerTaskCreated = pdFALSE;
+
+#endif
+
 /*lint +e956 */
 
 /*-----------------------------------------------------------*/
 
 /*
  * Initialise the infrastructure used by the timer service task if it has not
- * been initialised already.
+ * been initialised already.  The queue is created only if xCreateQueue is
+ * pdTRUE; the lists are always initialised.
+ */
+static void prvCheckForValidListAndQueue( const BaseType_t xCreateQueue ) PRIVILEGED_FUNCTION;
+
+/*
+ * Allocate and initialise a timer, for xTimerCreate() and xTimerCreateTick().
  */
-static void prvCheckForValidListAndQueue( void ) PRIVILEGED_FUNCTION;
+static TimerHandle_t prvTimerCreate( const char * const pcTimerName, const TickType_t xTimerPeriodInTicks, const UBaseType_t uxAutoReload, void * const pvTimerID, TimerCallbackFunction_t pxCallbackFunction, const UBaseType_t uxInTick ) PRIVILEGED_FUNCTION; /*lint !e971 Unqualified char types are allowed for strings and single characters only. */
 
 /*
  * The timer service task (daemon).  Timer functionality is controlled by this
@@ -205,7 +235,8 @@ static BaseType_t prvInsertTimerInActiveList( Timer_t * const pxTimer, const Tic
 
 /*
  * An active timer has reached its expire time.  Reload the timer if it is an
- * auto reload timer, then call its callback.
+ * auto reload timer, then call its callback.  prvProcessTimerOrBlockTask()
+ * calls it for every timer that expired by the time it sampled, in one pass.
  */
 static void prvProcessExpiredTimer( const TickType_t xNextExpireTime, const TickType_t xTimeNow ) PRIVILEGED_FUNCTION;
 
@@ -235,6 +266,22 @@ static TickType_t prvGetNextExpireTime( BaseType_t * const pxListWasEmpty ) PRIV
  */
 static void prvProcessTimerOrBlockTask( const TickType_t xNextExpireTime, const BaseType_t xListWasEmpty ) PRIVILEGED_FUNCTION;
 
+#if ( configUSE_TICK_TIMERS == 1 )
+
+	/*
+	 * Insert a timer run by the tick interrupt in the current or the overflow
+	 * tick timer list, to expire one period after xTimeNow.
+	 */
+	static void prvInsertTickTimer( Timer_t * const pxTimer, const TickType_t xTimeNow ) PRIVILEGED_FUNCTION;
+
+	/*
+	 * Execute a command on a timer run by the tick interrupt.  Called by
+	 * xTimerGenericCommand() from tasks and interrupts.
+	 */
+	static BaseType_t prvTickTimerCommand( Timer_t * const pxTimer, const BaseType_t xCommandID, const TickType_t xOptionalValue ) PRIVILEGED_FUNCTION;
+
+#endif
+
 /*-----------------------------------------------------------*/
 
 BaseType_t xTimerCreateTimerTask( void )
@@ -245,7 +292,19 @@ BaseType_t xReturn = pdFAIL;
 	configUSE_TIMERS is set to 1.  Check that the infrastructure used by the
 	timer service task has been created/initialised.  If timers have already
 	been created then the initialisation will already have been performed. */
-	prvCheckForValidListAndQueue();
+	#if ( configTIMER_TASK_ON_DEMAND == 1 )
+	prvCheckForValidListAndQueue( pdFALSE );
+
+	if( ( xTimerQueue == NULL ) || ( xTimerTaskCreated != pdFALSE ) )
+	{
+		/* No timer needs the task yet (the first one will create it), or it
+		exists already. */
+		xReturn = pdPASS;
+	}
+	else
+	#else
+	prvCheckForValidListAndQueue( pdTRUE );
+	#endif /* configTIMER_TASK_ON_DEMAND */
 
 	if( xTimerQueue != NULL )
 	{
@@ -261,6 +320,12 @@ BaseType_t xReturn = pdFAIL;
 			xReturn = xTaskCreate( prvTimerTask, "Tmr Svc", ( uint16_t ) configTIMER_TASK_STACK_DEPTH, NULL, ( ( UBaseType_t ) configTIMER_TASK_PRIORITY ) | portPRIVILEGE_BIT, NULL);
 		}
 		#endif
+
+		#if ( configTIMER_TASK_ON_DEMAND == 1 )
+		{
+			xTimerTaskCreated = xReturn;
+		}
+		#endif
 	}
 	else
 	{
@@ -273,6 +338,12 @@ BaseType_t xReturn = pdFAIL;
 /*-----------------------------------------------------------*/
 
 TimerHandle_t xTimerCreate( const char * const pcTimerName, const TickType_t xTimerPeriodInTicks, const UBaseType_t uxAutoReload, void * const pvTimerID, TimerCallbackFunction_t pxCallbackFunction ) /*lint !e971 Unqualified char types are allowed for strings and single characters only. */
+{
+	return prvTimerCreate( pcTimerName, xTimerPeriodInTicks, uxAutoReload, pvTimerID, pxCallbackFunction, pdFALSE );
+}
+/*-----------------------------------------------------------*/
+
+static TimerHandle_t prvTimerCreate( const char * const pcTimerName, const TickType_t xTimerPeriodInTicks, const UBaseType_t uxAutoReload, void * const pvTimerID, TimerCallbackFunction_t pxCallbackFunction, const UBaseType_t uxInTick ) /*lint !e971 Unqualified char types are allowed for strings and single characters only. */
 {
 Timer_t *pxNewTimer;
 
@@ -287,8 +358,9 @@ Timer_t *pxNewTimer;
 		if( pxNewTimer != NULL )
 		{
 			/* Ensure the infrastructure used by the timer service task has been
-			created/initialised. */
-			prvCheckForValidListAndQueue();
+			created/initialised; the timers run by the tick don't need the
+			queue. */
+			prvCheckForValidListAndQueue( ( uxInTick == pdFALSE ) ? pdTRUE : pdFALSE );
 
 			/* Initialise the timer structure members using the function parameters. */
 			pxNewTimer->pcTimerName = pcTimerName;
@@ -298,6 +370,35 @@ Timer_t *pxNewTimer;
 			pxNewTimer->pxCallbackFunction = pxCallbackFunction;
 			vListInitialiseItem( &( pxNewTimer->xTimerListItem ) );
 
+			#if ( configUSE_TICK_TIMERS == 1 )
+			{
+				pxNewTimer->uxInTick = uxInTick;
+			}
+			#else
+			{
+				( void ) uxInTick;
+			}
+			#endif
+
+			/* The first timer of the service task created once the scheduler
+			runs creates the task. */
+			#if ( configTIMER_TASK_ON_DEMAND == 1 )
+			{
+				if( ( uxInTick == pdFALSE ) && ( xTaskGetSchedulerState() != taskSCHEDULER_NOT_STARTED ) )
+				{
+					vTaskSuspendAll();
+					{
+						if( xTimerCreateTimerTask() == pdFAIL )
+						{
+							vPortFree( pxNewTimer );
+							pxNewTimer = NULL;
+						}
+					}
+					( void ) xTaskResumeAll();
+				}
+			}
+			#endif
+
 			traceTIMER_CREATE( pxNewTimer );
 		}
 		else
@@ -313,11 +414,33 @@ Timer_t *pxNewTimer;
 }
 /*-----------------------------------------------------------*/
 
+#if ( configUSE_TICK_TIMERS == 1 )
+
+	TimerHandle_t xTimerCreateTick( const char * const pcTimerName, const TickType_t xTimerPeriodInTicks, const UBaseType_t uxAutoReload, void * const pvTimerID, TimerCallbackFunction_t pxCallbackFunction ) /*lint !e971 Unqualified char types are allowed for strings and single characters only. */
+	{
+		return prvTimerCreate( pcTimerName, xTimerPeriodInTicks, uxAutoReload, pvTimerID, pxCallbackFunction, pdTRUE );
+	}
+
+#endif /* configUSE_TICK_TIMERS */
+/*-----------------------------------------------------------*/
+
 BaseType_t xTimerGenericCommand( TimerHandle_t xTimer, const BaseType_t xCommandID, const TickType_t xOptionalValue, BaseType_t * const pxHigherPriorityTaskWoken, const TickType_t xTicksToWait )
 {
 BaseType_t xReturn = pdFAIL;
 DaemonTaskMessage_t xMessage;
 
+	configASSERT( xTimer );
+
+	#if ( configUSE_TICK_TIMERS == 1 )
+	if( ( ( Timer_t * ) xTimer )->uxInTick != pdFALSE )
+	{
+		/* The timers run by the tick interrupt don't go through the timer
+		service task. */
+		xReturn = prvTickTimerCommand( ( Timer_t * ) xTimer, xCommandID, xOptionalValue );
+	}
+	else
+	#endif /* configUSE_TICK_TIMERS */
+
 	/* Send a message to the timer service task to perform a particular action
 	on a particular timer definition. */
 	if( xTimerQueue != NULL )
@@ -441,7 +564,7 @@ BaseType_t xListWasEmpty;
 
 static void prvProcessTimerOrBlockTask( const TickType_t xNextExpireTime, const BaseType_t xListWasEmpty )
 {
-TickType_t xTimeNow;
+TickType_t xTimeNow, xExpireTime;
 BaseType_t xTimerListsWereSwitched;
 
 	vTaskSuspendAll();
@@ -459,6 +582,21 @@ BaseType_t xTimerListsWereSwitched;
 			{
 				( void ) xTaskResumeAll();
 				prvProcessExpiredTimer( xNextExpireTime, xTimeNow );
+
+				/* Batch the other timers that expired by xTimeNow, instead of
+				going back through the command queue and the block decision
+				for each of them.  Only this task changes the active lists,
+				and a reloaded timer is inserted after xTimeNow, so the loop
+				ends. */
+				while( listLIST_IS_EMPTY( pxCurrentTimerList ) == pdFALSE )
+				{
+					xExpireTime = listGET_ITEM_VALUE_OF_HEAD_ENTRY( pxCurrentTimerList );
+					if( xExpireTime > xTimeNow )
+					{
+						break;
+					}
+					prvProcessExpiredTimer( xExpireTime, xTimeNow );
+				}
 			}
 			else
 			{
@@ -767,19 +905,36 @@ BaseType_t xResult;
 }
 /*-----------------------------------------------------------*/
 
-static void prvCheckForValidListAndQueue( void )
+static void prvCheckForValidListAndQueue( const BaseType_t xCreateQueue )
 {
 	/* Check that the list from which active timers are referenced, and the
 	queue used to communicate with the timer service, have been
 	initialised. */
 	taskENTER_CRITICAL();
 	{
-		if( xTimerQueue == NULL )
+		if( pxCurrentTimerList == NULL )
 		{
 			vListInitialise( &xActiveTimerList1 );
 			vListInitialise( &xActiveTimerList2 );
 			pxCurrentTimerList = &xActiveTimerList1;
 			pxOverflowTimerList = &xActiveTimerList2;
+
+			#if ( configUSE_TICK_TIMERS == 1 )
+			{
+				vListInitialise( &xTickTimerList1 );
+				vListInitialise( &xTickTimerList2 );
+				pxCurrentTickTimerList = &xTickTimerList1;
+				pxOverflowTickTimerList = &xTickTimerList2;
+			}
+			#endif
+		}
+		else
+		{
+			mtCOVERAGE_TEST_MARKER();
+		}
+
+		if( ( xTimerQueue == NULL ) && ( xCreateQueue != pdFALSE ) )
+		{
 			xTimerQueue = xQueueCreate( ( UBaseType_t ) configTIMER_QUEUE_LENGTH, sizeof( DaemonTaskMessage_t ) );
 			configASSERT( xTimerQueue );
 
@@ -805,6 +960,154 @@ static void prvCheckForValidListAndQueue( void )
 }
 /*-----------------------------------------------------------*/
 
+#if ( configUSE_TICK_TIMERS == 1 )
+
+	static void prvInsertTickTimer( Timer_t * const pxTimer, const TickType_t xTimeNow )
+	{
+	const TickType_t xNextExpiryTime = xTimeNow + pxTimer->xTimerPeriodInTicks;
+
+		listSET_LIST_ITEM_VALUE( &( pxTimer->xTimerListItem ), xNextExpiryTime );
+		listSET_LIST_ITEM_OWNER( &( pxTimer->xTimerListItem ), pxTimer );
+
+		if( xNextExpiryTime < xTimeNow )
+		{
+			/* The expiry time has overflowed. */
+			vListInsert( pxOverflowTickTimerList, &( pxTimer->xTimerListItem ) );
+		}
+		else
+		{
+			vListInsert( pxCurrentTickTimerList, &( pxTimer->xTimerListItem ) );
+		}
+	}
+	/*-----------------------------------------------------------*/
+
+	static BaseType_t prvTickTimerCommand( Timer_t * const pxTimer, const BaseType_t xCommandID, const TickType_t xOptionalValue )
+	{
+	UBaseType_t uxSavedInterruptStatus;
+
+		/* Masking the interrupts holds off the tick interrupt, from a task as
+		well as from an interrupt. */
+		uxSavedInterruptStatus = portSET_INTERRUPT_MASK_FROM_ISR();
+		{
+			if( listIS_CONTAINED_WITHIN( NULL, &( pxTimer->xTimerListItem ) ) == pdFALSE )
+			{
+				( void ) uxListRemove( &( pxTimer->xTimerListItem ) );
+			}
+			else
+			{
+				mtCOVERAGE_TEST_MARKER();
+			}
+
+			switch( xCommandID )
+			{
+				case tmrCOMMAND_CHANGE_PERIOD :
+				case tmrCOMMAND_CHANGE_PERIOD_FROM_ISR :
+					pxTimer->xTimerPeriodInTicks = xOptionalValue;
+					configASSERT( ( pxTimer->xTimerPeriodInTicks > 0 ) );
+					prvInsertTickTimer( pxTimer, xTaskGetTickCountFromISR() );
+					break;
+
+				case tmrCOMMAND_START :
+				case tmrCOMMAND_START_FROM_ISR :
+				case tmrCOMMAND_RESET :
+				case tmrCOMMAND_RESET_FROM_ISR :
+				case tmrCOMMAND_START_DONT_TRACE :
+					prvInsertTickTimer( pxTimer, xTaskGetTickCountFromISR() );
+					break;
+
+				default :
+					/* Stopped or deleted, it has been removed from its list. */
+					break;
+			}
+		}
+		portCLEAR_INTERRUPT_MASK_FROM_ISR( uxSavedInterruptStatus );
+
+		traceTIMER_COMMAND_SEND( pxTimer, xCommandID, xOptionalValue, pdPASS );
+
+		if( xCommandID == tmrCOMMAND_DELETE )
+		{
+			vPortFree( pxTimer );
+		}
+		else
+		{
+			mtCOVERAGE_TEST_MARKER();
+		}
+
+		return pdPASS;
+	}
+	/*-----------------------------------------------------------*/
+
+	void vTimerProcessTickTimers( const TickType_t xTimeNow )
+	{
+	Timer_t *pxTimer;
+	List_t *pxTemp;
+
+		/* Called by the tick interrupt, after the tick count was incremented.
+		The ticks are processed one by one, so when the tick count overflows
+		the timers of the current list have all expired. */
+		if( xTimeNow == ( TickType_t ) 0U )
+		{
+			pxTemp = pxCurrentTickTimerList;
+			pxCurrentTickTimerList = pxOverflowTickTimerList;
+			pxOverflowTickTimerList = pxTemp;
+		}
+		else
+		{
+			mtCOVERAGE_TEST_MARKER();
+		}
+
+		while( listLIST_IS_EMPTY( pxCurrentTickTimerList ) == pdFALSE )
+		{
+			if( listGET_ITEM_VALUE_OF_HEAD_ENTRY( pxCurrentTickTimerList ) > xTimeNow )
+			{
+				break;
+			}
+
+			pxTimer = ( Timer_t * ) listGET_OWNER_OF_HEAD_ENTRY( pxCurrentTickTimerList );
+			( void ) uxListRemove( &( pxTimer->xTimerListItem ) );
+			traceTIMER_EXPIRED( pxTimer );
+
+			/* Reloaded before the callback, which may stop the timer or change
+			its period. */
+			if( pxTimer->uxAutoReload == ( UBaseType_t ) pdTRUE )
+			{
+				prvInsertTickTimer( pxTimer, xTimeNow );
+			}
+			else
+			{
+				mtCOVERAGE_TEST_MARKER();
+			}
+
+			pxTimer->pxCallbackFunction( ( TimerHandle_t ) pxTimer );
+		}
+	}
+	/*-----------------------------------------------------------*/
+
+	TickType_t xTimerGetTickTimersIdleTime( const TickType_t xTimeNow )
+	{
+	TickType_t xReturn;
+
+		/* The ticks that can be skipped by the tickless idle mode. */
+		if( listLIST_IS_EMPTY( pxCurrentTickTimerList ) == pdFALSE )
+		{
+			xReturn = listGET_ITEM_VALUE_OF_HEAD_ENTRY( pxCurrentTickTimerList ) - xTimeNow;
+		}
+		else if( listLIST_IS_EMPTY( pxOverflowTickTimerList ) == pdFALSE )
+		{
+			/* Up to the overflow, where the lists are switched. */
+			xReturn = ( TickType_t ) 0U - xTimeNow;
+		}
+		else
+		{
+			xReturn = portMAX_DELAY;
+		}
+
+		return xReturn;
+	}
+
+#endif /* configUSE_TICK_TIMERS */
+/*-----------------------------------------------------------*/
+
 BaseType_t xTimerIsTimerActive( TimerHandle_t xTimer )
 {
 BaseType_t xTimerIsInActiveList;
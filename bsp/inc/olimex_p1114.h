@@ -32,6 +32,17 @@
 
 #define UART_ERROR (-2)
 
+/* the LPC1114 of this board has no C_CAN controller; set to 1 on a board
+ * with an LPC11C14/C24 and a CAN transceiver (or -DBOARD_HAS_CAN=1 to build
+ * the CAN code, as tools/test does) */
+#ifndef BOARD_HAS_CAN
+#define BOARD_HAS_CAN 0
+#endif
+
+/* serial queues size */
+#define UART_TX_QUEUE_SIZE 64
+#define UART_RX_QUEUE_SIZE 128
+
 enum leds_t
 {
 	LED0, LED1, LED2, LED3, LED4, LED5, LED6, LED7
@@ -48,6 +59,9 @@ uint32_t ulMainGetRunTimeCounterValue(void);
 int getCharSerial(int timeout);
 int sendCharSerial(uint8_t *buff, int len);
 int kbHit(void);
+uint32_t UART_CheckBaudRate(uint32_t baudrate, int32_t *ppm);
+uint32_t UART_SetBaudRate(uint32_t baudrate, int32_t *ppm);
+uint32_t UART_GetBaudRate(void);
 void LED_Set(uint8_t LEDNumber, bool State);
 bool LED_Test(uint8_t LEDNumber);
 void LED_Toggle(uint8_t LEDNumber);
@@ -30,15 +30,15 @@
 #include "lpc_types.h"
 #include "chip.h"
 #include "FreeRTOS.h"
+#include "task.h"
 #include "queue.h"
 #include "olimex_p1114.h"
 
 /* CLI UART baud rate */
 #define BAUD_RATE 115200
 
-/* serial queues size */
-#define TX_QUEUE_SIZE 64
-#define RX_QUEUE_SIZE 64
+/* maximum accepted baud rate error, in ppm */
+#define BAUD_MAX_ERROR_PPM 15000
 
 /* USART transmit and receive queues */
 QueueHandle_t txQueue;
@@ -46,6 +46,12 @@ QueueHandle_t rxQueue;
 
 volatile int g_Uart_Error = 0;
 
+/* current UART baud rate */
+static uint32_t uartBaudRate;
+
+/* how long a writer waits for room in the transmit queue */
+static portTickType uartTxTimeout = MS10_DELAY;
+
 /* system oscillator rate and clock rate on the CLKIN pin */
 const uint32_t OscRateIn = HSE_VALUE;
 const uint32_t ExtRateIn = 0;
@@ -71,6 +77,7 @@ static const pinmux_t pinmuxing[] =
 { (uint32_t) IOCON_PIO1_6, (IOCON_FUNC1 | IOCON_MODE_INACT) }, /* PIO1_6 used for RXD */
 { (uint32_t) IOCON_PIO1_7, (IOCON_FUNC1 | IOCON_MODE_INACT) }, /* PIO1_7 used for TXD */
 { (uint32_t) IOCON_PIO2_11, (IOCON_FUNC1 | IOCON_MODE_INACT) }, /* PIO0_6 used for SCK */
+{ (uint32_t) IOCON_PIO0_11, (IOCON_FUNC2 | IOCON_ADMODE_EN) }, /* PIO0_11 used for AD0 */
 };
 
 /* Forward declarations */
@@ -85,7 +92,8 @@ static void UART_Init(int baudrate);
 
 /**
  * @brief	This function initializes the system clocks and the
- * @brief	controller's pins and is called prior main;
+ * @brief	controller's pins; it is called by the reset handler before
+ * @brief	.data and .bss are initialized, so it must not use any variable.
  */
 void SystemInit(void)
 {
@@ -159,7 +167,9 @@ int getCharSerial(int timeout)
 }
 
 /**
- * @brief	Send a char through the serial interface if it's not busy.
+ * @brief	Send a char through the serial interface if it's not busy. When
+ * 			the queue is full, wait as long as the UART takes to send a
+ * 			full queue at the current baud rate.
  * @param	buff: pointer on a buffer containing the characters to be sent.
  * @param	len: number of characters to be sent.
  * @retval	Number of characters sent.
@@ -172,13 +182,15 @@ int sendCharSerial(uint8_t *buff, int len)
 	{
 		while (len--)
 		{
-			if (xQueueSendToBack(txQueue, buff, MS10_DELAY) == pdPASS)
+			if (xQueueSendToBack(txQueue, buff, 0) != pdPASS)
 			{
-				buff++;
-				count++;
+				/* queue full: make sure it drains, then wait for room */
+				Chip_UART_IntEnable(LPC_USART, UART_IER_THREINT);
+				if (xQueueSendToBack(txQueue, buff, uartTxTimeout) != pdPASS)
+					break;	/* the transmitter is stuck, exit */
 			}
-			else
-				break;	/* queue full, exit */
+			buff++;
+			count++;
 		}
 		if (count)
 			Chip_UART_IntEnable(LPC_USART, UART_IER_THREINT);
@@ -198,6 +210,80 @@ int kbHit(void)
 	return (nrItems != 0);
 }
 
+/**
+ * @brief	Set the transmit timeout to the time taken to send a full queue,
+ * 			10 bits per character, and at least 10 ms.
+ * @param	baudrate: the current baud rate.
+ */
+static void UART_SetTxTimeout(uint32_t baudrate)
+{
+	uartTxTimeout = (UART_TX_QUEUE_SIZE * 10 * configTICK_RATE_HZ + baudrate - 1)
+			/ baudrate;
+	if (uartTxTimeout < MS10_DELAY)
+		uartTxTimeout = MS10_DELAY;
+}
+
+/**
+ * @brief	Check if a baud rate can be generated from the current clock. The
+ * 			dividers are found by searching all fractional divider settings.
+ * @param	baudrate: the baud rate to check.
+ * @param	ppm: pointer on a variable to return the rate error in ppm; can
+ * 			be NULL.
+ * @return	the actual baud rate, or 0 if the error is not acceptable.
+ */
+uint32_t UART_CheckBaudRate(uint32_t baudrate, int32_t *ppm)
+{
+	uint32_t dl, mval, dval, actual;
+	int32_t error;
+
+	actual = Chip_UART_CalcBaudFDR(Chip_Clock_GetMainClockRate(), baudrate,
+			&dl, &mval, &dval);
+	if (actual == 0)
+		return 0;
+
+	error = (int32_t) (((int64_t) actual - baudrate) * 1000000 / baudrate);
+	if (ppm)
+		*ppm = error;
+	if (error > BAUD_MAX_ERROR_PPM || error < -BAUD_MAX_ERROR_PPM)
+		return 0;
+	return actual;
+}
+
+/**
+ * @brief	Change the UART baud rate. The rate is only changed if the error
+ * 			is acceptable, and only after all pending characters were sent.
+ * @param	baudrate: the new baud rate.
+ * @param	ppm: pointer on a variable to return the rate error in ppm; can
+ * 			be NULL.
+ * @return	the actual baud rate, or 0 if the requested rate can't be set.
+ */
+uint32_t UART_SetBaudRate(uint32_t baudrate, int32_t *ppm)
+{
+	if (UART_CheckBaudRate(baudrate, ppm) == 0)
+		return 0;
+
+	/* wait until the transmit queue and the transmitter are both empty */
+	while (uxQueueMessagesWaiting(txQueue) ||
+			!(Chip_UART_ReadLineStatus(LPC_USART) & UART_LSR_TEMT))
+		vTaskDelay(MS1_DELAY);
+
+	uartBaudRate = Chip_UART_SetBaudFDR(LPC_USART, baudrate);
+	UART_SetTxTimeout(uartBaudRate);
+
+	/* drop anything received during the switch */
+	xQueueReset(rxQueue);
+	return uartBaudRate;
+}
+
+/**
+ * @brief	Return the current UART baud rate.
+ * @return	the actual baud rate.
+ */
+uint32_t UART_GetBaudRate(void)
+{
+	return uartBaudRate;
+}
+
 /**
  * @brief	Sets the state of a LED to on or off.
  * @param	LEDNumber: the number if the LED to be set.
@@ -314,14 +400,15 @@ static void UART_Init(int baudrate)
 	/* we assume that the Rx/Tx pins are already set at startup */
 	/* setup UART for 115.2K, 8N1 */
 	Chip_UART_Init(LPC_USART);
-	Chip_UART_SetBaud(LPC_USART, baudrate);
+	uartBaudRate = Chip_UART_SetBaudFDR(LPC_USART, baudrate);
+	UART_SetTxTimeout(uartBaudRate);
 	Chip_UART_ConfigData(LPC_USART, (UART_LCR_WLEN8 | UART_LCR_SBS_1BIT));
 	Chip_UART_SetupFIFOS(LPC_USART, (UART_FCR_FIFO_EN | UART_FCR_TRG_LEV2));
 	Chip_UART_TXEnable(LPC_USART);
 
 	/* create queues */
-	txQueue = xQueueCreate(TX_QUEUE_SIZE, sizeof(uint8_t));
-	rxQueue = xQueueCreate(RX_QUEUE_SIZE, sizeof(uint8_t));
+	txQueue = xQueueCreate(UART_TX_QUEUE_SIZE, sizeof(uint8_t));
+	rxQueue = xQueueCreate(UART_RX_QUEUE_SIZE, sizeof(uint8_t));
 
 	/* enable receive data and line status interrupt */
 	Chip_UART_IntEnable(LPC_USART, UART_IER_RBRINT);
@@ -331,22 +418,28 @@ static void UART_Init(int baudrate)
 }
 
 /**
- * @brief	Handle UART interrupt.
+ * @brief	Handle UART interrupt; runs from RAM (no flash wait states).
  */
-void UART_IRQHandler(void)
+RAMFUNC void UART_IRQHandler(void)
 {
 	uint8_t ch;
+	int count;
 	portBASE_TYPE xHigherPriorityTaskWoken = pdFALSE;
 
-	/* handle transmit interrupt if enabled */
-	if (((Chip_UART_ReadLineStatus(LPC_USART) & UART_LSR_THRE) != 0) &&
-			xQueueReceiveFromISR(txQueue, &ch, &xHigherPriorityTaskWoken) == pdPASS)
+	/* handle transmit interrupt: the FIFO is empty, refill it completely */
+	if ((Chip_UART_ReadLineStatus(LPC_USART) & UART_LSR_THRE) != 0)
 	{
-		Chip_UART_SendByte(LPC_USART, ch);
+		for (count = 0; count < UART_TX_FIFO_SIZE; count++)
+		{
+			if (xQueueReceiveFromISR(txQueue, &ch, &xHigherPriorityTaskWoken)
+					!= pdPASS)
+				break;
+			Chip_UART_SendByte(LPC_USART, ch);
+		}
+		/* disable transmit interrupt if the queue is empty */
+		if (count == 0)
+			Chip_UART_IntDisable(LPC_USART, UART_IER_THREINT);
 	}
-	else
-	/* disable transmit interrupt if the queue is empty */
-		Chip_UART_IntDisable(LPC_USART, UART_IER_THREINT);
 
 	/* handle receive interrupt */
 	while ((Chip_UART_ReadLineStatus(LPC_USART) & UART_LSR_RDR) != 0)
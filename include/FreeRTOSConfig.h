@@ -90,7 +90,7 @@
 #define configUSE_TICK_HOOK				0
 #define configCPU_CLOCK_HZ				( SystemCoreClock )
 #define configTICK_RATE_HZ				( ( portTickType ) 1000 )
-#define configMAX_PRIORITIES			( ( unsigned portBASE_TYPE ) 8 )
+#define configMAX_PRIORITIES			( 8 )	/* plain number, tested by portmacro.h */
 #define configMINIMAL_STACK_SIZE		( ( unsigned short ) 64 )
 #define configTOTAL_HEAP_SIZE			( ( size_t ) (4 * 1024) )	/* ignored if heap3.c is used */
 #define configMAX_TASK_NAME_LEN			( 10 )
@@ -107,14 +107,19 @@
 #define configGENERATE_RUN_TIME_STATS	1
 #define configUSE_TICKLESS_IDLE			1
 #define configUSE_STATS_FORMATTING_FUNCTIONS 1
+#define configUSE_PORT_OPTIMISED_TASK_SELECTION 1	/* De Bruijn lookup on the M0 */
+#define configUSE_TIMING_WHEEL			0	/* 1: delayed tasks in a wheel, 2 * 2^configTIMING_WHEEL_BITS lists */
+#define configTIMING_WHEEL_BITS			4
 
 /* Co-routine definitions. */
 #define configUSE_CO_ROUTINES 			0
 #define configMAX_CO_ROUTINE_PRIORITIES ( 2 )
 
 /* Software timer definitions. */
-#define configUSE_TIMERS				0
-#define configTIMER_TASK_PRIORITY		( 0 )
+#define configUSE_TIMERS				1
+#define configUSE_TICK_TIMERS			1	/* xTimerCreateTick(): callbacks in the tick interrupt */
+#define configTIMER_TASK_ON_DEMAND		1	/* no service task until a timer needs it */
+#define configTIMER_TASK_PRIORITY		( configMAX_PRIORITIES - 1 )
 #define configTIMER_QUEUE_LENGTH		5
 #define configTIMER_TASK_STACK_DEPTH	( configMINIMAL_STACK_SIZE * 2 )
 
@@ -158,6 +163,17 @@ header file. */
 
 #define configUSE_CUSTOM_TICK 0
 
+/* The context switch, the tick and the UART interrupt run from RAM, where
+there are no flash wait states; the .ramfunc section is copied with .data at
+start up (see sections.ld). Set to 0 to give the RAM back. */
+#define configUSE_RAMFUNC 1
+
+#if configUSE_RAMFUNC
+	#define RAMFUNC __attribute__ (( section( ".ramfunc" ) ))
+#else
+	#define RAMFUNC
+#endif
+
 /* Definitions that map the FreeRTOS port interrupt handlers to their CMSIS
 standard names - or at least those used in the unmodified vector table. */
 #define vPortSVCHandler SVC_Handler
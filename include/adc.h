@@ -0,0 +1,44 @@
+/*
+ * adc.h
+ *
+ * Continuous ADC acquisition into a ring buffer.
+ *
+ * Created on: 18 Oct 2026 (LNP)
+ *
+ * (c) 2026 Lixco Microsystems <lix@paulian.net>
+ */
+
+#ifndef ADC_H_
+#define ADC_H_
+
+#include <stdint.h>
+#include "FreeRTOS.h"
+
+#define ADC_RING_SIZE 256		/* samples, must be a power of 2 */
+#define ADC_MAX_RATE 100000		/* conversions per second the ISR can sustain */
+#define ADC_BLOCK_SIZE 32		/* samples per time stamp, a power of 2 */
+
+/* acquisition statistics */
+typedef struct
+{
+	uint32_t samples;			/* samples stored in the ring */
+	uint32_t overruns;			/* conversions overwritten before being read */
+	uint32_t dropped;			/* samples lost because the ring was full */
+	uint16_t level;				/* samples in the ring */
+	uint16_t peak;				/* max samples in the ring */
+	uint32_t latency_min;		/* timed mode: trigger to ISR, ns */
+	uint32_t latency_max;		/* the difference is the ISR jitter */
+} adc_stats_t;
+
+int adcStart(uint8_t channels, uint32_t rate);
+uint32_t adcStartTimed(uint8_t channel, uint32_t rate);
+void adcStop(void);
+int adcChannels(void);
+int adcRead(uint16_t *buff, int count, portTickType timeout);
+int adcPeek(const uint16_t **data);
+void adcConsume(int count);
+uint32_t adcIndex(void);
+int adcGetTimestamp(uint32_t index, portTickType *tick);
+void adcGetStats(adc_stats_t *stats);
+
+#endif /* ADC_H_ */
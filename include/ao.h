@@ -0,0 +1,94 @@
+/*
+ * ao.h
+ *
+ * Active objects: event driven components with their own event queue,
+ * dispatched run to completion by priority by a few tasks, with events
+ * from a shared pool, publish/subscribe and time events.
+ *
+ * Created on: 18 Oct 2026 (LNP)
+ *
+ * (c) 2026 Lixco Microsystems <lix@paulian.net>
+ */
+
+#ifndef AO_H_
+#define AO_H_
+
+#include <stdint.h>
+#include "FreeRTOS.h"
+#include "timers.h"
+
+#define AO_MAX 8				/* active objects, also their priorities (8 at most) */
+#define AO_MAX_SIGNALS 32		/* signals which can be published */
+#define AO_POOL_SIZE 16			/* events in the pool */
+#define AO_EVENT_SIZE 12		/* bytes of parameters in an event */
+
+#define AO_STATIC 0xFF			/* refs of an event not from the pool */
+
+/* an event; the ones from the pool are recycled after the last active
+ * object which received them has processed them */
+typedef struct ao_event_s
+{
+	uint8_t sig;				/* signal, what happened */
+	uint8_t refs;				/* queues holding the event, or AO_STATIC */
+	uint16_t param;				/* free for the application */
+	union
+	{
+		uint8_t data[AO_EVENT_SIZE];
+		uint32_t word[AO_EVENT_SIZE / 4];
+		struct ao_event_s *next;	/* in the free list of the pool */
+	};
+} ao_event_t;
+
+/* a task dispatching the events of one or more active objects */
+typedef struct
+{
+	xTaskHandle task;
+	uint8_t ready;				/* active objects with events, by priority */
+} ao_thread_t;
+
+struct ao_s;
+typedef void (*ao_handler_t)(struct ao_s *ao, const ao_event_t *e);
+
+/* an active object; it is usually the first member of a structure which
+ * holds its state */
+typedef struct ao_s
+{
+	ao_handler_t handler;		/* processes an event, must not block */
+	ao_event_t **queue;
+	ao_thread_t *thread;
+	uint8_t size;				/* of the queue */
+	uint8_t head;
+	uint8_t count;
+	uint8_t prio;				/* 0 to AO_MAX - 1, the highest runs first */
+} ao_t;
+
+#if ( configUSE_TICK_TIMERS == 1 )
+/* a time event posts its static event to an active object when its timer,
+ * run by the tick interrupt, expires */
+typedef struct
+{
+	ao_event_t event;
+	ao_t *ao;
+	TimerHandle_t timer;
+} ao_time_t;
+#endif
+
+void aoInit(void);
+int aoThreadInit(ao_thread_t *thread, unsigned portBASE_TYPE prio,
+		uint16_t stack);
+int aoStart(ao_t *ao, uint8_t prio, ao_handler_t handler, ao_event_t **queue,
+		uint8_t size, ao_thread_t *thread);
+ao_event_t *aoNew(uint8_t sig);
+int aoPost(ao_t *ao, ao_event_t *e);
+int aoPostFromISR(ao_t *ao, ao_event_t *e, portBASE_TYPE *woken);
+int aoSubscribe(ao_t *ao, uint8_t sig);
+int aoUnsubscribe(ao_t *ao, uint8_t sig);
+int aoPublish(ao_event_t *e);
+int aoPublishFromISR(ao_event_t *e, portBASE_TYPE *woken);
+#if ( configUSE_TICK_TIMERS == 1 )
+int aoTimeInit(ao_time_t *te, ao_t *ao, uint8_t sig, int periodic);
+int aoTimeArm(ao_time_t *te, portTickType ticks);
+void aoTimeDisarm(ao_time_t *te);
+#endif
+
+#endif /* AO_H_ */
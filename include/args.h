@@ -0,0 +1,55 @@
+/*
+ * args.h
+ *
+ * Table driven parser for the CLI command arguments.
+ *
+ * Created on: 18 Oct 2026 (LNP)
+ *
+ * (c) 2026 Lixco Microsystems <lix@paulian.net>
+ */
+
+#ifndef ARGS_H_
+#define ARGS_H_
+
+#include <stdint.h>
+
+#define ARGS_MAX 6				/* max number of arguments in a specification */
+#define ARGS_HELP 2				/* argsParse() result when "-h" was given */
+
+/* argument types */
+#define ARG_DEC 1				/* unsigned number, decimal (or 0x hex) */
+#define ARG_HEX 2				/* unsigned number, hexadecimal */
+#define ARG_ENUM 3				/* one of a list of words */
+#define ARG_FLAG 4				/* option, e.g. "-b", anywhere on the line */
+#define ARG_STR 5				/* any word */
+
+/* this structure defines an argument; a specification is an array of these,
+ * terminated by an entry with a NULL name */
+typedef struct
+{
+	const char *name;			/* name shown in the usage, or the option text */
+	uint8_t type;				/* ARG_DEC, ARG_HEX, ... */
+	uint8_t optional;			/* TRUE if the argument may be omitted */
+	uint32_t min;				/* accepted range of a number */
+	uint32_t max;
+	const char * const *choices;	/* words of an ARG_ENUM, NULL terminated */
+} arg_spec_t;
+
+/* compile time check that a specification, an array, has at most ARGS_MAX
+ * entries besides its terminator: argsParse() fills ARGS_MAX values only */
+#define ARGS_SPEC_CHECK(spec) typedef char spec##TooLong \
+	[(sizeof(spec) / sizeof((spec)[0]) <= ARGS_MAX + 1) ? 1 : -1]
+
+/* parsed value of an argument, at the same index as its specification */
+typedef struct
+{
+	uint8_t present;			/* TRUE if the argument was given */
+	uint32_t num;				/* number, or index of the ARG_ENUM word */
+	const char *str;			/* the argument as typed */
+} arg_value_t;
+
+int argsParse(const arg_spec_t *spec, int argc, char *argv[],
+		arg_value_t *values);
+void argsUsage(const char *cmd, const arg_spec_t *spec);
+
+#endif /* ARGS_H_ */
@@ -0,0 +1,23 @@
+/*
+ * bench.h
+ *
+ * Kernel benchmarks: context switches, message passing, synchronization,
+ * memory allocation and interrupt processing, in CPU cycles.
+ *
+ * Created on: 18 Oct 2026 (LNP)
+ *
+ * (c) 2026 Lixco Microsystems <lix@paulian.net>
+ */
+
+#ifndef BENCH_H_
+#define BENCH_H_
+
+#include <stdint.h>
+
+#define BENCH_DEFAULT_COUNT 1000
+#define BENCH_MAX_COUNT 100000
+
+int benchRun(uint32_t count);
+uint32_t benchCycles(void);
+
+#endif /* BENCH_H_ */
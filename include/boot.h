@@ -0,0 +1,49 @@
+/*
+ * boot.h
+ *
+ * Boot time profiler: time stamps of the boot phases, from reset to the
+ * first task, kept in a buffer that survives warm resets.
+ *
+ * Created on: 18 Oct 2026 (LNP)
+ *
+ * (c) 2026 Lixco Microsystems <lix@paulian.net>
+ */
+
+#ifndef BOOT_H_
+#define BOOT_H_
+
+#include <stdint.h>
+
+/* boot phases, each one marked when it ends */
+#define BOOT_RESET 0			/* reset handler entered */
+#define BOOT_CLOCKS 1			/* PLL running, pins configured */
+#define BOOT_DATA 2				/* .data copied, .bss zeroed */
+#define BOOT_BOARD 3			/* board and drivers initialised */
+#define BOOT_TASKS 4			/* tasks created, scheduler starting */
+#define BOOT_FIRST_TASK 5		/* first task running */
+#define BOOT_PHASES 6
+
+#define BOOT_MAGIC 0xB007C0DE
+
+typedef struct
+{
+	uint32_t cycles;			/* system clock cycles since reset */
+	uint32_t mhz;				/* system clock when the phase ended */
+} boot_mark_t;
+
+/* the record lives in .noinit: it is written before the C run time is set
+ * up and is left alone by the start up code */
+typedef struct
+{
+	uint32_t magic;
+	uint32_t boots;				/* resets since power on */
+	uint32_t valid;				/* bit mask of the marked phases */
+	boot_mark_t marks[BOOT_PHASES];
+} boot_record_t;
+
+void bootStart(void);
+void bootMark(int phase);
+void bootDone(void);
+const boot_record_t *bootGetRecord(void);
+
+#endif /* BOOT_H_ */
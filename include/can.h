@@ -0,0 +1,70 @@
+/*
+ * can.h
+ *
+ * C_CAN driver built on the LPC11Cxx ROM API.
+ *
+ * Created on: 18 Oct 2026 (LNP)
+ *
+ * (c) 2026 Lixco Microsystems <lix@paulian.net>
+ */
+
+#ifndef CAN_H_
+#define CAN_H_
+
+#include <stdint.h>
+#include "chip.h"
+#include "FreeRTOS.h"
+#include "queue.h"
+
+#define CAN_DEFAULT_BITRATE 500000
+
+/* message objects: 0 is used for transmission, 1 to CAN_RX_LAST are the
+ * receive filters and the last two are used by the ROM CANopen SDO server */
+#define CAN_MSGOBJ_NUM 32
+#define CAN_TX_MSGOBJ 0
+#define CAN_RX_FIRST 1
+#define CAN_RX_LAST 29
+#define CAN_SDO_RX_MSGOBJ 30
+#define CAN_SDO_TX_MSGOBJ 31
+
+#define CAN_TX_QUEUE_SIZE 8		/* frames waiting for transmission */
+#define CAN_RX_BUFFERS 8		/* frames received but not released yet */
+#define CAN_RX_QUEUE_SIZE 8		/* default receive queue */
+
+/* counted bus errors, one for each CAN_ERROR_xxx bit from STUF to CRC */
+#define CAN_ERR_STUFF 0
+#define CAN_ERR_FORM 1
+#define CAN_ERR_ACK 2
+#define CAN_ERR_BIT1 3
+#define CAN_ERR_BIT0 4
+#define CAN_ERR_CRC 5
+#define CAN_ERR_TYPES 6
+
+/* a CAN frame: mode_id holds the identifier and the CAN_MSGOBJ_xxx flags;
+ * received frames are passed on the queues as pointers (can_msg_t *) to the
+ * driver buffers, which must be given back with canRelease() */
+typedef CCAN_MSG_OBJ_T can_msg_t;
+
+/* driver statistics */
+typedef struct
+{
+	uint32_t rx_frames;
+	uint32_t tx_frames;
+	uint32_t rx_lost;			/* no free buffer or receive queue full */
+	uint32_t errors[CAN_ERR_TYPES];
+	uint32_t bus_off;			/* bus off events (recovered automatically) */
+	uint32_t status;			/* last CAN_ERROR_PASS/WARN/BOFF state */
+	uint8_t tec;				/* transmit error counter */
+	uint8_t rec;				/* receive error counter */
+	uint16_t load;				/* bus load since the previous call, in 0.1% */
+} can_stats_t;
+
+int canInit(uint32_t bitrate);
+int canAddFilter(uint32_t mode_id, uint32_t mask, QueueHandle_t queue);
+int canSend(const can_msg_t *msg, portTickType timeout);
+can_msg_t *canReceive(portTickType timeout);
+void canRelease(can_msg_t *msg);
+void canGetStats(can_stats_t *stats);
+void canConfigCANopen(CCAN_CANOPENCFG_T *cfg, const CCAN_CALLBACKS_T *callbacks);
+
+#endif /* CAN_H_ */
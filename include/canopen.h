@@ -0,0 +1,47 @@
+/*
+ * canopen.h
+ *
+ * CANopen slave node: the SDO server is the one in the LPC11Cxx ROM, NMT,
+ * heartbeat and PDOs are handled by a task.
+ *
+ * Created on: 18 Oct 2026 (LNP)
+ *
+ * (c) 2026 Lixco Microsystems <lix@paulian.net>
+ */
+
+#ifndef CANOPEN_H_
+#define CANOPEN_H_
+
+#include <stdint.h>
+
+#define CANOPEN_NODE_ID 0x10
+
+/* NMT states, as sent in the heartbeat */
+#define NMT_BOOTUP 0x00
+#define NMT_STOPPED 0x04
+#define NMT_OPERATIONAL 0x05
+#define NMT_PRE_OPERATIONAL 0x7F
+
+#define CANOPEN_PDO_MAX_MAP 4		/* objects mapped in a PDO */
+#define CANOPEN_DOMAIN_SIZE 64		/* application domain, index 0x2100 */
+
+/* process data, mapped by default on RPDO1 (index 0x2000) and TPDO1 (index
+ * 0x2001) */
+extern volatile uint16_t g_canopenIn[CANOPEN_PDO_MAX_MAP];
+extern volatile uint16_t g_canopenOut[CANOPEN_PDO_MAX_MAP];
+
+/* this structure defines an object streamed by segmented SDO transfers
+ * directly from/to an application buffer */
+typedef struct
+{
+	uint16_t index;
+	uint8_t subindex;
+	uint8_t *buff;
+	uint16_t size;				/* buffer size */
+	uint16_t *length;			/* bytes used in the buffer */
+} canopen_domain_t;
+
+int canopenInit(uint8_t nodeId);
+uint8_t canopenGetState(void);
+
+#endif /* CANOPEN_H_ */
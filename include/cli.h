@@ -10,6 +10,8 @@
 #ifndef CLI_H_
 #define CLI_H_
 
+#include "args.h"
+
 #define PLATFORMNAME "LPC1114"
 #define VERSION "0.1"
 #define DATE (__DATE__ " " __TIME__)
@@ -26,12 +28,15 @@
 #define MALLOC_ERROR 8			/* error allocating memory (out of memory) */
 #define EXITCOMMAND 99			/* user induced exit */
 
-/* this structure defines an entry in the command table */
+/* this structure defines an entry in the command table; the arguments are
+ * checked against the specification before the command is called, a NULL
+ * specification means the command parses its arguments itself */
 typedef struct
 {
     char *name;
-    int (*func) ();
+    int (*func) (int argc, char *argv[], arg_value_t *arg);
     char *help_string;
+    const arg_spec_t *args;
 } cmds_t;
 
 
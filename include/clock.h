@@ -0,0 +1,32 @@
+/*
+ * clock.h
+ *
+ * Monotonic microseconds time base on TIMER32_1 and calendar time.
+ *
+ * Created on: 18 Oct 2026 (LNP)
+ *
+ * (c) 2026 Lixco Microsystems <lix@paulian.net>
+ */
+
+#ifndef CLOCK_H_
+#define CLOCK_H_
+
+#include <stdint.h>
+#include <time.h>
+
+/* clocks for clockGetTime() */
+#define CLK_MONOTONIC 0			/* time since reset, never set */
+#define CLK_REALTIME 1			/* seconds since 1970-01-01 00:00 UTC */
+
+#define CLOCK_MIN_YEAR 1970
+#define CLOCK_MAX_YEAR 2105		/* seconds still fit in 32 bits */
+
+void clockStart(uint32_t us);
+uint64_t clockMicros(void);
+uint32_t clockUptime(void);
+int clockGetTime(int clk, struct timespec *ts);
+int clockSetTime(const struct timespec *ts);
+int clockGetDate(struct tm *tm, uint32_t *us);
+int clockSetDate(const struct tm *tm);
+
+#endif /* CLOCK_H_ */
@@ -0,0 +1,80 @@
+/*
+ * divide.h
+ *
+ * Integer division helpers for the Cortex-M0, which has no divide
+ * instruction: reciprocal multiplication for constant and invariant
+ * divisors. The plain '/' and '%' operators use the run time in divide.S.
+ *
+ * Created on: 18 Oct 2026 (LNP)
+ *
+ * (c) 2026 Lixco Microsystems <lix@paulian.net>
+ */
+
+#ifndef DIVIDE_H_
+#define DIVIDE_H_
+
+#include <stdint.h>
+
+/* a divisor prepared by udivConstInit(), for a value divided many times */
+typedef struct
+{
+	uint32_t magic;
+	uint8_t shift1;
+	uint8_t shift2;
+} udiv_const_t;
+
+void udivConstInit(udiv_const_t *dc, uint32_t d);
+
+/**
+ * @brief	High 32 bits of a 32x32 bits product, with the 32 bits results
+ * 			multiplier of the M0 (4 multiplications, no call to __aeabi_lmul).
+ * @param	a: first factor.
+ * @param	b: second factor.
+ * @return	(a * b) >> 32.
+ */
+static inline uint32_t udivMulHi(uint32_t a, uint32_t b)
+{
+	uint32_t al = a & 0xFFFF, ah = a >> 16, bl = b & 0xFFFF, bh = b >> 16;
+	uint32_t lh = al * bh, hl = ah * bl;
+	uint32_t mid = ((al * bl) >> 16) + (lh & 0xFFFF) + (hl & 0xFFFF);
+
+	return ah * bh + (lh >> 16) + (hl >> 16) + (mid >> 16);
+}
+
+/**
+ * @brief	Divide by a divisor prepared with udivConstInit().
+ * @param	dc: the prepared divisor.
+ * @param	n: dividend.
+ * @return	n / d.
+ */
+static inline uint32_t udivConst(const udiv_const_t *dc, uint32_t n)
+{
+	uint32_t t = udivMulHi(dc->magic, n);
+
+	return (t + ((n - t) >> dc->shift1)) >> dc->shift2;
+}
+
+/**
+ * @brief	Divide by a compile time constant: the compiler folds the magic
+ * 			number and the shifts, which leaves a multiplication by the
+ * 			reciprocal (GCC calls __aeabi_uidiv for constants on the M0).
+ * 			A variable divisor falls back to the '/' operator.
+ * @param	n: dividend.
+ * @param	d: divisor.
+ * @return	n / d.
+ */
+static inline __attribute__((always_inline)) uint32_t udivByConst(uint32_t n, uint32_t d)
+{
+	uint32_t t;
+	int l;
+
+	if (!__builtin_constant_p(d) || d == 0)
+		return n / d;
+	if ((d & (d - 1)) == 0)
+		return n >> __builtin_ctz(d);
+	l = 32 - __builtin_clz(d - 1);		/* ceil(log2(d)), at least 2 */
+	t = udivMulHi((uint32_t) ((((1ULL << l) - d) << 32) / d + 1), n);
+	return (t + ((n - t) >> 1)) >> (l - 1);
+}
+
+#endif /* DIVIDE_H_ */
@@ -0,0 +1,100 @@
+/*
+ * dsp.h
+ *
+ * Fixed point signal processing kernels for the Cortex-M0: FIR, biquad
+ * IIR, moving average and CIC decimators, RMS/peak level detectors.
+ *
+ * Created on: 18 Oct 2026 (LNP)
+ *
+ * (c) 2026 Lixco Microsystems <lix@paulian.net>
+ */
+
+#ifndef DSP_H_
+#define DSP_H_
+
+#include <stdint.h>
+
+typedef int16_t q15_t;			/* 1.15 fixed point, -1.0 to 1.0 - 2^-15 */
+typedef int32_t q31_t;			/* 1.31 fixed point */
+
+#define Q15(x) ((q15_t) ((x) * 32768.0 + ((x) < 0 ? -0.5 : 0.5)))
+#define Q14(x) ((q15_t) ((x) * 16384.0 + ((x) < 0 ? -0.5 : 0.5)))
+
+#define DSP_CIC_MAX_ORDER 3
+
+/* FIR filter; the sum of the absolute values of the coefficients must be
+ * less than 2.0 */
+typedef struct
+{
+	const q15_t *coeffs;		/* b[0] to b[taps - 1] */
+	q15_t *state;				/* 2 * taps samples */
+	uint16_t taps;
+	uint16_t pos;
+} dsp_fir_t;
+
+/* cascade of biquads, direct form I; each stage has 5 coefficients in Q14
+ * (-2.0 to 2.0): b0, b1, b2, a1, a2, with a0 = 1 and
+ *   y[n] = b0 x[n] + b1 x[n-1] + b2 x[n-2] - a1 y[n-1] - a2 y[n-2] */
+typedef struct
+{
+	const q15_t *coeffs;		/* 5 * stages */
+	q15_t *state;				/* 4 * stages: x[n-1], x[n-2], y[n-1], y[n-2] */
+	uint8_t stages;
+} dsp_biquad_t;
+
+/* the same with 32 bits data, for filters with poles close to the unit
+ * circle (cut-off frequency much lower than the sample rate) */
+typedef struct
+{
+	const q15_t *coeffs;		/* 5 * stages, Q14 */
+	q31_t *state;				/* 4 * stages */
+	uint8_t stages;
+} dsp_biquad32_t;
+
+/* moving average over 2^n samples */
+typedef struct
+{
+	q15_t *hist;				/* 2^n samples */
+	int32_t sum;
+	uint16_t mask;
+	uint16_t pos;
+	uint8_t shift;
+} dsp_avg_t;
+
+/* CIC decimator by 2^n, unity gain */
+typedef struct
+{
+	int32_t integ[DSP_CIC_MAX_ORDER];
+	int32_t comb[DSP_CIC_MAX_ORDER];	/* previous comb inputs */
+	uint32_t phase;
+	uint8_t order;
+	uint8_t log2r;
+} dsp_cic_t;
+
+/* level detector: mean square with an exponential window of 2^shift
+ * samples, peak with instant attack and exponential release */
+typedef struct
+{
+	uint32_t ms;				/* mean square, Q30 */
+	q15_t peak;
+	uint8_t shift;
+} dsp_level_t;
+
+void dspFirInit(dsp_fir_t *fir, const q15_t *coeffs, q15_t *state, uint16_t taps);
+void dspFirQ15(dsp_fir_t *fir, const q15_t *in, q15_t *out, int count);
+void dspBiquadInit(dsp_biquad_t *bq, const q15_t *coeffs, q15_t *state, uint8_t stages);
+void dspBiquadQ15(dsp_biquad_t *bq, const q15_t *in, q15_t *out, int count);
+void dspBiquad32Init(dsp_biquad32_t *bq, const q15_t *coeffs, q31_t *state, uint8_t stages);
+void dspBiquadQ31(dsp_biquad32_t *bq, const q31_t *in, q31_t *out, int count);
+int dspAvgInit(dsp_avg_t *avg, q15_t *hist, uint8_t log2len);
+void dspAvgQ15(dsp_avg_t *avg, const q15_t *in, q15_t *out, int count);
+int dspCicInit(dsp_cic_t *cic, uint8_t order, uint8_t log2r);
+int dspCicQ15(dsp_cic_t *cic, const q15_t *in, q15_t *out, int count);
+void dspLevelInit(dsp_level_t *level, uint8_t shift);
+void dspLevelQ15(dsp_level_t *level, const q15_t *in, int count);
+q15_t dspLevelRms(const dsp_level_t *level);
+uint16_t dspSqrt(uint32_t x);
+void dspAdcToQ15(const uint16_t *in, q15_t *out, int count);
+int dspReadAdc(q15_t *out, int count);
+
+#endif /* DSP_H_ */
@@ -0,0 +1,74 @@
+/*
+ * frame.h
+ *
+ * Framed binary command protocol, multiplexed with the text CLI on the
+ * same serial line.
+ *
+ * Created on: 18 Oct 2026 (LNP)
+ *
+ * (c) 2026 Lixco Microsystems <lix@paulian.net>
+ */
+
+#ifndef FRAME_H_
+#define FRAME_H_
+
+#include <stdint.h>
+
+/* A frame is COBS encoded and enclosed between two FRAME_DELIMITER bytes:
+ *
+ *   0x00 COBS(seq cmd status data[0..FRAME_MAX_DATA-1] crc32) 0x00
+ *
+ * seq is chosen by the host and returned unchanged in the response, so that
+ * several requests can be in flight at the same time. The status byte is 0
+ * in requests; in responses the command has FRAME_RESPONSE set. The CRC32
+ * (IEEE 802.3, little endian) covers all bytes before it. */
+
+#define FRAME_DELIMITER 0
+#define FRAME_VERSION 2
+
+#define FRAME_HEADER 3			/* seq, cmd, status */
+#define FRAME_CRC 4
+#define FRAME_MAX_DATA 128
+#define FRAME_MAX_RAW (FRAME_HEADER + FRAME_MAX_DATA + FRAME_CRC)
+#define FRAME_MAX_ENCODED (FRAME_MAX_RAW + FRAME_MAX_RAW / 254 + 1)
+
+#define FRAME_RESPONSE 0x80
+
+/* frame commands */
+#define FRAME_CMD_PING 0x01		/* echo the data back */
+#define FRAME_CMD_INFO 0x02		/* protocol and platform information */
+#define FRAME_CMD_BAUD 0x03		/* change the baud rate (uint32_t) */
+#define FRAME_CMD_READ 0x10		/* read memory (uint32_t address, uint16_t size) */
+#define FRAME_CMD_WRITE 0x11	/* write RAM (uint32_t address, data) */
+
+/* frame status codes */
+#define FRAME_OK 0
+#define FRAME_ERR_CMD 1			/* unknown command */
+#define FRAME_ERR_PARAM 2		/* invalid parameter */
+#define FRAME_ERR_LENGTH 3		/* invalid data length */
+#define FRAME_ERR_ADDRESS 4		/* memory range not accessible */
+
+/* frame protocol statistics */
+typedef struct
+{
+	uint32_t frames;			/* frames received and executed */
+	uint32_t crc_errors;		/* frames dropped because of a bad CRC */
+	uint32_t format_errors;		/* frames dropped because of bad framing */
+	uint32_t tx_errors;			/* responses cut short, the UART was stuck */
+} frame_stats_t;
+
+/* this structure defines an entry in the frame command table; the command
+ * gets its data and length and returns the length of the response data
+ * (stored in place, at most FRAME_MAX_DATA bytes) or a negative status */
+typedef struct
+{
+	uint8_t cmd;
+	int (*func)(uint8_t *data, int len);
+} frame_cmds_t;
+
+extern frame_stats_t g_frameStats;
+
+uint32_t crc32(uint32_t crc, const uint8_t *data, int len);
+int frameProcess(void);
+
+#endif /* FRAME_H_ */
@@ -0,0 +1,28 @@
+/*
+ * heartbeat.h
+ *
+ * LED blink patterns and brightness driven by a hardware timer, without a
+ * task.
+ *
+ * Created on: 18 Oct 2026 (LNP)
+ *
+ * (c) 2026 Lixco Microsystems <lix@paulian.net>
+ */
+
+#ifndef HEARTBEAT_H_
+#define HEARTBEAT_H_
+
+#include <stdint.h>
+
+#define HB_STEP_MS 125			/* duration of a pattern bit */
+#define HB_PWM_HZ 200			/* PWM rate when dimmed */
+
+/* default pattern: LED6 and LED7 alternatively, half a second each */
+#define HB_DEFAULT_PATTERN 0x0F
+#define HB_DEFAULT_LENGTH 8
+
+void hbStart(void);
+int hbPattern(uint8_t led, uint32_t pattern, uint8_t length);
+int hbBrightness(uint8_t percent);
+
+#endif /* HEARTBEAT_H_ */
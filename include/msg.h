@@ -0,0 +1,46 @@
+/*
+ * msg.h
+ *
+ * Zero copy messages: buffers from fixed size pools, counted by reference,
+ * passed through the queues by pointer.
+ *
+ * Created on: 18 Oct 2026 (LNP)
+ *
+ * (c) 2026 Lixco Microsystems <lix@paulian.net>
+ */
+
+#ifndef MSG_H_
+#define MSG_H_
+
+#include <stdint.h>
+#include "FreeRTOS.h"
+#include "queue.h"
+
+/* words of storage for a pool of count messages of size bytes each, with
+ * their headers */
+#define MSG_POOL_WORDS(size, count) ((count) * (2 + ((size) + 3) / 4))
+
+/* a pool of messages of the same size */
+typedef struct
+{
+	void *free;					/* free list */
+	uint16_t size;				/* bytes, rounded up to words */
+	uint16_t count;
+	uint16_t used;
+	uint16_t peak;				/* max messages used at the same time */
+} msg_pool_t;
+
+/* a queue of messages, by pointer */
+#define msgQueueCreate(length) xQueueCreate((length), sizeof(void *))
+
+int msgPoolInit(msg_pool_t *pool, uint32_t *storage, uint16_t size,
+		uint16_t count);
+void *msgAlloc(msg_pool_t *pool);
+void msgRef(void *msg);
+void msgFree(void *msg);
+int msgSend(xQueueHandle queue, void *msg, portTickType timeout);
+int msgSendFromISR(xQueueHandle queue, void *msg, portBASE_TYPE *woken);
+void *msgReceive(xQueueHandle queue, portTickType timeout);
+void *msgReceiveFromISR(xQueueHandle queue, portBASE_TYPE *woken);
+
+#endif /* MSG_H_ */
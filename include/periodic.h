@@ -0,0 +1,44 @@
+/*
+ * periodic.h
+ *
+ * Periodic tasks with release jitter, execution time and deadline miss
+ * statistics.
+ *
+ * Created on: 18 Oct 2026 (LNP)
+ *
+ * (c) 2026 Lixco Microsystems <lix@paulian.net>
+ */
+
+#ifndef PERIODIC_H_
+#define PERIODIC_H_
+
+#include <stdint.h>
+#include "FreeRTOS.h"
+
+#define PERIODIC_MAX 4			/* max number of periodic tasks */
+
+/* the work of a periodic task, called once per period */
+typedef void (*periodic_fn_t)(void *param);
+
+/* statistics of a periodic task, times in microseconds; the release jitter
+ * is the spread of the start times around the nominal releases */
+typedef struct
+{
+	const char *name;
+	uint32_t period;
+	uint32_t deadline;			/* from the release */
+	uint32_t releases;
+	uint32_t misses;			/* runs finished after the deadline */
+	uint32_t jitter;
+	uint32_t exec_max;			/* start to end, preemptions included */
+	uint32_t exec_avg;			/* average of the last 16 runs or so */
+} periodic_stats_t;
+
+int periodicCreate(const char *name, periodic_fn_t fn, void *param,
+		portTickType period, portTickType deadline, unsigned portBASE_TYPE prio,
+		uint16_t stack);
+int periodicGetStats(int index, periodic_stats_t *stats);
+void periodicResetStats(void);
+int periodicLoad(uint32_t percent);
+
+#endif /* PERIODIC_H_ */
@@ -0,0 +1,79 @@
+/*
+ * pt.h
+ *
+ * Protothreads: stackless cooperative threads, all run by one FreeRTOS task,
+ * with delays and event waits.
+ *
+ * Created on: 18 Oct 2026 (LNP)
+ *
+ * (c) 2026 Lixco Microsystems <lix@paulian.net>
+ */
+
+#ifndef PT_H_
+#define PT_H_
+
+#include <stdint.h>
+#include "FreeRTOS.h"
+
+/* values returned by a protothread function */
+#define PT_WAITING 0			/* blocked on a delay or on events */
+#define PT_YIELDED 1			/* ready, let the others run */
+#define PT_EXITED 2				/* finished with PT_EXIT() */
+#define PT_ENDED 3				/* finished, reached PT_END() */
+
+struct pt_s;
+typedef int (*pt_fn_t)(struct pt_s *pt);
+
+/* a protothread; it is usually the first member of a structure which holds
+ * the variables that must survive the waits, since the locals don't */
+typedef struct pt_s
+{
+	struct pt_s *next;
+	pt_fn_t fn;
+	portTickType wake;			/* end of the delay or of the timeout */
+	uint32_t events;			/* posted and not consumed yet */
+	uint32_t wait;				/* events waited for, then the ones received */
+	uint16_t lc;				/* where to resume: a line number */
+	uint8_t state;
+} pt_t;
+
+/* The body of a protothread is a switch on the line it blocked at, so the
+ * macros below can't be used inside another switch statement. */
+#define PT_BEGIN(pt)	switch ((pt)->lc) { case 0:
+
+#define PT_END(pt)		} (pt)->lc = 0; return PT_ENDED
+
+#define PT_EXIT(pt)		do { (pt)->lc = 0; return PT_EXITED; } while (0)
+
+/* let the other protothreads run, come back at the next pass */
+#define PT_YIELD(pt) \
+	do { (pt)->lc = __LINE__; return PT_YIELDED; case __LINE__:; } while (0)
+
+/* block until a condition is true; it is checked at every tick */
+#define PT_WAIT_UNTIL(pt, cond) \
+	do { (pt)->lc = __LINE__; case __LINE__: \
+		if (!(cond)) { ptWait((pt), 0, 1); return PT_WAITING; } } while (0)
+
+#define PT_WAIT_WHILE(pt, cond)	PT_WAIT_UNTIL((pt), !(cond))
+
+/* block for a number of ticks */
+#define PT_DELAY(pt, ticks) \
+	do { ptWait((pt), 0, (ticks)); (pt)->lc = __LINE__; return PT_WAITING; \
+		case __LINE__:; } while (0)
+
+/* block until one of the events in mask is posted, or for timeout ticks
+ * (portMAX_DELAY for ever); PT_EVENTS() then gives the events received, 0 on
+ * a timeout. Events posted before the wait are not lost. */
+#define PT_WAIT_EVENT(pt, mask, timeout) \
+	do { ptWait((pt), (mask), (timeout)); (pt)->lc = __LINE__; \
+		return PT_WAITING; case __LINE__:; } while (0)
+
+#define PT_EVENTS(pt)	((pt)->wait)
+
+int ptInit(unsigned portBASE_TYPE prio, uint16_t stack);
+void ptStart(pt_t *pt, pt_fn_t fn);
+void ptWait(pt_t *pt, uint32_t mask, portTickType timeout);
+void ptPost(pt_t *pt, uint32_t events);
+void ptPostFromISR(pt_t *pt, uint32_t events, portBASE_TYPE *woken);
+
+#endif /* PT_H_ */
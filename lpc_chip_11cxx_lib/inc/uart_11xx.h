@@ -685,6 +685,20 @@ int Chip_UART_Read(LPC_USART_T *pUART, void *data, int numBytes);
  */
 uint32_t Chip_UART_SetBaud(LPC_USART_T *pUART, uint32_t baudrate);
 
+/**
+ * @brief	Finds the best divisor latch and fractional divider values for a bit rate
+ * @param	clkin		: UART input clock rate in Hz
+ * @param	baudrate	: Target baud rate (baud rate = bit rate)
+ * @param	pDL			: Pointer to return the divisor latch value
+ * @param	pMulVal		: Pointer to return the fractional divider MULVAL
+ * @param	pDivAddVal	: Pointer to return the fractional divider DIVADDVAL
+ * @return	The actual baud rate, or 0 if no rate can be found
+ * @note	All 120 valid MULVAL/DIVADDVAL pairs are searched; the registers are
+ *			not changed, so this can be used to check a rate before switching.
+ */
+uint32_t Chip_UART_CalcBaudFDR(uint32_t clkin, uint32_t baudrate,
+							   uint32_t *pDL, uint32_t *pMulVal, uint32_t *pDivAddVal);
+
 /**
  * @brief	Sets best dividers to get a target bit rate (with fractional divider)
  * @param	pUART		: Pointer to selected UART peripheral
@@ -228,56 +228,68 @@ void Chip_UART_IRQRBHandler(LPC_USART_T *pUART, RINGBUFF_T *pRXRB, RINGBUFF_T *p
 	Chip_UART_RXIntHandlerRB(pUART, pRXRB);
 }
 
+/* Searches all fractional divider settings for the best match of a baud rate */
+uint32_t Chip_UART_CalcBaudFDR(uint32_t clkin, uint32_t baudrate,
+							   uint32_t *pDL, uint32_t *pMulVal, uint32_t *pDivAddVal)
+{
+	uint32_t mval, dval, dl, div, rate, err;
+	uint32_t bestRate = 0, bestErr = 0xFFFFFFFF;
+
+	if (baudrate == 0) {
+		return 0;
+	}
+
+	/* The UART rate is clkin / (16 * DL * (1 + DIVADDVAL / MULVAL)), with
+	 * 1 <= MULVAL <= 15 and 0 <= DIVADDVAL < MULVAL. There are only 120 valid
+	 * MULVAL/DIVADDVAL pairs, so try them all and, for each pair, use the
+	 * rounded divisor latch value.
+	 */
+	for (mval = 1; mval <= 15; mval++) {
+		for (dval = 0; dval < mval; dval++) {
+			div = 16 * (mval + dval);
+			dl = ((clkin / div) * mval + (clkin % div) * mval / div + baudrate / 2) / baudrate;
+
+			/* DLL must be at least 3 when the fractional divider is in use */
+			if (dl == 0 || dl > 0xFFFF || (dval != 0 && dl < 3)) {
+				continue;
+			}
+
+			rate = (clkin / (dl * div)) * mval + (clkin % (dl * div)) * mval / (dl * div);
+			err = (rate > baudrate) ? (rate - baudrate) : (baudrate - rate);
+			if (err < bestErr) {
+				bestErr = err;
+				bestRate = rate;
+				*pDL = dl;
+				*pMulVal = mval;
+				*pDivAddVal = dval;
+				if (err == 0) {
+					return bestRate;
+				}
+			}
+		}
+	}
+
+	return bestRate;
+}
+
 /* Determines and sets best dividers to get a target baud rate */
 uint32_t Chip_UART_SetBaudFDR(LPC_USART_T *pUART, uint32_t baudrate)
-
 {
-	uint32_t uClk;
-    uint32_t dval, mval;
-    uint32_t dl;
-    uint32_t rate16 = 16 * baudrate;
-	uint32_t actualRate = 0;
-
-	/* Get Clock rate */
-	uClk = Chip_Clock_GetMainClockRate();
-
-    /* The fractional is calculated as (PCLK  % (16 * Baudrate)) / (16 * Baudrate)
-     * Let's make it to be the ratio DivVal / MulVal
-     */
-	dval = uClk % rate16;
-
-   /* The PCLK / (16 * Baudrate) is fractional
-    * => dval = pclk % rate16
-    * mval = rate16;
-    * now mormalize the ratio
-    * dval / mval = 1 / new_mval
-    * new_mval = mval / dval
-    * new_dval = 1
-    */
-    if (dval > 0) {
-        mval = rate16 / dval;
-        dval = 1;
-
-        /* In case mval still bigger then 4 bits
-        * no adjustment require
-        */
-        if (mval > 12) {
-         dval = 0;
-      }
-    }
-    dval &= 0xf;
-    mval &= 0xf;
-    dl = uClk / (rate16 + rate16 *dval / mval);
-
-    /* Update UART registers */
-    Chip_UART_EnableDivisorAccess(pUART);
+	uint32_t dl, mval, dval, actualRate;
+
+	actualRate = Chip_UART_CalcBaudFDR(Chip_Clock_GetMainClockRate(), baudrate,
+									   &dl, &mval, &dval);
+	if (actualRate == 0) {
+		return 0;
+	}
+
+	/* Update UART registers */
+	Chip_UART_EnableDivisorAccess(pUART);
 	Chip_UART_SetDivisorLatches(pUART, UART_LOAD_DLL(dl), UART_LOAD_DLM(dl));
 	Chip_UART_DisableDivisorAccess(pUART);
 
 	/* Set best fractional divider */
 	pUART->FDR = (UART_FDR_MULVAL(mval) | UART_FDR_DIVADDVAL(dval));
 
-	/* Return actual baud rate */
-	actualRate = uClk / (16 * dl + 16 * dl * dval / mval);
 	return actualRate;
 }
@@ -0,0 +1,371 @@
+/*
+ * adc.c
+ *
+ * Created on: 18 Oct 2026 (LNP)
+ *
+ * Copyright (c) 2026 Lixco Microsystems <lix@paulian.net>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+/*
+ * This file implements a continuous ADC acquisition: the ADC runs in burst
+ * mode over a set of channels and the interrupt of the last channel of the
+ * scan stores the results in a ring buffer. The ring has a single producer
+ * (the ISR, which only moves the head) and a single consumer (which only
+ * moves the tail), so neither side needs a lock. The samples of a scan are
+ * stored in channel order and only if the whole scan fits in the ring.
+ *
+ * In the timed mode a single channel is converted on the rising edges of the
+ * CT16B0 MAT0 signal, which toggles at twice the sample rate: the sampling
+ * instants are exact, independent of the interrupt and scheduler latencies.
+ * The ISR reads the timer to measure its own latency from the trigger, whose
+ * spread is reported as the jitter. Every ADC_BLOCK_SIZE samples the ISR also
+ * records the tick count, so that a consumer can date the blocks it reads
+ * even if samples were dropped.
+ */
+
+#include <string.h>
+#include "olimex_p1114.h"
+#include "FreeRTOS.h"
+#include "task.h"
+#include "semphr.h"
+#include "adc.h"
+
+#define ADC_CLOCKS 11			/* ADC clocks per 10 bits conversion */
+#define ADC_MAX_CLKDIV 256
+#define ADC_BLOCKS (ADC_RING_SIZE / ADC_BLOCK_SIZE)
+
+/* the LPC11xx START value 6 (edge on CT16B0_MAT0) has another name in the
+ * chip library enum */
+#define ADC_START_ON_CT16B0_MAT0 ((ADC_START_MODE_T) 6)
+
+static uint16_t adcRing[ADC_RING_SIZE];
+static volatile uint32_t adcHead;	/* free running, written by the ISR only */
+static volatile uint32_t adcTail;	/* free running, written by the consumer only */
+static volatile uint32_t adcWaitLevel;	/* samples the consumer waits for */
+static SemaphoreHandle_t adcReady;
+
+static int adcRunning;
+static uint8_t adcScan[8];		/* converted channels, in scan order */
+static int adcScanLen;
+static adc_stats_t adcStats;
+static portTickType adcBlockTick[ADC_BLOCKS];	/* tick of each block first sample */
+
+static int adcTimed;			/* timer triggered conversions */
+static uint32_t adcTimerClock;	/* timer count rate, Hz */
+static uint16_t adcLatencyMin;	/* trigger to ISR, in timer counts */
+static uint16_t adcLatencyMax;
+
+/**
+ * @brief	Reset the ring and the statistics, power up the ADC and select
+ * 			the channels to convert.
+ * @param	channels: bit mask of the channels to convert.
+ * @param	setup: ADC clock setup.
+ * @return	SUCCESS, or ERROR if no semaphore could be allocated.
+ */
+static int adcSetup(uint8_t channels, ADC_CLOCK_SETUP_T *setup)
+{
+	int ch;
+
+	if (!adcReady && !(adcReady = xSemaphoreCreateBinary()))
+		return ERROR;
+
+	adcStop();
+	adcScanLen = 0;
+	for (ch = 0; ch < 8; ch++)
+	{
+		if (channels & (1 << ch))
+			adcScan[adcScanLen++] = ch;
+	}
+	adcHead = adcTail = 0;
+	memset(&adcStats, 0, sizeof(adcStats));
+	adcLatencyMin = 0xFFFF;
+	adcLatencyMax = 0;
+
+	Chip_ADC_Init(LPC_ADC, setup);
+	for (ch = 0; ch < adcScanLen; ch++)
+		Chip_ADC_EnableChannel(LPC_ADC, (ADC_CHANNEL_T) adcScan[ch], ENABLE);
+	return SUCCESS;
+}
+
+/**
+ * @brief	Start the acquisition.
+ * @param	channels: bit mask of the channels to convert.
+ * @param	rate: conversions per second, all channels together; in burst mode
+ * 			the ADC clock divider limits the lowest rate to about 17000.
+ * @return	SUCCESS if the acquisition was started, ERROR otherwise.
+ */
+int adcStart(uint8_t channels, uint32_t rate)
+{
+	ADC_CLOCK_SETUP_T setup;
+
+	if (!channels || rate > ADC_MAX_RATE
+			|| rate * ADC_CLOCKS * ADC_MAX_CLKDIV < Chip_Clock_GetSystemClockRate()
+			|| adcSetup(channels, &setup) == ERROR)
+		return ERROR;
+
+	setup.burstMode = TRUE;
+	Chip_ADC_SetSampleRate(LPC_ADC, &setup, rate);
+
+	/* one interrupt per scan, when the last channel is done */
+	Chip_ADC_Int_SetChannelCmd(LPC_ADC, adcScan[adcScanLen - 1], ENABLE);
+	NVIC_EnableIRQ(ADC_IRQn);
+	Chip_ADC_SetBurstCmd(LPC_ADC, ENABLE);
+	adcRunning = TRUE;
+	return SUCCESS;
+}
+
+/**
+ * @brief	Start a timer triggered acquisition on a single channel; the ADC
+ * 			runs at its fastest clock and each conversion is started by the
+ * 			CT16B0 MAT0 signal, toggled by the timer at twice the sample rate.
+ * @param	channel: channel to convert, 0 to 7.
+ * @param	rate: samples per second.
+ * @return	the actual sample rate, which may differ from the requested one
+ * 			by the rounding of the timer period, or 0 on error.
+ */
+uint32_t adcStartTimed(uint8_t channel, uint32_t rate)
+{
+	ADC_CLOCK_SETUP_T setup;
+	uint32_t clk = Chip_Clock_GetSystemClockRate(), prescale, half;
+
+	if (channel > 7 || !rate || rate > ADC_MAX_RATE)
+		return 0;
+
+	/* smallest prescaler giving a 16 bits half period, for the finest
+	 * resolution of the rate and of the latency measurement */
+	prescale = clk / rate / (2 * 0x10000) + 1;
+	half = (clk / prescale + rate) / (rate * 2);
+	if (!half || adcSetup(1 << channel, &setup) == ERROR)
+		return 0;
+
+	Chip_TIMER_Init(LPC_TIMER16_0);
+	Chip_TIMER_Reset(LPC_TIMER16_0);
+	Chip_TIMER_PrescaleSet(LPC_TIMER16_0, prescale - 1);
+	Chip_TIMER_SetMatch(LPC_TIMER16_0, 0, half - 1);
+	Chip_TIMER_ResetOnMatchEnable(LPC_TIMER16_0, 0);
+	Chip_TIMER_ExtMatchControlSet(LPC_TIMER16_0, 0, TIMER_EXTMATCH_TOGGLE, 0);
+	adcTimerClock = clk / prescale;
+
+	Chip_ADC_Int_SetChannelCmd(LPC_ADC, channel, ENABLE);
+	NVIC_EnableIRQ(ADC_IRQn);
+	Chip_ADC_SetStartMode(LPC_ADC, ADC_START_ON_CT16B0_MAT0, ADC_TRIGGERMODE_RISING);
+	adcTimed = adcRunning = TRUE;
+	Chip_TIMER_Enable(LPC_TIMER16_0);
+	return clk / (prescale * half * 2);
+}
+
+/**
+ * @brief	Stop the acquisition; the samples in the ring can still be read.
+ */
+void adcStop(void)
+{
+	if (!adcRunning)
+		return;
+	if (adcTimed)
+	{
+		Chip_TIMER_Disable(LPC_TIMER16_0);
+		Chip_TIMER_DeInit(LPC_TIMER16_0);
+		adcTimed = FALSE;
+	}
+	NVIC_DisableIRQ(ADC_IRQn);
+	Chip_ADC_DeInit(LPC_ADC);
+	NVIC_ClearPendingIRQ(ADC_IRQn);
+	adcRunning = FALSE;
+}
+
+/**
+ * @brief	Number of channels in a scan; a consumer reading multiples of this
+ * 			number always gets whole scans.
+ * @return	the number of channels.
+ */
+int adcChannels(void)
+{
+	return adcScanLen;
+}
+
+/**
+ * @brief	Handle the ADC interrupt: store a scan in the ring.
+ */
+void ADC_IRQHandler(void)
+{
+	portBASE_TYPE xHigherPriorityTaskWoken = pdFALSE;
+	uint32_t head = adcHead, level, dr;
+	uint16_t latency;
+	int i;
+
+	if (adcTimed)
+	{
+		/* the timer restarts from 0 on each edge of MAT0, so its count is the
+		 * time elapsed since the trigger (if less than half a period) */
+		latency = Chip_TIMER_ReadCount(LPC_TIMER16_0);
+		if (latency < adcLatencyMin)
+			adcLatencyMin = latency;
+		if (latency > adcLatencyMax)
+			adcLatencyMax = latency;
+	}
+
+	level = head - adcTail;
+	if (level + adcScanLen > ADC_RING_SIZE)
+	{
+		for (i = 0; i < adcScanLen; i++)	/* reading clears the DONE flags */
+			(void) LPC_ADC->DR[adcScan[i]];
+		adcStats.dropped += adcScanLen;
+	}
+	else
+	{
+		for (i = 0; i < adcScanLen; i++)
+		{
+			dr = LPC_ADC->DR[adcScan[i]];
+			if (ADC_DR_OVERRUN(dr))
+				adcStats.overruns++;
+			if (!(head & (ADC_BLOCK_SIZE - 1)))
+				adcBlockTick[(head / ADC_BLOCK_SIZE) & (ADC_BLOCKS - 1)] =
+						xTaskGetTickCountFromISR();
+			adcRing[head++ & (ADC_RING_SIZE - 1)] = ADC_DR_RESULT(dr);
+		}
+		adcHead = head;
+		adcStats.samples += adcScanLen;
+		level += adcScanLen;
+		if (level > adcStats.peak)
+			adcStats.peak = level;
+	}
+
+	if (adcWaitLevel && level >= adcWaitLevel)
+	{
+		adcWaitLevel = 0;
+		xSemaphoreGiveFromISR(adcReady, &xHigherPriorityTaskWoken);
+	}
+	portEND_SWITCHING_ISR(xHigherPriorityTaskWoken);
+}
+
+/**
+ * @brief	Read a block of samples, waiting until they are all available.
+ * @param	buff: buffer receiving the samples.
+ * @param	count: number of samples, at most ADC_RING_SIZE.
+ * @param	timeout: max time to wait.
+ * @return	count, or 0 on timeout.
+ */
+int adcRead(uint16_t *buff, int count, portTickType timeout)
+{
+	uint32_t tail = adcTail, first;
+
+	if (count <= 0 || count > ADC_RING_SIZE)
+		return 0;
+
+	if (adcHead - tail < (uint32_t) count)
+	{
+		xSemaphoreTake(adcReady, 0);	/* drop a stale wake up */
+		adcWaitLevel = count;
+		if (adcHead - tail < (uint32_t) count)	/* not arrived meanwhile */
+			xSemaphoreTake(adcReady, timeout);
+		adcWaitLevel = 0;
+		if (adcHead - tail < (uint32_t) count)
+			return 0;
+	}
+
+	/* copy in at most two parts, the ring may wrap */
+	first = ADC_RING_SIZE - (tail & (ADC_RING_SIZE - 1));
+	if (first > (uint32_t) count)
+		first = count;
+	memcpy(buff, &adcRing[tail & (ADC_RING_SIZE - 1)], first * sizeof(uint16_t));
+	memcpy(buff + first, adcRing, (count - first) * sizeof(uint16_t));
+	adcTail = tail + count;
+	return count;
+}
+
+/**
+ * @brief	Get the samples available in the ring without copying them; they
+ * 			must be released with adcConsume().
+ * @param	data: pointer to return the address of the oldest sample.
+ * @return	number of contiguous samples at that address.
+ */
+int adcPeek(const uint16_t **data)
+{
+	uint32_t tail = adcTail, count, first;
+
+	count = adcHead - tail;
+	first = ADC_RING_SIZE - (tail & (ADC_RING_SIZE - 1));
+	*data = &adcRing[tail & (ADC_RING_SIZE - 1)];
+	return count < first ? count : first;
+}
+
+/**
+ * @brief	Release samples obtained with adcPeek().
+ * @param	count: number of samples.
+ */
+void adcConsume(int count)
+{
+	adcTail += count;
+}
+
+/**
+ * @brief	Index of the oldest sample in the ring; the samples are numbered
+ * 			from 0 since the acquisition start, the dropped ones excluded.
+ * @return	the sample index.
+ */
+uint32_t adcIndex(void)
+{
+	return adcTail;
+}
+
+/**
+ * @brief	Get the time stamp of the block holding a sample.
+ * @param	index: sample index, as returned by adcIndex().
+ * @param	tick: pointer to return the tick count when the first sample of the
+ * 			block was stored.
+ * @return	SUCCESS, or ERROR if the block is not in the ring.
+ */
+int adcGetTimestamp(uint32_t index, portTickType *tick)
+{
+	uint32_t head = adcHead, block = index & ~(ADC_BLOCK_SIZE - 1);
+
+	if (head - index - 1 >= ADC_RING_SIZE || head - block > ADC_RING_SIZE)
+		return ERROR;
+	*tick = adcBlockTick[(block / ADC_BLOCK_SIZE) & (ADC_BLOCKS - 1)];
+	return SUCCESS;
+}
+
+/**
+ * @brief	Get the acquisition statistics.
+ * @param	stats: pointer to return the statistics.
+ */
+void adcGetStats(adc_stats_t *stats)
+{
+	uint16_t min, max;
+	uint32_t khz, q, r;
+
+	taskENTER_CRITICAL();
+	*stats = adcStats;
+	stats->level = adcHead - adcTail;
+	min = adcLatencyMin;
+	max = adcLatencyMax;
+	taskEXIT_CRITICAL();
+
+	/* counts to ns: count * 10^6 / kHz, split so that nothing overflows */
+	khz = adcTimerClock / 1000;
+	if (khz && min <= max)
+	{
+		q = 1000000 / khz;
+		r = 1000000 - q * khz;
+		stats->latency_min = min * q + min * r / khz;
+		stats->latency_max = max * q + max * r / khz;
+	}
+}
@@ -0,0 +1,429 @@
+/*
+ * ao.c
+ *
+ * Created on: 18 Oct 2026 (LNP)
+ *
+ * Copyright (c) 2026 Lixco Microsystems <lix@paulian.net>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+/*
+ * The active objects communicate only by events. Each one has a queue of
+ * event pointers and a handler which runs every event to completion; the
+ * active objects are shared by a few dispatcher tasks (threads), each of
+ * them running the event of its highest priority active object first. A
+ * component then costs its queue instead of a task stack, and events between
+ * active objects of the same thread cost no context switch.
+ *
+ * The pool events are counted by reference: each queue holding an event
+ * holds a reference, dropped after the handler returns, and the last one
+ * returns the event to the pool. Static events (time events, or events of
+ * the application with refs set to AO_STATIC) are never recycled. The pool
+ * and the queues are protected by masking the interrupts, so events can be
+ * allocated and posted from interrupts.
+ */
+
+#include "FreeRTOS.h"
+#include "task.h"
+#include "timers.h"
+#include "ao.h"
+
+static ao_event_t aoPool[AO_POOL_SIZE];
+static ao_event_t *aoFree;
+static ao_t *aoTable[AO_MAX];			/* by priority */
+static uint8_t aoSubscribers[AO_MAX_SIGNALS];	/* priorities bit mask */
+
+/**
+ * @brief	Return an event to the pool when its last reference is dropped.
+ * @param	e: the event.
+ */
+static void aoGc(ao_event_t *e)
+{
+	uint32_t mask;
+
+	if (e->refs == AO_STATIC)
+		return;
+
+	mask = portSET_INTERRUPT_MASK_FROM_ISR();
+	if (e->refs > 1)
+		e->refs--;
+	else
+	{
+		e->refs = 0;
+		e->next = aoFree;
+		aoFree = e;
+	}
+	portCLEAR_INTERRUPT_MASK_FROM_ISR(mask);
+}
+
+/**
+ * @brief	Put an event in the queue of an active object.
+ * @param	ao: the active object.
+ * @param	e: the event.
+ * @return	SUCCESS or ERROR if the queue is full.
+ */
+static int aoEnqueue(ao_t *ao, ao_event_t *e)
+{
+	uint32_t mask;
+	uint8_t tail;
+
+	mask = portSET_INTERRUPT_MASK_FROM_ISR();
+	if (ao->count >= ao->size)
+	{
+		portCLEAR_INTERRUPT_MASK_FROM_ISR(mask);
+		return ERROR;
+	}
+	if (e->refs != AO_STATIC)
+		e->refs++;
+	tail = ao->head + ao->count;
+	if (tail >= ao->size)
+		tail -= ao->size;
+	ao->queue[tail] = e;
+	ao->count++;
+	ao->thread->ready |= 1 << ao->prio;
+	portCLEAR_INTERRUPT_MASK_FROM_ISR(mask);
+	return SUCCESS;
+}
+
+/**
+ * @brief	Run the events of the active objects of a thread, highest
+ * 			priority first, until their queues are empty.
+ * @param	thread: the thread.
+ */
+static void aoDispatch(ao_thread_t *thread)
+{
+	ao_event_t *e;
+	ao_t *ao;
+	uint32_t mask;
+	int prio;
+
+	for (;;)
+	{
+		mask = portSET_INTERRUPT_MASK_FROM_ISR();
+		for (prio = AO_MAX - 1; prio >= 0; prio--)
+		{
+			if (thread->ready & (1 << prio))
+				break;
+		}
+		if (prio < 0)
+		{
+			portCLEAR_INTERRUPT_MASK_FROM_ISR(mask);
+			return;
+		}
+		ao = aoTable[prio];
+		e = ao->queue[ao->head];
+		if (++ao->head >= ao->size)
+			ao->head = 0;
+		if (!--ao->count)
+			thread->ready &= ~(1 << prio);
+		portCLEAR_INTERRUPT_MASK_FROM_ISR(mask);
+
+		ao->handler(ao, e);
+		aoGc(e);
+	}
+}
+
+/**
+ * @brief	Dispatcher task: run the events of its active objects when one
+ * 			is posted.
+ * @param	pvParameters: the thread.
+ */
+static void aoThreadTask(void *pvParameters)
+{
+	ao_thread_t *thread = pvParameters;
+
+	for (;;)
+	{
+		ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+		aoDispatch(thread);
+	}
+}
+
+/**
+ * @brief	Initialise the event pool; call it before any other function.
+ */
+void aoInit(void)
+{
+	int i;
+
+	aoFree = NULL;
+	for (i = AO_POOL_SIZE - 1; i >= 0; i--)
+	{
+		aoPool[i].next = aoFree;
+		aoFree = &aoPool[i];
+	}
+}
+
+/**
+ * @brief	Create a dispatcher task.
+ * @param	thread: the thread.
+ * @param	prio: task priority.
+ * @param	stack: stack size, words; the handlers run on this stack.
+ * @return	SUCCESS or ERROR if the task couldn't be created.
+ */
+int aoThreadInit(ao_thread_t *thread, unsigned portBASE_TYPE prio,
+		uint16_t stack)
+{
+	thread->ready = 0;
+	if (xTaskCreate(aoThreadTask, "ao", stack, thread, prio, &thread->task)
+			!= pdPASS)
+		return ERROR;
+	return SUCCESS;
+}
+
+/**
+ * @brief	Start an active object.
+ * @param	ao: the active object.
+ * @param	prio: its priority, 0 to AO_MAX - 1, unique.
+ * @param	handler: the event handler.
+ * @param	queue: storage for the event queue.
+ * @param	size: number of events in the queue.
+ * @param	thread: the thread which dispatches the events.
+ * @return	SUCCESS or ERROR if the priority is out of range or taken.
+ */
+int aoStart(ao_t *ao, uint8_t prio, ao_handler_t handler, ao_event_t **queue,
+		uint8_t size, ao_thread_t *thread)
+{
+	if (prio >= AO_MAX || aoTable[prio] || !size)
+		return ERROR;
+
+	ao->handler = handler;
+	ao->queue = queue;
+	ao->thread = thread;
+	ao->size = size;
+	ao->head = 0;
+	ao->count = 0;
+	ao->prio = prio;
+	aoTable[prio] = ao;
+	return SUCCESS;
+}
+
+/**
+ * @brief	Get an event from the pool; can be called from interrupts.
+ * @param	sig: the event signal.
+ * @return	the event, or NULL if the pool is empty.
+ */
+ao_event_t *aoNew(uint8_t sig)
+{
+	ao_event_t *e;
+	uint32_t mask;
+
+	mask = portSET_INTERRUPT_MASK_FROM_ISR();
+	if ((e = aoFree))
+		aoFree = e->next;
+	portCLEAR_INTERRUPT_MASK_FROM_ISR(mask);
+	if (e)
+	{
+		e->sig = sig;
+		e->refs = 0;
+	}
+	return e;
+}
+
+/**
+ * @brief	Post an event to an active object; a pool event which can't be
+ * 			posted and isn't held elsewhere returns to the pool.
+ * @param	ao: the active object.
+ * @param	e: the event.
+ * @return	SUCCESS or ERROR if the queue is full.
+ */
+int aoPost(ao_t *ao, ao_event_t *e)
+{
+	if (aoEnqueue(ao, e) == ERROR)
+	{
+		if (!e->refs)
+			aoGc(e);
+		return ERROR;
+	}
+	xTaskNotifyGive(ao->thread->task);
+	return SUCCESS;
+}
+
+/**
+ * @brief	Post an event to an active object from an interrupt.
+ * @param	ao: the active object.
+ * @param	e: the event.
+ * @param	woken: set to pdTRUE if a context switch is needed at the end of
+ * 			the interrupt.
+ * @return	SUCCESS or ERROR if the queue is full.
+ */
+int aoPostFromISR(ao_t *ao, ao_event_t *e, portBASE_TYPE *woken)
+{
+	if (aoEnqueue(ao, e) == ERROR)
+	{
+		if (!e->refs)
+			aoGc(e);
+		return ERROR;
+	}
+	vTaskNotifyGiveFromISR(ao->thread->task, woken);
+	return SUCCESS;
+}
+
+/**
+ * @brief	Subscribe an active object to a signal.
+ * @param	ao: the active object.
+ * @param	sig: the signal.
+ * @return	SUCCESS or ERROR if the signal is out of range.
+ */
+int aoSubscribe(ao_t *ao, uint8_t sig)
+{
+	if (sig >= AO_MAX_SIGNALS)
+		return ERROR;
+
+	taskENTER_CRITICAL();
+	aoSubscribers[sig] |= 1 << ao->prio;
+	taskEXIT_CRITICAL();
+	return SUCCESS;
+}
+
+/**
+ * @brief	Unsubscribe an active object from a signal.
+ * @param	ao: the active object.
+ * @param	sig: the signal.
+ * @return	SUCCESS or ERROR if the signal is out of range.
+ */
+int aoUnsubscribe(ao_t *ao, uint8_t sig)
+{
+	if (sig >= AO_MAX_SIGNALS)
+		return ERROR;
+
+	taskENTER_CRITICAL();
+	aoSubscribers[sig] &= ~(1 << ao->prio);
+	taskEXIT_CRITICAL();
+	return SUCCESS;
+}
+
+/**
+ * @brief	Post an event to the subscribers of its signal, the same event
+ * 			to all of them.
+ * @param	e: the event.
+ * @param	woken: NULL from a task, else set to pdTRUE if a context switch is
+ * 			needed at the end of the interrupt.
+ * @return	SUCCESS, or ERROR if a subscriber's queue was full.
+ */
+static int aoMulticast(ao_event_t *e, portBASE_TYPE *woken)
+{
+	uint32_t mask;
+	uint8_t subs;
+	int prio, res = SUCCESS;
+
+	if (e->sig >= AO_MAX_SIGNALS)
+		return ERROR;
+
+	/* hold the event until it is in all the queues */
+	mask = portSET_INTERRUPT_MASK_FROM_ISR();
+	subs = aoSubscribers[e->sig];
+	if (e->refs != AO_STATIC)
+		e->refs++;
+	portCLEAR_INTERRUPT_MASK_FROM_ISR(mask);
+
+	for (prio = AO_MAX - 1; prio >= 0; prio--)
+	{
+		if (!(subs & (1 << prio)))
+			continue;
+		if (aoEnqueue(aoTable[prio], e) == ERROR)
+			res = ERROR;
+		else if (woken)
+			vTaskNotifyGiveFromISR(aoTable[prio]->thread->task, woken);
+		else
+			xTaskNotifyGive(aoTable[prio]->thread->task);
+	}
+	aoGc(e);
+	return res;
+}
+
+/**
+ * @brief	Publish an event: post it to the subscribers of its signal.
+ * @param	e: the event.
+ * @return	SUCCESS, or ERROR if a subscriber's queue was full.
+ */
+int aoPublish(ao_event_t *e)
+{
+	return aoMulticast(e, NULL);
+}
+
+/**
+ * @brief	Publish an event from an interrupt.
+ * @param	e: the event.
+ * @param	woken: set to pdTRUE if a context switch is needed at the end of
+ * 			the interrupt.
+ * @return	SUCCESS, or ERROR if a subscriber's queue was full.
+ */
+int aoPublishFromISR(ao_event_t *e, portBASE_TYPE *woken)
+{
+	return aoMulticast(e, woken);
+}
+
+#if ( configUSE_TICK_TIMERS == 1 )
+/**
+ * @brief	Timer callback of the time events, run by the tick interrupt.
+ * @param	xTimer: the timer.
+ */
+static void aoTimeCallback(TimerHandle_t xTimer)
+{
+	ao_time_t *te = pvTimerGetTimerID(xTimer);
+	portBASE_TYPE woken = pdFALSE;
+
+	aoPostFromISR(te->ao, &te->event, &woken);
+	portEND_SWITCHING_ISR(woken);
+}
+
+/**
+ * @brief	Create a time event.
+ * @param	te: the time event.
+ * @param	ao: the active object it is posted to.
+ * @param	sig: the signal of the event.
+ * @param	periodic: TRUE to post the event every period once armed, FALSE
+ * 			to post it once.
+ * @return	SUCCESS or ERROR if the timer couldn't be created.
+ */
+int aoTimeInit(ao_time_t *te, ao_t *ao, uint8_t sig, int periodic)
+{
+	te->event.sig = sig;
+	te->event.refs = AO_STATIC;
+	te->ao = ao;
+	if (!(te->timer = xTimerCreateTick("ao", 1, periodic ? pdTRUE : pdFALSE,
+			te, aoTimeCallback)))
+		return ERROR;
+	return SUCCESS;
+}
+
+/**
+ * @brief	Arm a time event, or re-arm it if already armed.
+ * @param	te: the time event.
+ * @param	ticks: delay before the event, and its period if periodic.
+ * @return	SUCCESS or ERROR if the delay is 0.
+ */
+int aoTimeArm(ao_time_t *te, portTickType ticks)
+{
+	if (!ticks || xTimerChangePeriod(te->timer, ticks, 0) != pdPASS)
+		return ERROR;
+	return SUCCESS;
+}
+
+/**
+ * @brief	Disarm a time event; an event already posted is still processed.
+ * @param	te: the time event.
+ */
+void aoTimeDisarm(ao_time_t *te)
+{
+	xTimerStop(te->timer, 0);
+}
+#endif /* configUSE_TICK_TIMERS */
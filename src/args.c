@@ -0,0 +1,195 @@
+/*
+ * args.c
+ *
+ * Created on: 18 Oct 2026 (LNP)
+ *
+ * Copyright (c) 2026 Lixco Microsystems <lix@paulian.net>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+/*
+ * This file implements the CLI argument parser: each command declares its
+ * arguments in a table (see args.h) and the parser checks and converts them
+ * before the command is called. It replaces sscanf(), which pulls most of the
+ * newlib scanf machinery in the flash and needs a lot of stack.
+ */
+
+#include <string.h>
+#include <stdio.h>
+#include "lpc_types.h"
+#include "args.h"
+
+/**
+ * @brief	Convert a string to an unsigned number.
+ * @param	str: the string.
+ * @param	base: 10 or 16; in base 10, a "0x" prefix selects base 16.
+ * @param	value: pointer to return the number.
+ * @return	SUCCESS if the string is a valid number that fits on 32 bits,
+ * 			ERROR otherwise.
+ */
+static int argNumber(const char *str, int base, uint32_t *value)
+{
+	uint32_t n = 0, digit;
+
+	if (str[0] == '0' && (str[1] == 'x' || str[1] == 'X'))
+	{
+		base = 16;
+		str += 2;
+	}
+	if (!*str)
+		return ERROR;
+
+	for (; *str; str++)
+	{
+		if (*str >= '0' && *str <= '9')
+			digit = *str - '0';
+		else if (base == 16 && (*str | 0x20) >= 'a' && (*str | 0x20) <= 'f')
+			digit = (*str | 0x20) - 'a' + 10;
+		else
+			return ERROR;
+
+		/* overflow check without a division */
+		if (n > (base == 16 ? 0x0FFFFFFF : 429496729)
+				|| (base == 10 && n == 429496729 && digit > 5))
+			return ERROR;
+		n = (base == 16 ? n << 4 : (n << 3) + (n << 1)) + digit;
+	}
+	*value = n;
+	return SUCCESS;
+}
+
+/**
+ * @brief	Convert and check an argument against its specification.
+ * @param	spec: the argument specification.
+ * @param	str: the argument.
+ * @param	value: pointer to return the value.
+ * @return	SUCCESS if the argument is valid, ERROR otherwise.
+ */
+static int argConvert(const arg_spec_t *spec, const char *str,
+		arg_value_t *value)
+{
+	uint32_t i;
+
+	value->present = TRUE;
+	value->str = str;
+	switch (spec->type)
+	{
+	case ARG_DEC:
+	case ARG_HEX:
+		if (argNumber(str, spec->type == ARG_HEX ? 16 : 10, &value->num)
+				== ERROR || value->num < spec->min || value->num > spec->max)
+			return ERROR;
+		break;
+
+	case ARG_ENUM:
+		for (i = 0; spec->choices[i]; i++)
+		{
+			if (!strcmp(str, spec->choices[i]))
+			{
+				value->num = i;
+				return SUCCESS;
+			}
+		}
+		return ERROR;
+
+	default:
+		break;
+	}
+	return SUCCESS;
+}
+
+/**
+ * @brief	Parse the arguments of a command.
+ * @param	spec: the argument specification of the command.
+ * @param	argc: arguments count.
+ * @param	argv: arguments list.
+ * @param	values: array receiving the values, one for each specification
+ * 			entry (at most ARGS_MAX).
+ * @return	SUCCESS if the arguments are valid, ARGS_HELP if "-h" was given,
+ * 			ERROR otherwise.
+ */
+int argsParse(const arg_spec_t *spec, int argc, char *argv[],
+		arg_value_t *values)
+{
+	int i, k, pos = 0;
+
+	memset(values, 0, ARGS_MAX * sizeof(arg_value_t));
+	for (i = 0; i < argc; i++)
+	{
+		if (!strcmp(argv[i], "-h"))
+			return ARGS_HELP;
+
+		/* options first, they can be anywhere on the line */
+		for (k = 0; spec[k].name; k++)
+		{
+			if (spec[k].type == ARG_FLAG && !strcmp(argv[i], spec[k].name))
+				break;
+		}
+		if (spec[k].name)
+		{
+			values[k].present = TRUE;
+			values[k].str = argv[i];
+			continue;
+		}
+
+		/* then the next positional argument */
+		while (spec[pos].name && spec[pos].type == ARG_FLAG)
+			pos++;
+		if (!spec[pos].name || argConvert(&spec[pos], argv[i], &values[pos]) == ERROR)
+			return ERROR;
+		pos++;
+	}
+
+	/* check that no mandatory argument is missing */
+	for (k = 0; spec[k].name; k++)
+	{
+		if (!spec[k].optional && !values[k].present)
+			return ERROR;
+	}
+	return SUCCESS;
+}
+
+/**
+ * @brief	Print the usage of a command, built from its specification.
+ * @param	cmd: the command name.
+ * @param	spec: the argument specification of the command.
+ */
+void argsUsage(const char *cmd, const arg_spec_t *spec)
+{
+	const char * const *choice;
+
+	printf("Usage: %s", cmd);
+	for (; spec->name; spec++)
+	{
+		printf(spec->optional ? " [" : " ");
+		if (spec->type == ARG_ENUM)
+		{
+			printf("{");
+			for (choice = spec->choices; *choice; choice++)
+				printf(choice == spec->choices ? "%s" : "|%s", *choice);
+			printf("}");
+		}
+		else
+			printf("%s", spec->name);
+		if (spec->optional)
+			printf("]");
+	}
+	printf("\r\n");
+}
@@ -0,0 +1,609 @@
+/*
+ * bench.c
+ *
+ * Created on: 18 Oct 2026 (LNP)
+ *
+ * Copyright (c) 2026 Lixco Microsystems <lix@paulian.net>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+/*
+ * Kernel benchmarks in the spirit of Thread-Metric: each test repeats an
+ * operation count times and prints one line "name,count,cycles" with the
+ * average CPU cycles per operation, easy to collect and compare from a
+ * script. The cycles are read from SysTick, which the kernel runs at the
+ * core clock, so the benchmarks don't need a timer of their own.
+ *
+ * The helper tasks are created for the duration of a test; the interrupt
+ * test uses the watchdog interrupt, pended by software (the watchdog itself
+ * is not used). The timer tests measure the cycles from the tick interrupt
+ * to the callback, for a timer of the service task and for a timer run by
+ * the tick interrupt; they last one tick per operation. The message tests
+ * compare a queue copying messages of several sizes with the zero copy
+ * messages (msg.c), allocation and free included. The division tests time
+ * the run time of divide.S for quotients of 8, 16 and 32 bits, then the
+ * reciprocal multiplications of divide.h. The string tests time memcpy(),
+ * memset() and strlen() (string.S) per size class, after checking their
+ * results; a copy between different alignments takes the byte loop.
+ *
+ * The same loop is run from flash then from RAM (RAMFUNC, as the context
+ * switch, the tick and the UART interrupt): the difference is the cost of
+ * the flash wait states, against the RAM taken by the code of .ramfunc.
+ *
+ * The delay tests measure the cost of the delayed task lists (sorted lists,
+ * or the timing wheel with configUSE_TIMING_WHEEL): n tasks of a higher
+ * priority wake up in turn, one per tick, and delay again. The benchmark task
+ * spins meanwhile and counts the cycles taken from it; the result is per
+ * tick, tick interrupt included ("delay_0" is the tick alone). The number of
+ * tasks grows while the heap has room for them.
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include "chip.h"
+#include "FreeRTOS.h"
+#include "task.h"
+#include "queue.h"
+#include "semphr.h"
+#include "timers.h"
+#include "msg.h"
+#include "divide.h"
+#include "bench.h"
+
+#define BENCH_STACK_SIZE configMINIMAL_STACK_SIZE
+#define BENCH_ALLOC_SIZE 32
+#define BENCH_TIMER_COUNT 250	/* max timer expiries, one per tick */
+#define BENCH_MSG_SIZES 3
+#define BENCH_MSG_MAX 64		/* largest message, bytes */
+#define BENCH_DIV_SIZES 3
+#define BENCH_STR_SIZES 4
+#define BENCH_STR_MAX 256		/* largest block, bytes */
+#define BENCH_LOOP_LEN 100		/* iterations of the flash/RAM loop */
+#define BENCH_DELAY_TICKS 200	/* ticks measured for each number of tasks */
+#define BENCH_DELAY_GAP 200		/* cycles: a longer loop was interrupted */
+
+static SemaphoreHandle_t benchSem;
+static volatile uint32_t benchIsrStamp;		/* cycles at the ISR entry */
+static volatile uint32_t benchTaskStamp;	/* cycles when the task woke up */
+static volatile uint32_t benchDiv = 7;		/* not constant, for the compiler */
+static volatile uint32_t benchDividend = 0xFFFFFFFF;
+static volatile uint32_t benchTimerCycles;	/* tick to timer callback */
+static volatile uint32_t benchTimerCalls;
+static uint32_t benchTimerTarget;
+/* numbers of delayed tasks measured */
+static const uint16_t benchDelaySizes[] = {0, 2, 5, 10, 20, 50, 100, 200};
+static portTickType benchDelayStart;		/* first wake up of the delay tasks */
+static portTickType benchDelayPeriod;
+static volatile uint32_t benchDelayTasks;	/* delay tasks running */
+static volatile uint8_t benchDelayStop;
+/* string routines called through pointers, so that the compiler neither
+ * inlines them nor takes them out of the loops */
+static void *(* volatile benchMemcpy)(void *, const void *, size_t) = memcpy;
+static void *(* volatile benchMemset)(void *, int, size_t) = memset;
+static size_t (* volatile benchStrlen)(const char *) = strlen;
+extern char _ramfunc[], _eramfunc[];	/* code copied to RAM (sections.ld) */
+
+/**
+ * @brief	Read a free running cycle counter, made of the tick count and of
+ * 			the SysTick down counter; callable from tasks and interrupts.
+ * @return	the cycles since the scheduler start (modulo 2^32).
+ */
+uint32_t benchCycles(void)
+{
+	portTickType tick;
+	uint32_t val, load = SysTick->LOAD;
+
+	do
+	{
+		tick = xTaskGetTickCountFromISR();
+		val = SysTick->VAL;
+	} while (tick != xTaskGetTickCountFromISR());
+
+	/* reloaded, but the tick interrupt is held off (in an ISR) */
+	if ((SCB->ICSR & SCB_ICSR_PENDSTSET_Msk) && val > load / 2)
+		tick++;
+	return tick * (load + 1) + load - val;
+}
+
+/**
+ * @brief	Print a result line.
+ * @param	name: test name.
+ * @param	count: number of operations.
+ * @param	cycles: total cycles.
+ */
+static void benchReport(const char *name, uint32_t count, uint32_t cycles)
+{
+	printf("%s,%lu,%lu\r\n", name, count, cycles / count);
+}
+
+/**
+ * @brief	Cooperative switching partner: yields back forever.
+ * @param	pvParameters: not used.
+ */
+static void benchYieldTask(void *pvParameters)
+{
+	(void) pvParameters;
+
+	for (;;)
+		taskYIELD();
+}
+
+/**
+ * @brief	Preemption partner: suspends itself each time it is resumed.
+ * @param	pvParameters: not used.
+ */
+static void benchSuspendTask(void *pvParameters)
+{
+	(void) pvParameters;
+
+	for (;;)
+		vTaskSuspend(NULL);
+}
+
+/**
+ * @brief	Interrupt partner: waits for the semaphore given by the ISR.
+ * @param	pvParameters: not used.
+ */
+static void benchIsrTask(void *pvParameters)
+{
+	(void) pvParameters;
+
+	for (;;)
+	{
+		xSemaphoreTake(benchSem, portMAX_DELAY);
+		benchTaskStamp = benchCycles();
+	}
+}
+
+/**
+ * @brief	Watchdog interrupt, pended by software during the interrupt test.
+ */
+void WDT_IRQHandler(void)
+{
+	portBASE_TYPE xHigherPriorityTaskWoken = pdFALSE;
+
+	benchIsrStamp = benchCycles();
+	xSemaphoreGiveFromISR(benchSem, &xHigherPriorityTaskWoken);
+	portEND_SWITCHING_ISR(xHigherPriorityTaskWoken);
+}
+
+/**
+ * @brief	Timer callback: add the cycles since the tick interrupt.
+ * @param	xTimer: not used.
+ */
+static void benchTimer(TimerHandle_t xTimer)
+{
+	(void) xTimer;
+
+	if (benchTimerCalls < benchTimerTarget)
+	{
+		benchTimerCycles += SysTick->LOAD - SysTick->VAL;
+		benchTimerCalls++;
+	}
+}
+
+/**
+ * @brief	Delay partner: wakes up every period, in turn with the others.
+ * @param	pvParameters: its phase, ticks.
+ */
+static void benchDelayTask(void *pvParameters)
+{
+	portTickType wake = benchDelayStart + (uint32_t) pvParameters;
+
+	benchDelayTasks++;
+	while (!benchDelayStop)
+		vTaskDelayUntil(&wake, benchDelayPeriod);
+	benchDelayTasks--;
+	vTaskDelete(NULL);
+}
+
+/**
+ * @brief	Measure the cycles taken per tick by n delayed tasks.
+ * @param	n: number of delayed tasks.
+ * @param	prio: their priority.
+ * @return	SUCCESS, or ERROR if the tasks couldn't be created.
+ */
+static int benchDelay(uint32_t n, unsigned portBASE_TYPE prio)
+{
+	uint32_t i, now, last, lost = 0;
+	portTickType tick;
+	char name[12];
+	int res = SUCCESS;
+
+	benchDelayStop = FALSE;
+	benchDelayPeriod = n;
+	benchDelayStart = xTaskGetTickCount() + 1;
+	for (i = 0; i < n && res == SUCCESS; i++)
+	{
+		if (xTaskCreate(benchDelayTask, "bench", configMINIMAL_STACK_SIZE,
+				(void *) i, prio, NULL) != pdPASS)
+			res = ERROR;
+	}
+	if (res == SUCCESS)
+	{
+		vTaskDelay(n + 1);		/* every task delayed once */
+		tick = xTaskGetTickCount();
+		last = benchCycles();
+		while (xTaskGetTickCount() - tick < BENCH_DELAY_TICKS)
+		{
+			now = benchCycles();
+			if (now - last > BENCH_DELAY_GAP)
+				lost += now - last;
+			last = now;
+		}
+		snprintf(name, sizeof(name), "delay_%lu", n);
+		benchReport(name, BENCH_DELAY_TICKS, lost);
+	}
+
+	/* the idle task frees the deleted tasks */
+	benchDelayStop = TRUE;
+	while (benchDelayTasks)
+		vTaskDelay(1);
+	vTaskDelay(1);
+	return res;
+}
+
+/**
+ * @brief	Run a timer every tick and report its latency.
+ * @param	name: test name.
+ * @param	timer: an auto-reload timer with a period of one tick.
+ * @param	count: number of expiries.
+ * @return	SUCCESS, or ERROR if the timer couldn't be created.
+ */
+static int benchTimerRun(const char *name, TimerHandle_t timer, uint32_t count)
+{
+	if (!timer)
+		return ERROR;
+	benchTimerCycles = benchTimerCalls = 0;
+	benchTimerTarget = count;
+	xTimerStart(timer, portMAX_DELAY);
+	while (benchTimerCalls < count)
+		vTaskDelay(1);
+	xTimerDelete(timer, portMAX_DELAY);
+	benchReport(name, count, benchTimerCycles);
+	return SUCCESS;
+}
+
+/**
+ * @brief	Send and receive messages of several sizes, copied by the queue
+ * 			then by reference.
+ * @param	count: number of messages of each size.
+ * @return	SUCCESS, or ERROR if the queues or the buffer couldn't be
+ * 			allocated.
+ */
+static int benchMessages(uint32_t count)
+{
+	static const uint16_t sizes[BENCH_MSG_SIZES] = { 8, 32, BENCH_MSG_MAX };
+	static const char * const copyNames[BENCH_MSG_SIZES] =
+	{ "msg_copy_8", "msg_copy_32", "msg_copy_64" };
+	static const char * const refNames[BENCH_MSG_SIZES] =
+	{ "msg_ref_8", "msg_ref_32", "msg_ref_64" };
+	uint32_t i, start, total, *buff;
+	QueueHandle_t queue;
+	msg_pool_t pool;
+	void *msg;
+	int n;
+
+	/* the copy buffer, then the pool storage */
+	if (!(buff = pvPortMalloc(MSG_POOL_WORDS(BENCH_MSG_MAX, 1) * 4)))
+		return ERROR;
+	for (n = 0; n < BENCH_MSG_SIZES; n++)
+	{
+		if (!(queue = xQueueCreate(1, sizes[n])))
+		{
+			vPortFree(buff);
+			return ERROR;
+		}
+		start = benchCycles();
+		for (i = 0; i < count; i++)
+		{
+			xQueueSend(queue, buff, 0);
+			xQueueReceive(queue, buff, 0);
+		}
+		total = benchCycles() - start;
+		vQueueDelete(queue);
+		benchReport(copyNames[n], count, total);
+
+		if (!(queue = msgQueueCreate(1)))
+		{
+			vPortFree(buff);
+			return ERROR;
+		}
+		msgPoolInit(&pool, buff, sizes[n], 1);
+		start = benchCycles();
+		for (i = 0; i < count; i++)
+		{
+			msgSend(queue, msgAlloc(&pool), 0);
+			if ((msg = msgReceive(queue, 0)))
+				msgFree(msg);
+		}
+		total = benchCycles() - start;
+		vQueueDelete(queue);
+		benchReport(refNames[n], count, total);
+	}
+	vPortFree(buff);
+	return SUCCESS;
+}
+
+/**
+ * @brief	Time the divisions: the run time for several quotient sizes, then
+ * 			a 32 bits division by a constant and by a prepared divisor.
+ * @param	count: number of divisions of each kind.
+ */
+static void benchDivide(uint32_t count)
+{
+	static const uint32_t dividends[BENCH_DIV_SIZES] = { 0xFF, 0xFFFF, 0xFFFFFFFF };
+	static const char * const names[BENCH_DIV_SIZES] =
+	{ "udiv_8", "udiv_16", "udiv_32" };
+	uint32_t i, start, total;
+	volatile uint32_t sink;
+	udiv_const_t dc;
+	int n;
+
+	for (n = 0; n < BENCH_DIV_SIZES; n++)
+	{
+		benchDividend = dividends[n];
+		start = benchCycles();
+		for (i = 0; i < count; i++)
+			sink = benchDividend / benchDiv;
+		total = benchCycles() - start;
+		benchReport(names[n], count, total);
+	}
+
+	start = benchCycles();
+	for (i = 0; i < count; i++)
+		sink = udivByConst(benchDividend, 7);
+	total = benchCycles() - start;
+	benchReport("udiv_const", count, total);
+
+	udivConstInit(&dc, benchDiv);
+	start = benchCycles();
+	for (i = 0; i < count; i++)
+		sink = udivConst(&dc, benchDividend);
+	total = benchCycles() - start;
+	benchReport("udiv_prepared", count, total);
+	(void) sink;
+}
+
+/**
+ * @brief	Check then time the string routines for several block sizes.
+ * @param	count: number of calls of each kind.
+ * @return	SUCCESS, or ERROR if the buffer couldn't be allocated or a
+ * 			routine gave a wrong result.
+ */
+static int benchStrings(uint32_t count)
+{
+	static const uint16_t sizes[BENCH_STR_SIZES] = { 4, 16, 64, BENCH_STR_MAX };
+	uint32_t i, start, total;
+	uint8_t *src, *dst;
+	char name[24];
+	int n, res = SUCCESS;
+
+	/* source and destination, one more word each for the misaligned copy */
+	if (!(src = pvPortMalloc(2 * (BENCH_STR_MAX + 4))))
+		return ERROR;
+	dst = src + BENCH_STR_MAX + 4;
+	for (n = 0; n < BENCH_STR_SIZES && res == SUCCESS; n++)
+	{
+		for (i = 0; i < BENCH_STR_MAX + 4; i++)
+			src[i] = i % 255 + 1;
+		src[sizes[n]] = 0;
+		benchMemset(dst, 0xA5, BENCH_STR_MAX + 4);
+		benchMemcpy(dst, src + 1, sizes[n]);
+		if (memcmp(dst, src + 1, sizes[n]) || dst[sizes[n]] != 0xA5)
+			res = ERROR;
+		benchMemset(dst, 0xA5, BENCH_STR_MAX + 4);
+		benchMemset(dst + 1, 0, sizes[n]);
+		if (dst[0] != 0xA5 || dst[sizes[n]] || dst[sizes[n] + 1] != 0xA5)
+			res = ERROR;
+		if (benchStrlen((const char *) src) != sizes[n])
+			res = ERROR;
+
+		start = benchCycles();
+		for (i = 0; i < count; i++)
+			benchMemcpy(dst, src, sizes[n]);
+		total = benchCycles() - start;
+		snprintf(name, sizeof(name), "memcpy_%u", sizes[n]);
+		benchReport(name, count, total);
+
+		start = benchCycles();
+		for (i = 0; i < count; i++)
+			benchMemcpy(dst, src + 1, sizes[n]);
+		total = benchCycles() - start;
+		snprintf(name, sizeof(name), "memcpy_%u_unaligned", sizes[n]);
+		benchReport(name, count, total);
+
+		start = benchCycles();
+		for (i = 0; i < count; i++)
+			benchMemset(dst, 0, sizes[n]);
+		total = benchCycles() - start;
+		snprintf(name, sizeof(name), "memset_%u", sizes[n]);
+		benchReport(name, count, total);
+
+		start = benchCycles();
+		for (i = 0; i < count; i++)
+			benchStrlen((const char *) src);
+		total = benchCycles() - start;
+		snprintf(name, sizeof(name), "strlen_%u", sizes[n]);
+		benchReport(name, count, total);
+	}
+	vPortFree(src);
+	return res;
+}
+
+/**
+ * @brief	Shifts, logic and a branch per iteration, run from flash.
+ * @param	n: number of iterations.
+ * @return	a value depending on every iteration.
+ */
+static __attribute__((noinline)) uint32_t benchLoopFlash(uint32_t n)
+{
+	uint32_t x = 0;
+
+	while (n--)
+		x = (x << 1) ^ (x >> 3) ^ n;
+	return x;
+}
+
+/**
+ * @brief	The same loop, run from RAM.
+ * @param	n: number of iterations.
+ * @return	a value depending on every iteration.
+ */
+static RAMFUNC __attribute__((noinline)) uint32_t benchLoopRam(uint32_t n)
+{
+	uint32_t x = 0;
+
+	while (n--)
+		x = (x << 1) ^ (x >> 3) ^ n;
+	return x;
+}
+
+/**
+ * @brief	Run all the benchmarks.
+ * @param	count: repetitions of each test.
+ * @return	SUCCESS, or ERROR if the helper objects couldn't be created.
+ */
+int benchRun(uint32_t count)
+{
+	unsigned portBASE_TYPE prio = uxTaskPriorityGet(NULL);
+	uint32_t i, start, total, entry, wakeup;
+	QueueHandle_t queue;
+	TaskHandle_t helper;
+	volatile uint32_t sink;
+	void *p;
+
+	printf("# name,count,cycles\r\n");
+	printf("# code in RAM %d bytes\r\n", (int) (_eramfunc - _ramfunc));
+
+	/* cooperative: two switches per iteration */
+	if (xTaskCreate(benchYieldTask, "bench", BENCH_STACK_SIZE, NULL, prio,
+			&helper) != pdPASS)
+		return ERROR;
+	start = benchCycles();
+	for (i = 0; i < count; i++)
+		taskYIELD();
+	total = benchCycles() - start;
+	vTaskDelete(helper);
+	benchReport("yield", count * 2, total);
+
+	/* preemptive: resume a higher priority task, which suspends itself */
+	if (xTaskCreate(benchSuspendTask, "bench", BENCH_STACK_SIZE, NULL, prio + 1,
+			&helper) != pdPASS)
+		return ERROR;
+	start = benchCycles();
+	for (i = 0; i < count; i++)
+		vTaskResume(helper);
+	total = benchCycles() - start;
+	vTaskDelete(helper);
+	benchReport("preempt", count, total);
+
+	/* message passing, without task switches */
+	if (!(queue = xQueueCreate(1, sizeof(uint32_t))))
+		return ERROR;
+	start = benchCycles();
+	for (i = 0; i < count; i++)
+	{
+		xQueueSend(queue, &i, 0);
+		xQueueReceive(queue, (void *) &sink, 0);
+	}
+	total = benchCycles() - start;
+	vQueueDelete(queue);
+	benchReport("queue", count, total);
+	if (benchMessages(count) == ERROR)
+		return ERROR;
+
+	/* synchronization */
+	if (!(benchSem = xSemaphoreCreateBinary()))
+		return ERROR;
+	start = benchCycles();
+	for (i = 0; i < count; i++)
+	{
+		xSemaphoreGive(benchSem);
+		xSemaphoreTake(benchSem, 0);
+	}
+	total = benchCycles() - start;
+	benchReport("semaphore", count, total);
+
+	/* memory allocation */
+	start = benchCycles();
+	for (i = 0; i < count; i++)
+	{
+		if ((p = pvPortMalloc(BENCH_ALLOC_SIZE)))
+			vPortFree(p);
+	}
+	total = benchCycles() - start;
+	benchReport("malloc", count, total);
+
+	/* interrupt processing: pend to ISR entry, and ISR to task */
+	if (xTaskCreate(benchIsrTask, "bench", BENCH_STACK_SIZE, NULL, prio + 1,
+			&helper) != pdPASS)
+	{
+		vSemaphoreDelete(benchSem);
+		return ERROR;
+	}
+	NVIC_ClearPendingIRQ(WDT_IRQn);
+	NVIC_EnableIRQ(WDT_IRQn);
+	entry = wakeup = 0;
+	for (i = 0; i < count; i++)
+	{
+		start = benchCycles();
+		NVIC_SetPendingIRQ(WDT_IRQn);	/* runs now, then the helper */
+		entry += benchIsrStamp - start;
+		wakeup += benchTaskStamp - benchIsrStamp;
+	}
+	NVIC_DisableIRQ(WDT_IRQn);
+	vTaskDelete(helper);
+	vSemaphoreDelete(benchSem);
+	benchReport("isr_entry", count, entry);
+	benchReport("isr_to_task", count, wakeup);
+
+	/* flash wait states: the same loop from flash and from RAM */
+	start = benchCycles();
+	for (i = 0; i < count; i++)
+		sink = benchLoopFlash(BENCH_LOOP_LEN);
+	total = benchCycles() - start;
+	benchReport("loop_flash", count, total);
+	start = benchCycles();
+	for (i = 0; i < count; i++)
+		sink = benchLoopRam(BENCH_LOOP_LEN);
+	total = benchCycles() - start;
+	benchReport("loop_ram", count, total);
+
+	benchDivide(count);
+	if (benchStrings(count) == ERROR)
+		return ERROR;
+
+	/* delayed tasks, as many as the heap allows */
+	for (i = 0; i < sizeof(benchDelaySizes) / sizeof(benchDelaySizes[0]); i++)
+	{
+		if (benchDelay(benchDelaySizes[i], prio + 1) == ERROR)
+			break;
+	}
+
+	/* software timers */
+	if (count > BENCH_TIMER_COUNT)
+		count = BENCH_TIMER_COUNT;
+	if (benchTimerRun("timer_daemon", xTimerCreate("bench", 1, pdTRUE, NULL,
+			benchTimer), count) == ERROR)
+		return ERROR;
+	return benchTimerRun("timer_tick", xTimerCreateTick("bench", 1, pdTRUE,
+			NULL, benchTimer), count);
+}
@@ -0,0 +1,111 @@
+/*
+ * boot.c
+ *
+ * Created on: 18 Oct 2026 (LNP)
+ *
+ * Copyright (c) 2026 Lixco Microsystems <lix@paulian.net>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+/*
+ * The boot phases are timed with TIMER32_1 counting system clock cycles,
+ * started first thing in the reset handler and handed over to the time base
+ * (clock.c) when the first task runs. The clock changes from the 12 MHz IRC
+ * to the PLL during the boot, so every mark also records the clock it was
+ * taken at. bootStart() and bootMark() run before .data and .bss are
+ * initialised: they may only use the record, which is in .noinit.
+ */
+
+#include "chip.h"
+#include "boot.h"
+#include "clock.h"
+
+static boot_record_t bootRecord __attribute__((section(".noinit")));
+
+/**
+ * @brief	Start the boot timer; called first thing in the reset handler.
+ */
+void bootStart(void)
+{
+	Chip_TIMER_Init(LPC_TIMER32_1);
+	Chip_TIMER_Reset(LPC_TIMER32_1);
+	Chip_TIMER_PrescaleSet(LPC_TIMER32_1, 0);
+	Chip_TIMER_Enable(LPC_TIMER32_1);
+
+	/* RAM content is random at power on, a warm reset keeps it */
+	if (bootRecord.magic == BOOT_MAGIC)
+		bootRecord.boots++;
+	else
+	{
+		bootRecord.magic = BOOT_MAGIC;
+		bootRecord.boots = 0;
+	}
+	bootRecord.valid = 0;
+	bootMark(BOOT_RESET);
+}
+
+/**
+ * @brief	Record the end of a boot phase.
+ * @param	phase: one of the BOOT_xxx phases.
+ */
+void bootMark(int phase)
+{
+	if (phase >= BOOT_PHASES || (bootRecord.valid & (1 << BOOT_FIRST_TASK)))
+		return;
+	bootRecord.marks[phase].cycles = Chip_TIMER_ReadCount(LPC_TIMER32_1);
+	bootRecord.marks[phase].mhz = Chip_Clock_GetSystemClockRate() / 1000000;
+	bootRecord.valid |= 1 << phase;
+}
+
+/**
+ * @brief	Record the start of the first task and start the time base with
+ * 			the timer; can be called from every task, only the first call
+ * 			counts.
+ */
+void bootDone(void)
+{
+	uint32_t prev = 0, mhz, us = 0;
+	int i;
+
+	if (bootRecord.valid & (1 << BOOT_FIRST_TASK))
+		return;
+	bootMark(BOOT_FIRST_TASK);
+
+	/* time since reset, each phase at the clock it ran at */
+	mhz = bootRecord.marks[BOOT_RESET].mhz;
+	for (i = 0; i < BOOT_PHASES; i++)
+	{
+		if (!(bootRecord.valid & (1 << i)))
+			continue;
+		us += (bootRecord.marks[i].cycles - prev) / mhz;
+		prev = bootRecord.marks[i].cycles;
+		mhz = bootRecord.marks[i].mhz;
+	}
+	clockStart(us);
+}
+
+/**
+ * @brief	Get the boot record.
+ * @return	a pointer to the record.
+ */
+const boot_record_t *bootGetRecord(void)
+{
+	return &bootRecord;
+}
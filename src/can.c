@@ -0,0 +1,408 @@
+/*
+ * can.c
+ *
+ * Created on: 18 Oct 2026 (LNP)
+ *
+ * Copyright (c) 2026 Lixco Microsystems <lix@paulian.net>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+/*
+ * This file implements a C_CAN driver on top of the LPC11Cxx ROM API. Each
+ * receive message object is a hardware acceptance filter delivering its
+ * frames to a queue; outgoing frames are kept sorted by identifier, so the
+ * highest priority frame is always the next one on the bus.
+ */
+
+#include <string.h>
+#include "olimex_p1114.h"
+#include "FreeRTOS.h"
+#include "task.h"
+#include "queue.h"
+#include "semphr.h"
+#include "can.h"
+
+#if BOARD_HAS_CAN
+
+/* C_CAN registers not covered by the ROM API */
+#define CAN_CNTL (*(volatile uint32_t *) (LPC_CAN0_BASE + 0x000))
+#define CAN_EC (*(volatile uint32_t *) (LPC_CAN0_BASE + 0x008))
+#define CAN_CNTL_INIT 0x01
+
+/* frame length on the bus without the stuff bits, data field excluded */
+#define CAN_STD_BITS 47
+#define CAN_EXT_BITS 67
+
+/* transmission, sorted by priority */
+static can_msg_t canTxQueue[CAN_TX_QUEUE_SIZE];
+static volatile int canTxCount;
+static volatile int canTxBusy;
+static uint32_t canTxBits;		/* length of the frame being sent */
+static SemaphoreHandle_t canTxFree;
+
+/* reception */
+static can_msg_t canRxPool[CAN_RX_BUFFERS];
+static volatile uint32_t canRxFree;	/* bitmap of the free buffers */
+static QueueHandle_t canRxQueue;
+static QueueHandle_t canFilters[CAN_MSGOBJ_NUM];
+static uint8_t canNextFilter = CAN_RX_FIRST;
+
+/* statistics */
+static can_stats_t canStats;
+static volatile uint32_t canBits;
+static uint32_t canLastBits;
+static portTickType canLastTick;
+static uint32_t canBitrate;
+
+static portBASE_TYPE canWoken;	/* a task was woken by the ROM callbacks */
+
+static void canRxCallback(uint8_t msg_obj_num);
+static void canTxCallback(uint8_t msg_obj_num);
+static void canErrorCallback(uint32_t error_info);
+
+static CCAN_CALLBACKS_T canCallbacks =
+{
+		canRxCallback, canTxCallback, canErrorCallback,
+		NULL, NULL, NULL, NULL, NULL
+};
+
+/**
+ * @brief	Compute the bit timing for a bitrate, with the sample point near
+ * 			87.5%.
+ * @param	clk: CAN controller clock.
+ * @param	bitrate: the bitrate.
+ * @param	btr: pointer to return the CAN_BTR register value.
+ * @return	SUCCESS if the bitrate can be set exactly, ERROR otherwise.
+ */
+static int canBitTiming(uint32_t clk, uint32_t bitrate, uint32_t *btr)
+{
+	uint32_t tq, brp, tseg2, sjw;
+
+	for (tq = 20; tq >= 8; tq--)	/* time quanta per bit */
+	{
+		if (clk % (bitrate * tq))
+			continue;
+		brp = clk / (bitrate * tq);
+		if (brp < 1 || brp > 64)
+			continue;
+		tseg2 = (tq + 4) / 8;
+		sjw = tseg2 < 4 ? tseg2 : 4;
+		*btr = (brp - 1) | ((sjw - 1) << 6) | ((tq - 2 - tseg2) << 8)
+				| ((tseg2 - 1) << 12);
+		return SUCCESS;
+	}
+	return ERROR;
+}
+
+/**
+ * @brief	Frame length on the bus, used for the bus load.
+ * @param	msg: the frame.
+ * @return	the length in bits.
+ */
+static uint32_t canFrameBits(const can_msg_t *msg)
+{
+	return ((msg->mode_id & CAN_MSGOBJ_EXT) ? CAN_EXT_BITS : CAN_STD_BITS)
+			+ ((msg->mode_id & CAN_MSGOBJ_RTR) ? 0 : 8 * msg->dlc);
+}
+
+/**
+ * @brief	Arbitration priority of a frame: the identifier bits in the order
+ * 			they go on the bus, a lower value wins.
+ * @param	mode_id: the frame identifier and flags.
+ * @return	the priority.
+ */
+static uint32_t canPriority(uint32_t mode_id)
+{
+	if (mode_id & CAN_MSGOBJ_EXT)	/* base id, IDE, extended id */
+		return ((mode_id & 0x1FFC0000) << 1) | 0x00040000
+				| (mode_id & 0x0003FFFF);
+	return (mode_id & 0x7FF) << 19;
+}
+
+/**
+ * @brief	Load the next queued frame in the transmit message object. Must
+ * 			be called with the interrupts disabled or from the CAN interrupt.
+ * @return	TRUE if a frame was taken from the queue.
+ */
+static int canTxNext(void)
+{
+	if (canTxCount == 0)
+	{
+		canTxBusy = FALSE;
+		return FALSE;
+	}
+	canTxBusy = TRUE;
+	canTxBits = canFrameBits(&canTxQueue[0]);
+	LPC_CCAN_API->can_transmit(&canTxQueue[0]);
+	canTxCount--;
+	memmove(&canTxQueue[0], &canTxQueue[1], canTxCount * sizeof(can_msg_t));
+	return TRUE;
+}
+
+/**
+ * @brief	ROM callback: a frame was received in a message object. The frame
+ * 			is read directly in a free buffer and its pointer is queued.
+ * @param	msg_obj_num: the message object.
+ */
+static void canRxCallback(uint8_t msg_obj_num)
+{
+	can_msg_t scratch, *msg = &scratch;
+	QueueHandle_t queue = canFilters[msg_obj_num];
+	int i;
+
+	if (queue && canRxFree)
+	{
+		for (i = 0; !(canRxFree & (1 << i)); i++)
+			;
+		canRxFree &= ~(1 << i);
+		msg = &canRxPool[i];
+	}
+	msg->msgobj = msg_obj_num;
+	LPC_CCAN_API->can_receive(msg);
+
+	canStats.rx_frames++;
+	canBits += canFrameBits(msg);
+	if (!queue)
+		return;						/* not one of our filters */
+
+	if (msg == &scratch || xQueueSendToBackFromISR(queue, &msg, &canWoken) != pdTRUE)
+	{
+		canStats.rx_lost++;
+		if (msg != &scratch)
+			canRxFree |= 1 << (msg - canRxPool);
+	}
+}
+
+/**
+ * @brief	ROM callback: a frame was sent.
+ * @param	msg_obj_num: the message object.
+ */
+static void canTxCallback(uint8_t msg_obj_num)
+{
+	if (msg_obj_num != CAN_TX_MSGOBJ)
+		return;
+
+	canStats.tx_frames++;
+	canBits += canTxBits;
+	if (canTxNext())
+		xSemaphoreGiveFromISR(canTxFree, &canWoken);
+}
+
+/**
+ * @brief	ROM callback: bus error or change of the error state. A bus off
+ * 			is recovered by restarting the controller, which then waits for
+ * 			128 x 11 recessive bits before joining the bus again.
+ * @param	error_info: the CAN_ERROR_xxx bits.
+ */
+static void canErrorCallback(uint32_t error_info)
+{
+	int i;
+
+	for (i = 0; i < CAN_ERR_TYPES; i++)
+	{
+		if (error_info & (CAN_ERROR_STUF << i))
+			canStats.errors[i]++;
+	}
+	canStats.status = error_info & (CAN_ERROR_PASS | CAN_ERROR_WARN | CAN_ERROR_BOFF);
+	if (error_info & CAN_ERROR_BOFF)
+	{
+		canStats.bus_off++;
+		CAN_CNTL &= ~CAN_CNTL_INIT;
+	}
+}
+
+/**
+ * @brief	Handle the CAN interrupt.
+ */
+void CAN_IRQHandler(void)
+{
+	canWoken = pdFALSE;
+	LPC_CCAN_API->isr();
+	portEND_SWITCHING_ISR(canWoken);
+}
+
+/**
+ * @brief	Initialize the CAN controller and the driver.
+ * @param	bitrate: the bus bitrate.
+ * @return	SUCCESS if the controller was initialized, ERROR if the bitrate
+ * 			cannot be set or out of memory.
+ */
+int canInit(uint32_t bitrate)
+{
+	uint32_t clkInit[2];			/* CANCLKDIV, CAN_BTR */
+	uint32_t clk = Chip_Clock_GetSystemClockRate();
+
+	/* the clock divider is only needed for the low bitrates */
+	for (clkInit[0] = 0; clkInit[0] < 16; clkInit[0]++)
+	{
+		if (clk % (clkInit[0] + 1) == 0 && canBitTiming(clk / (clkInit[0] + 1),
+				bitrate, &clkInit[1]) == SUCCESS)
+			break;
+	}
+	if (clkInit[0] == 16)
+		return ERROR;
+
+	canTxFree = xSemaphoreCreateCounting(CAN_TX_QUEUE_SIZE, CAN_TX_QUEUE_SIZE);
+	canRxQueue = xQueueCreate(CAN_RX_QUEUE_SIZE, sizeof(can_msg_t *));
+	if (!canTxFree || !canRxQueue)
+		return ERROR;
+	canRxFree = (1 << CAN_RX_BUFFERS) - 1;
+	canBitrate = bitrate;
+	canLastTick = xTaskGetTickCount();
+
+	Chip_Clock_EnablePeriphClock(SYSCTL_CLOCK_CAN);
+	Chip_SYSCTL_PeriphReset(RESET_CAN0);
+	LPC_CCAN_API->init_can(clkInit, TRUE);
+	LPC_CCAN_API->config_calb(&canCallbacks);
+	NVIC_EnableIRQ(CAN_IRQn);
+	return SUCCESS;
+}
+
+/**
+ * @brief	Add a receive filter: a frame is accepted if its identifier bits
+ * 			selected by the mask are equal to the filter ones.
+ * @param	mode_id: identifier and CAN_MSGOBJ_xxx flags.
+ * @param	mask: identifier bits to compare.
+ * @param	queue: queue of can_msg_t pointers receiving the frames, or NULL
+ * 			for the default queue read by canReceive().
+ * @return	the message object used for the filter, ERROR (0) if none left.
+ */
+int canAddFilter(uint32_t mode_id, uint32_t mask, QueueHandle_t queue)
+{
+	can_msg_t msg;
+
+	if (canNextFilter > CAN_RX_LAST)
+		return ERROR;
+
+	canFilters[canNextFilter] = queue ? queue : canRxQueue;
+	msg.msgobj = canNextFilter;
+	msg.mode_id = mode_id;
+	msg.mask = mask;
+	LPC_CCAN_API->config_rxmsgobj(&msg);
+	return canNextFilter++;
+}
+
+/**
+ * @brief	Queue a frame for transmission; the queued frames are sent in the
+ * 			order of their priority, frames with the same identifier in the
+ * 			order they were queued.
+ * @param	msg: the frame.
+ * @param	timeout: max time to wait for room in the queue.
+ * @return	SUCCESS if the frame was queued, ERROR on timeout.
+ */
+int canSend(const can_msg_t *msg, portTickType timeout)
+{
+	uint32_t prio = canPriority(msg->mode_id);
+	int i, freed = FALSE;
+
+	if (xSemaphoreTake(canTxFree, timeout) != pdTRUE)
+		return ERROR;
+
+	taskENTER_CRITICAL();
+	for (i = canTxCount; i > 0 && canPriority(canTxQueue[i - 1].mode_id) > prio; i--)
+		canTxQueue[i] = canTxQueue[i - 1];
+	canTxQueue[i] = *msg;
+	canTxQueue[i].msgobj = CAN_TX_MSGOBJ;
+	canTxCount++;
+	if (!canTxBusy)
+		freed = canTxNext();
+	taskEXIT_CRITICAL();
+
+	if (freed)
+		xSemaphoreGive(canTxFree);
+	return SUCCESS;
+}
+
+/**
+ * @brief	Get a frame from the default receive queue.
+ * @param	timeout: max time to wait for a frame.
+ * @return	the frame, to be released with canRelease(), or NULL on timeout.
+ */
+can_msg_t *canReceive(portTickType timeout)
+{
+	can_msg_t *msg;
+
+	if (xQueueReceive(canRxQueue, &msg, timeout) != pdTRUE)
+		return NULL;
+	return msg;
+}
+
+/**
+ * @brief	Give back a received frame buffer to the driver.
+ * @param	msg: the frame.
+ */
+void canRelease(can_msg_t *msg)
+{
+	taskENTER_CRITICAL();
+	canRxFree |= 1 << (msg - canRxPool);
+	taskEXIT_CRITICAL();
+}
+
+/**
+ * @brief	Get the driver statistics; the bus load is computed over the time
+ * 			elapsed since the previous call.
+ * @param	stats: pointer to return the statistics.
+ */
+void canGetStats(can_stats_t *stats)
+{
+	portTickType now = xTaskGetTickCount();
+	uint32_t bits, ec, window;
+
+	taskENTER_CRITICAL();
+	*stats = canStats;
+	bits = canBits;
+	taskEXIT_CRITICAL();
+
+	ec = CAN_EC;
+	stats->tec = ec & 0xFF;
+	stats->rec = (ec >> 8) & 0x7F;
+
+	/* bits the bus could carry in the window, in 0.1% units */
+	window = (uint64_t) canBitrate * (now - canLastTick) / (configTICK_RATE_HZ * 1000);
+	stats->load = window ? ((bits - canLastBits) / window) : 0;
+	if (stats->load > 1000)
+		stats->load = 1000;
+	canLastBits = bits;
+	canLastTick = now;
+}
+
+/**
+ * @brief	Start the ROM CANopen SDO server on the last two message objects.
+ * @param	cfg: the CANopen configuration (node id and object dictionary);
+ * 			the message objects and the interrupt mode are set here. It must
+ * 			stay valid while the node is running.
+ * @param	callbacks: the CANOPEN_xxx callbacks, the CAN ones are ignored.
+ */
+void canConfigCANopen(CCAN_CANOPENCFG_T *cfg, const CCAN_CALLBACKS_T *callbacks)
+{
+	canCallbacks.CANOPEN_sdo_read = callbacks->CANOPEN_sdo_read;
+	canCallbacks.CANOPEN_sdo_write = callbacks->CANOPEN_sdo_write;
+	canCallbacks.CANOPEN_sdo_seg_read = callbacks->CANOPEN_sdo_seg_read;
+	canCallbacks.CANOPEN_sdo_seg_write = callbacks->CANOPEN_sdo_seg_write;
+	canCallbacks.CANOPEN_sdo_req = callbacks->CANOPEN_sdo_req;
+	LPC_CCAN_API->config_calb(&canCallbacks);
+
+	cfg->msgobj_rx = CAN_SDO_RX_MSGOBJ;
+	cfg->msgobj_tx = CAN_SDO_TX_MSGOBJ;
+	cfg->isr_handled = TRUE;		/* SDO requests served in the interrupt */
+	LPC_CCAN_API->config_canopen(cfg);
+}
+
+#endif /* BOARD_HAS_CAN */
@@ -0,0 +1,557 @@
+/*
+ * canopen.c
+ *
+ * Created on: 18 Oct 2026 (LNP)
+ *
+ * Copyright (c) 2026 Lixco Microsystems <lix@paulian.net>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+/*
+ * This file implements a CANopen slave node. The object dictionary below is
+ * handed to the ROM SDO server, which reads and writes the expedited objects
+ * by itself; the segmented ones are streamed from/to the application buffers
+ * of the domains table. The node task handles the NMT commands, the heartbeat
+ * and one receive and one transmit PDO, cyclic on SYNC or on their event
+ * timer.
+ */
+
+#include <string.h>
+#include "olimex_p1114.h"
+#include "FreeRTOS.h"
+#include "task.h"
+#include "queue.h"
+#include "can.h"
+#include "canopen.h"
+
+#if BOARD_HAS_CAN
+
+/* COB-IDs */
+#define COB_NMT 0x000
+#define COB_SYNC 0x080
+#define COB_TPDO1 0x180
+#define COB_RPDO1 0x200
+#define COB_HEARTBEAT 0x700
+
+/* NMT commands */
+#define NMT_CMD_START 0x01
+#define NMT_CMD_STOP 0x02
+#define NMT_CMD_PRE_OPERATIONAL 0x80
+#define NMT_CMD_RESET_NODE 0x81
+#define NMT_CMD_RESET_COMM 0x82
+
+/* PDO transmission types */
+#define PDO_SYNC_MAX 240			/* 1..240: every n-th SYNC */
+#define PDO_EVENT 0xFE				/* 0xFE, 0xFF: on the event timer */
+
+#define CANOPEN_QUEUE_SIZE 4
+
+/* a PDO: communication and mapping parameters, then the resolved mapping */
+typedef struct
+{
+	uint32_t cobid;				/* sub 1 of 0x1400/0x1800 */
+	uint8_t type;				/* sub 2, transmission type */
+	uint16_t event;				/* sub 5, event timer (ms), TPDO only */
+	uint8_t count;				/* sub 0 of 0x1600/0x1A00 */
+	uint32_t map[CANOPEN_PDO_MAX_MAP];	/* index << 16 | sub << 8 | bits */
+	uint8_t *ptr[CANOPEN_PDO_MAX_MAP];
+	uint8_t len[CANOPEN_PDO_MAX_MAP];
+	uint8_t size;				/* PDO data length, 0 if the mapping is invalid */
+} canopen_pdo_t;
+
+volatile uint16_t g_canopenIn[CANOPEN_PDO_MAX_MAP];
+volatile uint16_t g_canopenOut[CANOPEN_PDO_MAX_MAP];
+
+static uint8_t nodeId;
+static volatile uint8_t nmtState = NMT_BOOTUP;
+static uint8_t errorRegister;
+static uint16_t heartbeatTime = 1000;
+static canopen_pdo_t rpdo, tpdo;
+static volatile int pdoDirty;		/* the PDO parameters were written */
+static QueueHandle_t canopenQueue;
+
+static const char deviceName[] = "LPC11Cxx CANopen node";
+static uint8_t domain[CANOPEN_DOMAIN_SIZE];
+static uint16_t domainLength;
+static uint16_t deviceNameLength = sizeof(deviceName) - 1;
+
+/* constant objects */
+static const CCAN_ODCONSTENTRY_T odConst[] =
+		/*	index, subindex, length, value */
+{
+		{ 0x1000, 0, 4, 0x00000000 },	/* device type: no profile */
+		{ 0x1018, 0, 1, 4 },			/* identity */
+		{ 0x1018, 1, 4, 0x00000000 },	/* vendor id */
+		{ 0x1018, 2, 4, 0x00001114 },	/* product code */
+		{ 0x1018, 3, 4, 0x00000001 },	/* revision */
+		{ 0x1018, 4, 4, 0x00000000 },	/* serial number */
+		{ 0x1400, 0, 1, 2 },
+		{ 0x1800, 0, 1, 5 },
+		{ 0x2000, 0, 1, CANOPEN_PDO_MAX_MAP },
+		{ 0x2001, 0, 1, CANOPEN_PDO_MAX_MAP },
+};
+
+/* variable objects */
+static const CCAN_ODENTRY_T odTable[] =
+		/*	index, subindex, type and length, value */
+{
+		{ 0x1001, 0, OD_EXP_RO | 1, &errorRegister },
+		{ 0x1008, 0, OD_SEG_RO, (uint8_t *) deviceName },
+		{ 0x1017, 0, OD_EXP_RW | 2, (uint8_t *) &heartbeatTime },
+
+		{ 0x1400, 1, OD_EXP_RO | 4, (uint8_t *) &rpdo.cobid },
+		{ 0x1400, 2, OD_EXP_RW | 1, &rpdo.type },
+		{ 0x1600, 0, OD_EXP_RW | 1, &rpdo.count },
+		{ 0x1600, 1, OD_EXP_RW | 4, (uint8_t *) &rpdo.map[0] },
+		{ 0x1600, 2, OD_EXP_RW | 4, (uint8_t *) &rpdo.map[1] },
+		{ 0x1600, 3, OD_EXP_RW | 4, (uint8_t *) &rpdo.map[2] },
+		{ 0x1600, 4, OD_EXP_RW | 4, (uint8_t *) &rpdo.map[3] },
+
+		{ 0x1800, 1, OD_EXP_RO | 4, (uint8_t *) &tpdo.cobid },
+		{ 0x1800, 2, OD_EXP_RW | 1, &tpdo.type },
+		{ 0x1800, 5, OD_EXP_RW | 2, (uint8_t *) &tpdo.event },
+		{ 0x1A00, 0, OD_EXP_RW | 1, &tpdo.count },
+		{ 0x1A00, 1, OD_EXP_RW | 4, (uint8_t *) &tpdo.map[0] },
+		{ 0x1A00, 2, OD_EXP_RW | 4, (uint8_t *) &tpdo.map[1] },
+		{ 0x1A00, 3, OD_EXP_RW | 4, (uint8_t *) &tpdo.map[2] },
+		{ 0x1A00, 4, OD_EXP_RW | 4, (uint8_t *) &tpdo.map[3] },
+
+		{ 0x2000, 1, OD_EXP_RW | 2, (uint8_t *) &g_canopenIn[0] },
+		{ 0x2000, 2, OD_EXP_RW | 2, (uint8_t *) &g_canopenIn[1] },
+		{ 0x2000, 3, OD_EXP_RW | 2, (uint8_t *) &g_canopenIn[2] },
+		{ 0x2000, 4, OD_EXP_RW | 2, (uint8_t *) &g_canopenIn[3] },
+		{ 0x2001, 1, OD_EXP_RO | 2, (uint8_t *) &g_canopenOut[0] },
+		{ 0x2001, 2, OD_EXP_RO | 2, (uint8_t *) &g_canopenOut[1] },
+		{ 0x2001, 3, OD_EXP_RO | 2, (uint8_t *) &g_canopenOut[2] },
+		{ 0x2001, 4, OD_EXP_RO | 2, (uint8_t *) &g_canopenOut[3] },
+
+		{ 0x2100, 0, OD_SEG_RW, domain },
+};
+
+/* segmented objects */
+static const canopen_domain_t domains[] =
+		/*	index, subindex, buffer, size, length */
+{
+		{ 0x1008, 0, (uint8_t *) deviceName, sizeof(deviceName) - 1, &deviceNameLength },
+		{ 0x2100, 0, domain, sizeof(domain), &domainLength },
+};
+
+static uint32_t sdoWrite(uint16_t index, uint8_t subindex, uint8_t *dat_ptr);
+static uint32_t sdoSegRead(uint16_t index, uint8_t subindex, uint8_t openclose,
+		uint8_t *length, uint8_t *data, uint8_t *last);
+static uint32_t sdoSegWrite(uint16_t index, uint8_t subindex, uint8_t openclose,
+		uint8_t length, uint8_t *data, uint8_t *fast_resp);
+
+static const CCAN_CALLBACKS_T sdoCallbacks =
+{
+		NULL, NULL, NULL,
+		NULL, sdoWrite, sdoSegRead, sdoSegWrite, NULL
+};
+
+static CCAN_CANOPENCFG_T canopenCfg;
+
+/**
+ * @brief	Find the object mapped by a PDO mapping entry.
+ * @param	map: the mapping entry, index << 16 | subindex << 8 | bits.
+ * @return	the object, NULL if it does not exist or cannot be mapped.
+ */
+static const CCAN_ODENTRY_T *findMapped(uint32_t map)
+{
+	const CCAN_ODENTRY_T *entry;
+
+	for (entry = odTable; entry < odTable + sizeof(odTable) / sizeof(odTable[0]); entry++)
+	{
+		if (entry->index == (map >> 16) && entry->subindex == ((map >> 8) & 0xFF)
+				&& (entry->entrytype_len & 0xF0) <= OD_EXP_RW
+				&& (entry->entrytype_len & 0x0F) * 8 == (map & 0xFF))
+			return entry;
+	}
+	return NULL;
+}
+
+/**
+ * @brief	Resolve the mapping of a PDO to pointers on the mapped objects.
+ * @param	pdo: the PDO; its size is 0 if the mapping is invalid.
+ */
+static void mapPdo(canopen_pdo_t *pdo)
+{
+	const CCAN_ODENTRY_T *entry;
+	int i, size = 0;
+
+	for (i = 0; i < pdo->count && i < CANOPEN_PDO_MAX_MAP; i++)
+	{
+		if (!(entry = findMapped(pdo->map[i])))
+			break;
+		pdo->ptr[i] = entry->val;
+		pdo->len[i] = entry->entrytype_len & 0x0F;
+		size += pdo->len[i];
+	}
+	pdo->size = (i == pdo->count && size <= 8) ? size : 0;
+}
+
+/**
+ * @brief	Find a segmented object.
+ * @param	index: object index.
+ * @param	subindex: object subindex.
+ * @return	the object, NULL if it does not exist.
+ */
+static const canopen_domain_t *findDomain(uint16_t index, uint8_t subindex)
+{
+	const canopen_domain_t *dom;
+
+	for (dom = domains; dom < domains + sizeof(domains) / sizeof(domains[0]); dom++)
+	{
+		if (dom->index == index && dom->subindex == subindex)
+			return dom;
+	}
+	return NULL;
+}
+
+/**
+ * @brief	ROM callback: expedited SDO write, called before the value is
+ * 			stored; checks the PDO parameters.
+ * @param	index: object index.
+ * @param	subindex: object subindex.
+ * @param	dat_ptr: the new value.
+ * @return	0 to accept the value, an SDO abort code otherwise.
+ */
+static uint32_t sdoWrite(uint16_t index, uint8_t subindex, uint8_t *dat_ptr)
+{
+	void *wake = NULL;
+	portBASE_TYPE woken = pdFALSE;
+	uint32_t map;
+
+	if ((index == 0x1600 || index == 0x1A00) && subindex == 0)
+	{
+		if (*dat_ptr > CANOPEN_PDO_MAX_MAP)
+			return SDO_ABORT_VALUE_RANGE;
+	}
+	else if (index == 0x1600 || index == 0x1A00)
+	{
+		map = dat_ptr[0] | (dat_ptr[1] << 8) | (dat_ptr[2] << 16)
+				| ((uint32_t) dat_ptr[3] << 24);
+		if (map && !findMapped(map))
+			return SDO_ABORT_PARAINCOMP;
+	}
+	if (index == 0x1017 || (index >= 0x1400 && index <= 0x1A00))
+	{
+		pdoDirty = TRUE;			/* the task reloads its parameters */
+		xQueueSendToBackFromISR(canopenQueue, &wake, &woken);
+		portEND_SWITCHING_ISR(woken);	/* run by the CAN interrupt */
+	}
+	return 0;
+}
+
+/**
+ * @brief	ROM callback: segmented SDO upload, the data is read directly
+ * 			from the domain buffer.
+ * @param	index: object index.
+ * @param	subindex: object subindex.
+ * @param	openclose: CAN_SDOSEG_OPEN, CAN_SDOSEG_SEGMENT or CAN_SDOSEG_CLOSE.
+ * @param	length: pointer to return the segment length.
+ * @param	data: buffer receiving the segment (7 bytes).
+ * @param	last: pointer to return TRUE on the last segment.
+ * @return	0 if successful, an SDO abort code otherwise.
+ */
+static uint32_t sdoSegRead(uint16_t index, uint8_t subindex, uint8_t openclose,
+		uint8_t *length, uint8_t *data, uint8_t *last)
+{
+	static const canopen_domain_t *dom;
+	static uint16_t offset;
+	int n;
+
+	if (openclose == CAN_SDOSEG_OPEN)
+	{
+		if (!(dom = findDomain(index, subindex)))
+			return SDO_ABORT_NOT_EXISTS;
+		offset = 0;
+	}
+	else if (openclose == CAN_SDOSEG_SEGMENT && dom)
+	{
+		n = *dom->length - offset;
+		if (n > 7)
+			n = 7;
+		memcpy(data, dom->buff + offset, n);
+		offset += n;
+		*length = n;
+		*last = (offset == *dom->length);
+	}
+	return 0;
+}
+
+/**
+ * @brief	ROM callback: segmented SDO download, the data is written directly
+ * 			in the domain buffer.
+ * @param	index: object index.
+ * @param	subindex: object subindex.
+ * @param	openclose: CAN_SDOSEG_OPEN, CAN_SDOSEG_SEGMENT or CAN_SDOSEG_CLOSE.
+ * @param	length: segment length.
+ * @param	data: the segment.
+ * @param	fast_resp: not used.
+ * @return	0 if successful, an SDO abort code otherwise.
+ */
+static uint32_t sdoSegWrite(uint16_t index, uint8_t subindex, uint8_t openclose,
+		uint8_t length, uint8_t *data, uint8_t *fast_resp)
+{
+	static const canopen_domain_t *dom;
+	static uint16_t offset;
+
+	(void) fast_resp;
+
+	if (openclose == CAN_SDOSEG_OPEN)
+	{
+		if (!(dom = findDomain(index, subindex)))
+			return SDO_ABORT_NOT_EXISTS;
+		offset = 0;
+	}
+	else if (openclose == CAN_SDOSEG_SEGMENT && dom)
+	{
+		if (offset + length > dom->size)
+			return SDO_ABORT_VALUE_RANGE;
+		memcpy(dom->buff + offset, data, length);
+		offset += length;
+	}
+	else if (openclose == CAN_SDOSEG_CLOSE && dom)
+		*dom->length = offset;		/* transfer complete */
+	return 0;
+}
+
+/**
+ * @brief	Send a frame with the node COB-ID.
+ * @param	cobid: the COB-ID.
+ * @param	data: frame data.
+ * @param	len: data length.
+ */
+static void canopenSend(uint32_t cobid, const uint8_t *data, int len)
+{
+	can_msg_t msg;
+
+	msg.mode_id = cobid | CAN_MSGOBJ_STD;
+	msg.dlc = len;
+	memcpy(msg.data, data, len);
+	canSend(&msg, MS10_DELAY);
+}
+
+/**
+ * @brief	Send the transmit PDO.
+ */
+static void sendPdo(void)
+{
+	uint8_t data[8];
+	int i, pos = 0;
+
+	if (!tpdo.size)
+		return;
+	for (i = 0; i < tpdo.count; i++)
+	{
+		memcpy(data + pos, tpdo.ptr[i], tpdo.len[i]);
+		pos += tpdo.len[i];
+	}
+	canopenSend(tpdo.cobid, data, pos);
+}
+
+/**
+ * @brief	Handle a received NMT, SYNC or PDO frame.
+ * @param	msg: the frame.
+ */
+static void canopenReceive(const can_msg_t *msg)
+{
+	static uint8_t syncCount;
+	uint32_t cobid = msg->mode_id & 0x7FF;
+	int i, pos = 0;
+
+	if (cobid == COB_NMT && msg->dlc >= 2
+			&& (msg->data[1] == 0 || msg->data[1] == nodeId))
+	{
+		switch (msg->data[0])
+		{
+		case NMT_CMD_START:
+			nmtState = NMT_OPERATIONAL;
+			break;
+
+		case NMT_CMD_STOP:
+			nmtState = NMT_STOPPED;
+			break;
+
+		case NMT_CMD_PRE_OPERATIONAL:
+			nmtState = NMT_PRE_OPERATIONAL;
+			break;
+
+		case NMT_CMD_RESET_NODE:
+			NVIC_SystemReset();
+			break;
+
+		case NMT_CMD_RESET_COMM:
+			nmtState = NMT_BOOTUP;	/* the task sends the boot-up message */
+			break;
+
+		default:
+			break;
+		}
+	}
+	else if (nmtState != NMT_OPERATIONAL)
+		return;						/* no PDOs out of the operational state */
+	else if (cobid == COB_SYNC)
+	{
+		if (tpdo.type >= 1 && tpdo.type <= PDO_SYNC_MAX && ++syncCount >= tpdo.type)
+		{
+			syncCount = 0;
+			sendPdo();
+		}
+	}
+	else if (cobid == rpdo.cobid && rpdo.size && msg->dlc >= rpdo.size)
+	{
+		for (i = 0; i < rpdo.count; i++)
+		{
+			memcpy(rpdo.ptr[i], msg->data + pos, rpdo.len[i]);
+			pos += rpdo.len[i];
+		}
+	}
+}
+
+/**
+ * @brief	Send the boot-up message, the heartbeat and the event driven
+ * 			PDO when due.
+ * @return	ticks until the next one is due, portMAX_DELAY if none.
+ */
+static portTickType canopenTimers(void)
+{
+	static portTickType nextHeartbeat, nextPdo;
+	portTickType now = xTaskGetTickCount(), wait = portMAX_DELAY;
+	uint8_t state;
+
+	if (nmtState == NMT_BOOTUP)
+	{
+		state = NMT_BOOTUP;
+		canopenSend(COB_HEARTBEAT + nodeId, &state, 1);
+		nmtState = NMT_PRE_OPERATIONAL;
+		pdoDirty = TRUE;
+	}
+	if (pdoDirty)				/* restart the timers with new parameters */
+	{
+		pdoDirty = FALSE;
+		mapPdo(&rpdo);
+		mapPdo(&tpdo);
+		nextHeartbeat = nextPdo = now;
+	}
+
+	if (heartbeatTime)
+	{
+		if ((int32_t) (now - nextHeartbeat) >= 0)
+		{
+			state = nmtState;
+			canopenSend(COB_HEARTBEAT + nodeId, &state, 1);
+			nextHeartbeat += heartbeatTime / portTICK_RATE_MS;
+			if ((int32_t) (now - nextHeartbeat) >= 0)
+				nextHeartbeat = now + heartbeatTime / portTICK_RATE_MS;
+		}
+		wait = nextHeartbeat - now;
+	}
+	if (nmtState == NMT_OPERATIONAL && tpdo.type >= PDO_EVENT && tpdo.event)
+	{
+		if ((int32_t) (now - nextPdo) >= 0)
+		{
+			sendPdo();
+			nextPdo += tpdo.event / portTICK_RATE_MS;
+			if ((int32_t) (now - nextPdo) >= 0)
+				nextPdo = now + tpdo.event / portTICK_RATE_MS;
+		}
+		if (nextPdo - now < wait)
+			wait = nextPdo - now;
+	}
+	return wait;
+}
+
+/**
+ * @brief	CANopen node task.
+ * @param	pvParameters: not used.
+ */
+static void canopenTask(void *pvParameters)
+{
+	can_msg_t *msg;
+
+	(void) pvParameters;
+
+	for (;;)
+	{
+		/* a NULL message only wakes the task up after a parameter change */
+		if (xQueueReceive(canopenQueue, &msg, canopenTimers()) == pdTRUE && msg)
+		{
+			canopenReceive(msg);
+			canRelease(msg);
+		}
+	}
+}
+
+/**
+ * @brief	Initialize the CANopen node; the CAN driver must be initialized.
+ * @param	id: the node id (1 to 127).
+ * @return	SUCCESS if the node was started, ERROR otherwise.
+ */
+int canopenInit(uint8_t id)
+{
+	int i;
+
+	nodeId = id;
+
+	/* default PDOs, mapping the application process data */
+	rpdo.cobid = COB_RPDO1 + nodeId;
+	rpdo.type = PDO_EVENT;
+	rpdo.count = CANOPEN_PDO_MAX_MAP;
+	tpdo.cobid = COB_TPDO1 + nodeId;
+	tpdo.type = PDO_EVENT;
+	tpdo.event = 100;
+	tpdo.count = CANOPEN_PDO_MAX_MAP;
+	for (i = 0; i < CANOPEN_PDO_MAX_MAP; i++)
+	{
+		rpdo.map[i] = 0x20000010 | ((i + 1) << 8);	/* 0x2000/i+1, 16 bits */
+		tpdo.map[i] = 0x20010010 | ((i + 1) << 8);
+	}
+
+	if (!(canopenQueue = xQueueCreate(CANOPEN_QUEUE_SIZE, sizeof(can_msg_t *))))
+		return ERROR;
+	if (canAddFilter(COB_NMT | CAN_MSGOBJ_STD, 0x7FF, canopenQueue) == ERROR
+			|| canAddFilter(COB_SYNC | CAN_MSGOBJ_STD, 0x7FF, canopenQueue) == ERROR
+			|| canAddFilter(rpdo.cobid | CAN_MSGOBJ_STD, 0x7FF, canopenQueue) == ERROR)
+		return ERROR;
+
+	canopenCfg.node_id = nodeId;
+	canopenCfg.od_const_num = sizeof(odConst) / sizeof(odConst[0]);
+	canopenCfg.od_const_table = (CCAN_ODCONSTENTRY_T *) odConst;
+	canopenCfg.od_num = sizeof(odTable) / sizeof(odTable[0]);
+	canopenCfg.od_table = (CCAN_ODENTRY_T *) odTable;
+	canConfigCANopen(&canopenCfg, &sdoCallbacks);
+
+	xTaskCreate(canopenTask, "canopen",
+			configMINIMAL_STACK_SIZE * 2, NULL, (tskIDLE_PRIORITY + 3UL),
+			(xTaskHandle *) NULL);
+	return SUCCESS;
+}
+
+/**
+ * @brief	Get the NMT state of the node.
+ * @return	the state, NMT_xxx.
+ */
+uint8_t canopenGetState(void)
+{
+	return nmtState;
+}
+
+#endif /* BOARD_HAS_CAN */
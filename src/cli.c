@@ -39,7 +39,17 @@
 #include "task.h"
 #include "queue.h"
 #include "semphr.h"
+#include "olimex_p1114.h"
 #include "cli.h"
+#include "args.h"
+#include "frame.h"
+#include "can.h"
+#include "adc.h"
+#include "divide.h"
+#include "boot.h"
+#include "bench.h"
+#include "clock.h"
+#include "periodic.h"
 
 
 /* CLI task defines */
@@ -52,55 +62,151 @@
 #define CIN_CANCEL -2			/* user abort */
 #define CIN_UP_ARROW -3			/* up arrow */
 #define CIN_DOWN_ARROW -4		/* down arrow */
+#define CIN_FRAME -5			/* a binary frame was processed */
 
 #define CLI_HIST_PUT 1
 #define CLI_HIST_NEXT 2
 #define CLI_HIST_PREV 3
+#define CLI_HIST_RESET 4
 
 #define MAX_PARAMS 10			/* max number of parameters on the command line */
 
 #define CLI_BUFF 64
 #define STATS_BUFFER_SIZE 500
-#define NR_RECORDS 10
-
-/* local structures & co. */
-struct cliHistory
-{
-	char	data[CLI_BUFF];
-	unsigned int checksum;
-};
-
-/* CLI history storage area */
-struct cliHistory history[NR_RECORDS];
-extern volatile uint32_t uptime;
+#define CLI_HIST_SIZE 256		/* must be 256, the ring uses uint8_t indexes */
+#define DUMP_LINE (8 + 2 + 16 * 3 + 2 + 16 + 2)
+#define BAUD_CONFIRM_TIME 5		/* seconds to confirm a new baud rate */
+#define DUMP_DEFAULT_SIZE 0x100
+
+/* CLI history storage area: a ring of records, each one stored as its
+ * length, the command (without terminator) and its length again, so that the
+ * ring can be walked in both directions */
+static uint8_t history[CLI_HIST_SIZE];
+static uint8_t histHead;		/* where the next record will be stored */
+static int histUsed;			/* bytes used in the ring */
+static int histDepth;			/* distance from the current record start to
+								   histHead, 0 if not browsing the history */
+static int histPrefix;			/* length of the prefix being searched */
 uint8_t	g_echo;
 uint8_t g_errType;
 extern int free_heap;
+extern char _ramfunc[], _eramfunc[];	/* code copied to RAM (sections.ld) */
 
 /* function prototypes */
 static int cmdParser(char *prompt);
 static int cliHist(int cmd, char *record);
-static int help(int argc, char *argv[]);
-static int getver(int argc, char *argv[]);
-static int rtosStats(int argc, char *argv[]);
-static int myExit (int argc, char *argv[]);
-static int reboot(int argc, char *argv[]);
-static int set_echo(int argc, char *argv[]);
+static int help(int argc, char *argv[], arg_value_t *arg);
+int getver(int argc, char *argv[], arg_value_t *arg);
+static int rtosStats(int argc, char *argv[], arg_value_t *arg);
+static int myExit (int argc, char *argv[], arg_value_t *arg);
+static int reboot(int argc, char *argv[], arg_value_t *arg);
+static int set_echo(int argc, char *argv[], arg_value_t *arg);
 static int getStrg(char *buffer, char *prompt, int history);
-static int dump(int argc, char *argv[]);
+static int dump(int argc, char *argv[], arg_value_t *arg);
+static int baud(int argc, char *argv[], arg_value_t *arg);
+static int adc(int argc, char *argv[], arg_value_t *arg);
+static int bootTimes(int argc, char *argv[], arg_value_t *arg);
+static int bench(int argc, char *argv[], arg_value_t *arg);
+static int date(int argc, char *argv[], arg_value_t *arg);
+static int periodic(int argc, char *argv[], arg_value_t *arg);
+#if BOARD_HAS_CAN
+static int canStatus(int argc, char *argv[], arg_value_t *arg);
+#endif
+
+/* commands arguments specifications */
+static const char * const onOff[] = { "off", "on", NULL };
+
+static const arg_spec_t noArgs[] =
+{
+		{ NULL }
+};
+
+static const arg_spec_t echoArgs[] =
+		/*	name, type, optional, min, max, choices */
+{
+		{ "state", ARG_ENUM, TRUE, 0, 0, onOff },
+		{ NULL }
+};
+
+static const arg_spec_t dumpArgs[] =
+{
+		{ "-b", ARG_FLAG, TRUE, 0, 0, NULL },
+		{ "start", ARG_HEX, FALSE, 0, 0xFFFFFFFF, NULL },
+		{ "size", ARG_HEX, TRUE, 1, 0x10000, NULL },
+		{ NULL }
+};
+
+static const arg_spec_t baudArgs[] =
+{
+		{ "rate", ARG_DEC, TRUE, 1200, 3000000, NULL },
+		{ NULL }
+};
+
+static const char * const adcActions[] = { "start", "stop", "timed", NULL };
+
+static const arg_spec_t adcArgs[] =
+{
+		{ "action", ARG_ENUM, TRUE, 0, 0, adcActions },
+		{ "channels", ARG_HEX, TRUE, 0x01, 0xFF, NULL },
+		{ "rate", ARG_DEC, TRUE, 1, ADC_MAX_RATE, NULL },
+		{ NULL }
+};
+
+static const arg_spec_t benchArgs[] =
+{
+		{ "count", ARG_DEC, TRUE, 1, BENCH_MAX_COUNT, NULL },
+		{ NULL }
+};
+
+static const arg_spec_t dateArgs[] =
+{
+		{ "year", ARG_DEC, TRUE, CLOCK_MIN_YEAR, CLOCK_MAX_YEAR, NULL },
+		{ "month", ARG_DEC, TRUE, 1, 12, NULL },
+		{ "day", ARG_DEC, TRUE, 1, 31, NULL },
+		{ "hour", ARG_DEC, TRUE, 0, 23, NULL },
+		{ "min", ARG_DEC, TRUE, 0, 59, NULL },
+		{ "sec", ARG_DEC, TRUE, 0, 59, NULL },
+		{ NULL }
+};
+
+static const char * const periodicActions[] = { "reset", "load", NULL };
+
+static const arg_spec_t periodicArgs[] =
+{
+		{ "action", ARG_ENUM, TRUE, 0, 0, periodicActions },
+		{ "percent", ARG_DEC, TRUE, 0, 100, NULL },
+		{ NULL }
+};
+
+ARGS_SPEC_CHECK(echoArgs);
+ARGS_SPEC_CHECK(dumpArgs);
+ARGS_SPEC_CHECK(baudArgs);
+ARGS_SPEC_CHECK(adcArgs);
+ARGS_SPEC_CHECK(benchArgs);
+ARGS_SPEC_CHECK(dateArgs);
+ARGS_SPEC_CHECK(periodicArgs);
 
 /* CLI basic commands table */
 const cmds_t clicmds[] =
-		/*	CMD, function, help string */
+		/*	CMD, function, help string, arguments */
 {
-		{ "ver", getver, "Show version and other system parameters" },
-		{ "echo", set_echo, "Set/unset echo" },
-		{ "sys", rtosStats, "Show FreeRTOS statistics" },
-		{ "dump", dump, "Dump a memory zone" },
-		{ "exit", myExit, "Exit monitor" },
-		{ "reboot", reboot, "Reboot the system" },
-		{ "help", help, "Show this help panel; for individual command help, use <command> -h" },
-		{ NULL, NULL, 0 }
+		{ "ver", getver, "Show version and other system parameters", noArgs },
+		{ "echo", set_echo, "Set/unset echo", echoArgs },
+		{ "sys", rtosStats, "Show FreeRTOS statistics", noArgs },
+		{ "dump", dump, "Dump a memory zone", dumpArgs },
+		{ "baud", baud, "Show/change the serial baud rate", baudArgs },
+		{ "adc", adc, "Start (free running or timed)/stop the ADC acquisition, show its statistics", adcArgs },
+		{ "boot", bootTimes, "Show the boot phases timing", noArgs },
+		{ "bench", bench, "Run the kernel benchmarks, results in cycles per operation", benchArgs },
+		{ "date", date, "Show/set the date and time (UTC)", dateArgs },
+		{ "periodic", periodic, "Show/reset the periodic tasks timing statistics, start/change the load generator", periodicArgs },
+#if BOARD_HAS_CAN
+		{ "can", canStatus, "Show the CAN bus statistics", noArgs },
+#endif
+		{ "exit", myExit, "Exit monitor", noArgs },
+		{ "reboot", reboot, "Reboot the system", noArgs },
+		{ "help", help, "Show this help panel; for individual command help, use <command> -h", noArgs },
+		{ NULL, NULL, 0, NULL }
 };
 
 
@@ -108,11 +214,12 @@ const cmds_t clicmds[] =
  * @brief	Show the firmware and hardware version.
  * @param	argc: arguments count.
  * @param	argv: arguments list.
+ * @param	arg: parsed arguments.
  * @return	always SUCCESS.
  */
-int getver(int argc, char *argv[])
+int getver(int argc, char *argv[], arg_value_t *arg)
 {
-	(void) argc; (void) argv;
+	(void) argc; (void) argv; (void) arg;
 
 #ifdef DEBUG
 	printf("%s firmware, ver. %s (debug)\r\n", PLATFORMNAME, VERSION);
@@ -121,7 +228,8 @@ int getver(int argc, char *argv[])
 #endif
 	printf("Build on %s\r\n", DATE);
 	printf("Hardware %s rev. %s\r\n", HW_MODEL, HW_VERSION);
-	printf("Core clock %ld MHz\r\n", SystemCoreClock / 1000000);
+	printf("Core clock %ld MHz\r\n", udivByConst(SystemCoreClock, 1000000));
+	printf("Code in RAM %d bytes\r\n", (int) (_eramfunc - _ramfunc));
 	printf("%s\r\n", COPYRIGHT);
 	return SUCCESS;
 }
@@ -130,36 +238,32 @@ int getver(int argc, char *argv[])
  * @brief	System statistics.
  * @param	argc: arguments count.
  * @param	argv: arguments list.
+ * @param	arg: parsed arguments.
  * @return	always SUCCESS.
  */
-static int rtosStats(int argc, char *argv[])
+static int rtosStats(int argc, char *argv[], arg_value_t *arg)
 {
 	char *statsBuffer;
-	int	upt, mins;
+	uint32_t upt, hours, days;
 
-	if (argc == 0) /* no parameters, return current status values */
-	{
-		if ((statsBuffer = pvPortMalloc(STATS_BUFFER_SIZE)))
-		{
-			upt = uptime / 60;		/* don't need the seconds */
-			mins = upt % 60;
-			upt /= 60;
-			printf("up %d days, %d:%d\r\n", upt / 24, upt % 24, mins);
-			printf("Heap: %d bytes free\r\n\n", free_heap);
-			vTaskGetRunTimeStats(statsBuffer);
-			strcat(statsBuffer, "\n");
-			printf("%-16s%-16s%% Time\r\n", "Task", "Abs Time");
-			printf("%s", statsBuffer);
-			vTaskList(statsBuffer);
-			printf("Task\t\tState\tPrio.\tStack\tID\r\n");
-			printf("%s", statsBuffer);
-			vPortFree(statsBuffer);
-		}
-	}
-	else
+	(void) argc; (void) argv; (void) arg;
+
+	if ((statsBuffer = pvPortMalloc(STATS_BUFFER_SIZE)))
 	{
-		if (argc > 1 || !strcmp(argv[0], "-h"))
-			printf("Usage: sys\r\n");
+		upt = udivByConst(clockUptime(), 60);	/* don't need the seconds */
+		hours = udivByConst(upt, 60);
+		days = udivByConst(hours, 24);
+		printf("up %d days, %d:%d\r\n", (int) days, (int) (hours - days * 24),
+				(int) (upt - hours * 60));
+		printf("Heap: %d bytes free\r\n\n", free_heap);
+		vTaskGetRunTimeStats(statsBuffer);
+		strcat(statsBuffer, "\n");
+		printf("%-16s%-16s%% Time\r\n", "Task", "Abs Time");
+		printf("%s", statsBuffer);
+		vTaskList(statsBuffer);
+		printf("Task\t\tState\tPrio.\tStack\tID\r\n");
+		printf("%s", statsBuffer);
+		vPortFree(statsBuffer);
 	}
 	return SUCCESS;
 }
@@ -168,29 +272,17 @@ static int rtosStats(int argc, char *argv[])
  * @brief	Echo command: enable/disable echo.
  * @param	argc: arguments count.
  * @param	argv: arguments list.
- * @return	SUCCESS if parameters are OK, ERROR otherwise.
+ * @param	arg: parsed arguments.
+ * @return	always SUCCESS.
  */
-static int set_echo(int argc, char *argv[])
+static int set_echo(int argc, char *argv[], arg_value_t *arg)
 {
-	if (argc == 0)	/* no parameters, return current end of line character */
-		printf("Echo is %s\r\n", g_echo ? "on" : "off");
-	else
-	{ 				/* set/unset */
-		if (argc > 1 || !strcmp(argv[0], "-h"))
-			printf("Usage: echo {on|off}\r\n");
-		else
-		{
-			if (!strcmp(argv[0], "on"))
-				g_echo = TRUE;
-			else if (!strcmp(argv[0], "off"))
-				g_echo = FALSE;
-			else
-			{
-				g_errType = INVALID_PARAM;
-				return ERROR;
-			}
-		}
-	}
+	(void) argc; (void) argv;
+
+	if (!arg[0].present)	/* no parameters, return current echo state */
+		printf("Echo is %s\r\n", onOff[g_echo ? 1 : 0]);
+	else					/* set/unset */
+		g_echo = arg[0].num;
 	return SUCCESS;
 }
 
@@ -198,11 +290,12 @@ static int set_echo(int argc, char *argv[])
  * @brief	Exit command (quits the CLI).
  * @param	argc: arguments count.
  * @param	argv: arguments list.
+ * @param	arg: parsed arguments.
  * @return	ERROR and g_errType contains EXITCOMMAND error number.
  */
-static int myExit(int argc, char *argv[])
+static int myExit(int argc, char *argv[], arg_value_t *arg)
 {
-	(void) argc; (void) argv;
+	(void) argc; (void) argv; (void) arg;
 
 	printf("Exiting...\r\n");
 	vTaskDelay(10);				/* wait to finish the text */
@@ -215,17 +308,15 @@ static int myExit(int argc, char *argv[])
  * @brief	Reboot command.
  * @param	argc: arguments count.
  * @param	argv: arguments list.
+ * @param	arg: parsed arguments.
  * @return	if rebooted, will not return, SUCCESS otherwise.
  */
-static int reboot(int argc, char *argv[])
+static int reboot(int argc, char *argv[], arg_value_t *arg)
 {
 	int	c;
 
-	if (argc > 1 || ((argc == 1) && !strcmp(argv[0], "-h")))
-	{
-		printf("Usage: reboot\r\n");
-		return SUCCESS;
-	}
+	(void) argc; (void) argv; (void) arg;
+
 	printf("Are you sure? (y/n) ");
 	c = getchar();
 	printf("%c\r\n", c);
@@ -239,71 +330,390 @@ static int reboot(int argc, char *argv[])
 }
 
 /**
- * @brief	Memory dump command: dumps a zone of memory to the console.
+ * @brief	Convert a value to hexadecimal digits.
+ * @param	p: pointer where to store the digits.
+ * @param	value: the value to convert.
+ * @param	digits: minimum number of digits.
+ * @return	pointer after the last digit.
+ */
+static char *hexStr(char *p, uint32_t value, int digits)
+{
+	static const char hexDigits[] = "0123456789ABCDEF";
+	int shift;
+
+	while (digits < 8 && (value >> (4 * digits)))
+		digits++;
+	for (shift = 4 * (digits - 1); shift >= 0; shift -= 4)
+		*p++ = hexDigits[(value >> shift) & 0x0F];
+	return p;
+}
+
+/**
+ * @brief	Memory dump command: dumps a zone of memory to the console. With
+ * 			-b, the zone is sent in binary after a "BIN" line and followed by
+ * 			its CRC32 (4 bytes, little endian).
+ * @param	argc: arguments count.
+ * @param	argv: arguments list.
+ * @param	arg: parsed arguments: -b, start and size.
+ * @return	always SUCCESS.
+ */
+static int dump(int argc, char *argv[], arg_value_t *arg)
+{
+	int count, i, b_size;
+	unsigned char *start;
+	uint32_t crc;
+	char line[DUMP_LINE], *p;
+
+	(void) argc; (void) argv;
+
+	start = (unsigned char *) arg[1].num;
+	b_size = arg[2].present ? (int) arg[2].num : DUMP_DEFAULT_SIZE;
+
+	if (arg[0].present)		/* binary dump */
+	{
+		crc = crc32(0, start, b_size);
+		printf("BIN\r\n");
+		fwrite(start, 1, b_size, stdout);
+		for (i = 0; i < 4; i++)
+			putchar(crc >> (8 * i));
+		printf("\r\n");
+		return SUCCESS;
+	}
+
+	while (b_size > 0)
+	{
+		if ((b_size - 16) < 0)
+			count = b_size;
+		else
+			count = 16;
+
+		/* format the whole line, then send it at once */
+		p = hexStr(line, (unsigned int) start, 6);
+		*p++ = ' ';
+		*p++ = ' ';
+		for (i = 0; i < count; i++)	/* hex dump */
+		{
+			p = hexStr(p, start[i], 2);
+			*p++ = ' ';
+		}
+		*p++ = ' ';
+		*p++ = ' ';
+		for (i = 0; i < count; i++)	/* ascii dump */
+			*p++ = isprint(start[i]) ? start[i] : '.';
+		*p++ = '\r';
+		*p++ = '\n';
+		fwrite(line, 1, p - line, stdout);
+
+		start += count;
+		b_size -=  16;
+	}
+	return SUCCESS;
+}
+
+/**
+ * @brief	Baud rate command: show or change the serial line speed. After the
+ * 			switch, the host must send a CR or LF at the new rate within
+ * 			BAUD_CONFIRM_TIME seconds, otherwise the previous rate is restored.
  * @param	argc: arguments count.
  * @param	argv: arguments list.
+ * @param	arg: parsed arguments: rate.
  * @return	SUCCESS if the parameters are OK, ERROR otherwise.
  */
-static int dump(int argc, char *argv[])
+static int baud(int argc, char *argv[], arg_value_t *arg)
 {
-	int count, i, b_size;
-	unsigned char *start, *tmp;
-	unsigned char ch;
-	unsigned int address;
+	uint32_t rate, actual, previous;
+	int32_t ppm;
+	int c;
 
-	if (argc == 0 || !strcmp(argv[0], "-h"))
+	(void) argc; (void) argv;
+
+	if (!arg[0].present)	/* no parameters, return current baud rate */
 	{
-		printf("Usage: dump start [size]\r\n");
+		printf("Baud rate is %lu\r\n", UART_GetBaudRate());
 		return SUCCESS;
 	}
 
-	if (sscanf(argv[0], "%x", &address))
+	rate = arg[0].num;
+	if (!(actual = UART_CheckBaudRate(rate, &ppm)))
+	{
+		g_errType = INVALID_PARAM;
+		return ERROR;
+	}
+
+	printf("Switching to %lu baud (%ld ppm), confirm within %d s\r\n",
+			actual, ppm, BAUD_CONFIRM_TIME);
+	previous = UART_GetBaudRate();
+	UART_SetBaudRate(rate, NULL);
+
+	c = getCharSerial(BAUD_CONFIRM_TIME * ONE_SECOND_DELAY);
+	if (c != '\r' && c != '\n')
 	{
-		start = (unsigned char *) address;
+		UART_SetBaudRate(previous, NULL);
+		printf("No confirmation, baud rate restored to %lu\r\n", previous);
+		return SUCCESS;
+	}
+	printf("Baud rate is %lu\r\n", actual);
+	return SUCCESS;
+}
 
-		b_size = 0x100;	/* set a default if no second parameter */
-		if (argc == 2)
-			sscanf(argv[1], "%x", &b_size);
+/**
+ * @brief	ADC command: start the acquisition on a set of channels (hex bit
+ * 			mask) at a rate in conversions per second, start a timer triggered
+ * 			acquisition on the lowest channel of the mask, stop it, or show
+ * 			the acquisition statistics.
+ * @param	argc: arguments count.
+ * @param	argv: arguments list.
+ * @param	arg: parsed arguments: action, channels and rate.
+ * @return	SUCCESS if the parameters are OK, ERROR otherwise.
+ */
+static int adc(int argc, char *argv[], arg_value_t *arg)
+{
+	adc_stats_t stats;
+	uint32_t rate;
+	uint8_t ch;
 
-		while (b_size > 0)
+	(void) argc; (void) argv;
+
+	if (!arg[0].present)	/* no parameters, show the statistics */
+	{
+		adcGetStats(&stats);
+		printf("Samples %lu, overruns %lu, dropped %lu, level %d (peak %d)\r\n",
+				stats.samples, stats.overruns, stats.dropped, stats.level,
+				stats.peak);
+		if (stats.latency_max)
+			printf("Latency %lu..%lu ns, jitter %lu ns\r\n", stats.latency_min,
+					stats.latency_max, stats.latency_max - stats.latency_min);
+		return SUCCESS;
+	}
+	if (arg[0].num == 1)	/* stop */
+	{
+		adcStop();
+		return SUCCESS;
+	}
+	if (!arg[1].present || !arg[2].present)
+	{
+		g_errType = INVALID_PARAM;
+		return ERROR;
+	}
+	if (arg[0].num == 2)	/* timed, on the lowest channel of the mask */
+	{
+		for (ch = 0; !(arg[1].num & (1 << ch)); ch++)
+			;
+		if (!(rate = adcStartTimed(ch, arg[2].num)))
 		{
-			if ((b_size - 16) < 0)
-				count = b_size;
-			else
-				count = 16;
-			printf("%06X  ", (unsigned int) start);
+			g_errType = INVALID_PARAM;
+			return ERROR;
+		}
+		printf("Sampling channel %d at %lu Hz\r\n", ch, rate);
+	}
+	else if (adcStart(arg[1].num, arg[2].num) == ERROR)
+	{
+		g_errType = INVALID_PARAM;
+		return ERROR;
+	}
+	return SUCCESS;
+}
 
-			tmp = start;
-			for (i = 0; i < count; i++)	/* hex dump */
-				printf("%02X ", *start++);
+/**
+ * @brief	Boot command: show the duration of the boot phases, each one
+ * 			converted at the clock rate it ran at.
+ * @param	argc: arguments count.
+ * @param	argv: arguments list.
+ * @param	arg: parsed arguments.
+ * @return	always SUCCESS.
+ */
+static int bootTimes(int argc, char *argv[], arg_value_t *arg)
+{
+	static const char * const phases[BOOT_PHASES] =
+	{ "reset", "clocks", "data/bss", "board", "tasks", "first task" };
+	const boot_record_t *rec = bootGetRecord();
+	uint32_t prev = 0, mhz, us, total = 0;
+	int i;
+
+	(void) argc; (void) argv; (void) arg;
+
+	printf("Boot %lu since power on\r\n", rec->boots);
+	printf("%-12s%10s%10s\r\n", "Phase", "Time us", "End us");
+	mhz = rec->marks[BOOT_RESET].mhz;
+	for (i = 0; i < BOOT_PHASES; i++)
+	{
+		if (!(rec->valid & (1 << i)))
+			continue;
+		us = (rec->marks[i].cycles - prev) / mhz;	/* at the previous clock */
+		total += us;
+		printf("%-12s%10lu%10lu\r\n", phases[i], us, total);
+		prev = rec->marks[i].cycles;
+		mhz = rec->marks[i].mhz;
+	}
+	return SUCCESS;
+}
 
-			printf("  ");
-			for (i = 0; i < count; i++)	/* ascii dump */
-			{
-				ch = *tmp++;
-				if (isprint(ch))
-					putchar(ch);
-				else
-					putchar('.');
-			}
-			printf("\r\n");
-			b_size -=  16;
+/**
+ * @brief	Bench command: run the kernel benchmarks, each one count times.
+ * @param	argc: arguments count.
+ * @param	argv: arguments list.
+ * @param	arg: parsed arguments.
+ * @return	SUCCESS, or ERROR if the benchmarks couldn't allocate their tasks.
+ */
+static int bench(int argc, char *argv[], arg_value_t *arg)
+{
+	(void) argc; (void) argv;
+
+	if (benchRun(arg[0].present ? arg[0].num : BENCH_DEFAULT_COUNT) == ERROR)
+	{
+		g_errType = MALLOC_ERROR;
+		return ERROR;
+	}
+	return SUCCESS;
+}
+
+/**
+ * @brief	Date command: show the calendar time and the time since reset, or
+ * 			set the calendar time; the time of day defaults to 00:00:00.
+ * @param	argc: arguments count.
+ * @param	argv: arguments list.
+ * @param	arg: parsed arguments.
+ * @return	SUCCESS, or ERROR if the date is invalid.
+ */
+static int date(int argc, char *argv[], arg_value_t *arg)
+{
+	struct tm tm;
+	struct timespec ts;
+	uint32_t us;
+
+	(void) argc; (void) argv;
+
+	if (!arg[0].present)	/* no parameters, show the time */
+	{
+		clockGetDate(&tm, &us);
+		printf("%04d-%02d-%02d %02d:%02d:%02d.%06lu UTC\r\n", tm.tm_year + 1900,
+				tm.tm_mon + 1, tm.tm_mday, tm.tm_hour, tm.tm_min, tm.tm_sec, us);
+		clockGetTime(CLK_MONOTONIC, &ts);
+		printf("Up %lu.%06lu s\r\n", (uint32_t) ts.tv_sec,
+				udivByConst(ts.tv_nsec, 1000));
+		return SUCCESS;
+	}
+	if (!arg[2].present)	/* the date is needed */
+	{
+		g_errType = INVALID_PARAM;
+		return ERROR;
+	}
+	tm.tm_year = arg[0].num - 1900;
+	tm.tm_mon = arg[1].num - 1;
+	tm.tm_mday = arg[2].num;
+	tm.tm_hour = arg[3].num;
+	tm.tm_min = arg[4].num;
+	tm.tm_sec = arg[5].num;
+	if (clockSetDate(&tm) == ERROR)
+	{
+		g_errType = INVALID_PARAM;
+		return ERROR;
+	}
+	return SUCCESS;
+}
+
+/**
+ * @brief	Periodic command: show the timing of the periodic tasks, in
+ * 			microseconds, and their processor utilisation against the rate
+ * 			monotonic bound n * (2^(1/n) - 1), or reset the statistics, or
+ * 			start the load generator or change its load.
+ * @param	argc: arguments count.
+ * @param	argv: arguments list.
+ * @param	arg: parsed arguments.
+ * @return	SUCCESS, or ERROR if the load generator couldn't start.
+ */
+static int periodic(int argc, char *argv[], arg_value_t *arg)
+{
+	/* the bound for 1 to 8 tasks, per mille; 693 (ln 2) for more */
+	static const uint16_t rmBound[] = { 1000, 828, 779, 756, 743, 734, 728, 724 };
+	periodic_stats_t st;
+	uint32_t util, total = 0, bound;
+	int i;
+
+	(void) argc; (void) argv;
+
+	if (arg[0].present && arg[0].num == 0)		/* reset */
+	{
+		periodicResetStats();
+		return SUCCESS;
+	}
+	if (arg[0].present)		/* load */
+	{
+		if (!arg[1].present)
+		{
+			g_errType = INVALID_PARAM;
+			return ERROR;
+		}
+		if (periodicLoad(arg[1].num) == ERROR)
+		{
+			g_errType = MALLOC_ERROR;
+			return ERROR;
 		}
 		return SUCCESS;
 	}
-	g_errType = INVALID_PARAM;
-	return ERROR;
+	printf("%-10s%8s%8s%9s%7s%8s%9s%9s%6s\r\n", "Task", "Period", "Dline",
+			"Releases", "Misses", "Jitter", "Exec max", "Exec avg", "U %");
+	for (i = 0; periodicGetStats(i, &st) == SUCCESS; i++)
+	{
+		util = st.exec_avg * 1000 / st.period;		/* per mille */
+		total += util;
+		printf("%-10s%8lu%8lu%9lu%7lu%8lu%9lu%9lu%4lu.%lu\r\n", st.name,
+				st.period, st.deadline, st.releases, st.misses, st.jitter,
+				st.exec_max, st.exec_avg, udivByConst(util, 10),
+				util - udivByConst(util, 10) * 10);
+	}
+	if (i)
+	{
+		bound = i <= 8 ? rmBound[i - 1] : 693;
+		printf("Utilisation %lu.%lu %%, rate monotonic bound %lu.%lu %%\r\n",
+				udivByConst(total, 10), total - udivByConst(total, 10) * 10,
+				udivByConst(bound, 10), bound - udivByConst(bound, 10) * 10);
+	}
+	return SUCCESS;
 }
 
+#if BOARD_HAS_CAN
+/**
+ * @brief	CAN command: show the CAN driver statistics; the bus load is the
+ * 			average since the previous call.
+ * @param	argc: arguments count.
+ * @param	argv: arguments list.
+ * @param	arg: parsed arguments.
+ * @return	always SUCCESS.
+ */
+static int canStatus(int argc, char *argv[], arg_value_t *arg)
+{
+	can_stats_t stats;
+
+	(void) argc; (void) argv; (void) arg;
+
+	canGetStats(&stats);
+	printf("Frames: rx %lu, tx %lu, lost %lu\r\n", stats.rx_frames,
+			stats.tx_frames, stats.rx_lost);
+	printf("Bus load %d.%d%%, TEC %d, REC %d, %s\r\n", stats.load / 10,
+			stats.load % 10, stats.tec, stats.rec,
+			(stats.status & CAN_ERROR_BOFF) ? "bus off" :
+			(stats.status & CAN_ERROR_PASS) ? "error passive" :
+			(stats.status & CAN_ERROR_WARN) ? "warning" : "error active");
+	printf("Errors: stuff %lu, form %lu, ack %lu, bit1 %lu, bit0 %lu, crc %lu, "
+			"bus off %lu\r\n", stats.errors[CAN_ERR_STUFF],
+			stats.errors[CAN_ERR_FORM], stats.errors[CAN_ERR_ACK],
+			stats.errors[CAN_ERR_BIT1], stats.errors[CAN_ERR_BIT0],
+			stats.errors[CAN_ERR_CRC], stats.bus_off);
+	return SUCCESS;
+}
+#endif
+
 /**
  * @brief	Command to print the help.
  * @param	argc: arguments count.
  * @param	argv: arguments list.
+ * @param	arg: parsed arguments.
  * @return	always SUCCESS.
  */
-static int help(int argc, char *argv[])
+static int help(int argc, char *argv[], arg_value_t *arg)
 {
-	(void) argc; (void) argv;
+	(void) argc; (void) argv; (void) arg;
 	const cmds_t *pcmd;
 
 	for (pcmd = clicmds; pcmd->name; pcmd++)
@@ -312,9 +722,46 @@ static int help(int argc, char *argv[])
 }
 
 /**
- * @brief	Manage the CLI history memory. The CLI history structures are
- * 			initialized at the first CLI_HIST_PUT command.
- * @param	cmd: comamnds, can be: CLI_HIST_PUT, CLI_HIST_NEXT, CLI_HIST_PREV.
+ * @brief	Compare the command stored in a history record with a string.
+ * @param	start: index of the record in the history ring.
+ * @param	str: the string.
+ * @param	len: number of characters to compare.
+ * @return	TRUE if the first len characters are identical.
+ */
+static int histMatch(uint8_t start, const char *str, int len)
+{
+	if (history[start] < len)
+		return FALSE;
+	while (len--)
+	{
+		if (history[++start] != (uint8_t) *str++)
+			return FALSE;
+	}
+	return TRUE;
+}
+
+/**
+ * @brief	Copy the command stored in a history record to a buffer.
+ * @param	start: index of the record in the history ring.
+ * @param	record: the buffer.
+ */
+static void histCopy(uint8_t start, char *record)
+{
+	int len = history[start];
+
+	while (len--)
+		*record++ = history[++start];
+	*record = '\0';
+}
+
+/**
+ * @brief	Manage the CLI history memory. Commands are stored with their
+ * 			actual length; a command already in the history is moved to the
+ * 			newest position and the oldest commands are dropped when the ring
+ * 			is full. While browsing, only the commands starting with the text
+ * 			typed before the first arrow key are returned.
+ * @param	cmd: comamnds, can be: CLI_HIST_PUT, CLI_HIST_NEXT, CLI_HIST_PREV,
+ * 			CLI_HIST_RESET.
  * @param	record: pointer on a buffer to receive from, or store to the history
  * 			a command.
  * @return	SUCCESS if a valid record is found i.e. a record was successfully
@@ -322,53 +769,78 @@ static int help(int argc, char *argv[])
  */
 static int cliHist(int cmd, char *record)
 {
-	static int counter = 0;	/* current read position on the array */
-	static int load = 0;	/* current save position on the array */
-	int i, saved;
-	char *cpBuffer;
-	uint16_t checksum;
+	uint8_t start;
+	int len, size, depth, i;
 
 	switch (cmd)
 	{
 	case CLI_HIST_PUT:
-		if (!strlen(record))
+		histDepth = 0;
+		if (!(len = strlen(record)))
 			break; 					/* empty buffer, don't store */
-									/* else, store buffer */
-		memcpy(history[load].data, record, CLI_BUFF);
-		for (i = 0, cpBuffer = history[load].data, checksum = 0;
-				i < CLI_BUFF; i++)
-			checksum += *cpBuffer++;
-		history[load].checksum = checksum;
-		if (++load >= NR_RECORDS)
-			load = 0;				/* overflow, reset counter */
-		counter = load;
-		break;
 
-	case CLI_HIST_PREV:
-	case CLI_HIST_NEXT:
-		saved = counter;			/* save counter */
-		if (cmd == CLI_HIST_NEXT)	/* go forwards to the newest command */
+		/* remove an identical older command */
+		for (depth = 0; depth < histUsed; depth += size)
 		{
-			if (++counter >= NR_RECORDS)
-				counter = 0;
+			size = history[(uint8_t) (histHead - depth - 1)] + 2;
+			start = histHead - depth - size;
+			if (size == len + 2 && histMatch(start, record, len))
+			{
+				for (i = 0; i < depth; i++, start++)
+					history[start] = history[(uint8_t) (start + size)];
+				histHead -= size;
+				histUsed -= size;
+				break;
+			}
 		}
-		else
+
+		/* make room, dropping the oldest commands */
+		while (histUsed + len + 2 > CLI_HIST_SIZE)
+			histUsed -= history[(uint8_t) (histHead - histUsed)] + 2;
+
+		history[histHead++] = len;
+		while (*record)
+			history[histHead++] = *record++;
+		history[histHead++] = len;
+		histUsed += len + 2;
+		break;
+
+	case CLI_HIST_PREV:				/* go backwards to the oldest command */
+		if (histDepth == 0)
+			histPrefix = strlen(record);
+		for (depth = histDepth; depth < histUsed; )
 		{
-			/* go backwards to the oldest command */
-			if (--counter < 0)
-				counter = NR_RECORDS - 1;
+			depth += history[(uint8_t) (histHead - depth - 1)] + 2;
+			start = histHead - depth;
+			if (histMatch(start, record, histPrefix))
+			{
+				histDepth = depth;
+				histCopy(start, record);
+				return SUCCESS;
+			}
 		}
-		if (!strlen(history[counter].data) || counter == load)
-		{							/* empty slot */
-			counter = saved;		/* restore retrieve counter */
-			break;
+		return ERROR;				/* no older command */
+
+	case CLI_HIST_NEXT:				/* go forwards to the newest command */
+		if (histDepth == 0)
+			return ERROR;
+		for (depth = histDepth; depth > 0; )
+		{
+			depth -= history[(uint8_t) (histHead - depth)] + 2;
+			start = histHead - depth;
+			if (depth > 0 && histMatch(start, record, histPrefix))
+			{
+				histDepth = depth;
+				histCopy(start, record);
+				return SUCCESS;
+			}
 		}
-		for (i = 0, cpBuffer = history[counter].data, checksum = 0;
-				i < CLI_BUFF; i++)
-			checksum += *cpBuffer++;
-		if (checksum != history[counter].checksum)
-			return ERROR; 			/* invalid record */
-		memcpy(record, history[counter].data, CLI_BUFF);
+		histDepth = 0;				/* back to the typed text */
+		record[histPrefix] = '\0';
+		break;
+
+	case CLI_HIST_RESET:
+		histDepth = 0;
 		break;
 
 	default:
@@ -390,6 +862,9 @@ static int getEcho(void)
 	{
 		switch (c = getchar())
 		{
+		case FRAME_DELIMITER:		/* never echoed */
+			break;
+
 		case ESC:
 			command = TRUE;
 			continue;
@@ -468,8 +943,10 @@ static int getStrg(char *buffer, char *prompt, int history)
 	i = 0;
 	p = buffer; 					/* save buffer start */
 	memset(buffer, 0, CLI_BUFF);	/* zero the buffer, just for good practice... */
+	if (history)
+		cliHist(CLI_HIST_RESET, NULL);
 
-	while ((c = getEcho()))
+	while ((c = getEcho()) != FRAME_DELIMITER)
 	{
 		if (c == EOF)				/* unlikely to happen, kept for extensibility */
 			return EOF;
@@ -486,17 +963,14 @@ static int getStrg(char *buffer, char *prompt, int history)
 		case CIN_DOWN_ARROW:
 			if (prompt != NULL)
 			{
-				printf("\r%c%s%s", ESC, "[K", prompt);
-				buffer = p;			/* restore buffer start */
+				*buffer = '\0';	/* the typed text is the search prefix */
 				if (cliHist(c == CIN_UP_ARROW ? CLI_HIST_PREV : CLI_HIST_NEXT,
-						buffer) == ERROR)
+						p) == SUCCESS)
 				{
-					i = 0;
-					break;
+					printf("\r%c%s%s%s", ESC, "[K", prompt, p);
+					i = strlen(p);
+					buffer = p + i;	/* continue after the recalled command */
 				}
-				i = strlen(buffer);
-				printf("%s", buffer);
-				buffer += i;
 			}
 			break;
 
@@ -505,7 +979,7 @@ static int getStrg(char *buffer, char *prompt, int history)
 			{
 				putchar(' ');
 				putchar(BS);
-				*buffer-- = '\0';
+				*--buffer = '\0';
 				i--;
 			}
 			else
@@ -524,6 +998,12 @@ static int getStrg(char *buffer, char *prompt, int history)
 			break;
 	}
 
+	if (c == FRAME_DELIMITER)		/* binary frame, the text line is dropped */
+	{
+		frameProcess();
+		return CIN_FRAME;
+	}
+
 	if (g_echo)
 	{
 		if (c == '\r') 				/* complete the newline sequence */
@@ -551,11 +1031,15 @@ static int cmdParser(char *prompt)
 	int i, result;
 	char *argv[MAX_PARAMS]; /* pointers on parameters */
 	int argc;				/* parameter counter */
+	arg_value_t arg[ARGS_MAX];	/* parsed parameters */
 
 	for (;;)
 	{
 		i = getStrg(buff, prompt, TRUE); /* get a string from user */
 
+		if (i == CIN_FRAME)	/* binary frame, already answered */
+			continue;
+
 		if (i >= CLI_BUFF) 	/* CLI buffer overflow? */
 		{
 			printf("\rERROR 2\r\n%s", prompt);
@@ -602,7 +1086,22 @@ static int cmdParser(char *prompt)
 						*pbuff++ = '\0';
 					}
 				}
-				result = (*pcmd->func)(argc, &argv[0]); /* execute command */
+				if (pcmd->args)	/* check the parameters against the specification */
+				{
+					result = argsParse(pcmd->args, argc, &argv[0], arg);
+					if (result == ARGS_HELP)
+					{
+						argsUsage(pcmd->name, pcmd->args);
+						result = SUCCESS;
+						break;
+					}
+					if (result == ERROR)
+					{
+						g_errType = INVALID_PARAM;
+						break;
+					}
+				}
+				result = (*pcmd->func)(argc, &argv[0], arg); /* execute command */
 				break;
 			}
 		}
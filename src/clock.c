@@ -0,0 +1,307 @@
+/*
+ * clock.c
+ *
+ * Created on: 18 Oct 2026 (LNP)
+ *
+ * Copyright (c) 2026 Lixco Microsystems <lix@paulian.net>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+/*
+ * TIMER32_1 counts microseconds, its overflows are counted by the match 0
+ * interrupt (at TC = 0) to make a 64 bits time base that never drifts from
+ * the crystal and doesn't depend on the tick or on any task. The timer is
+ * used first by the boot profiler, which hands it over when the first task
+ * runs (bootDone()); the count then starts at the time spent since reset.
+ *
+ * The real time clock is the monotonic time plus an offset, set with
+ * clockSetTime() or clockSetDate(); calendar dates are UTC. The seconds are
+ * kept unsigned on 32 bits, up to 2106, whatever the size of time_t: the
+ * calendar functions don't go through time_t, and with a 32 bits time_t only
+ * clockGetTime() and clockSetTime() stop at 2038.
+ */
+
+#include "chip.h"
+#include "FreeRTOS.h"
+#include "task.h"
+#include "divide.h"
+#include "clock.h"
+
+#define CLOCK_US_PER_S 1000000
+#define CLOCK_S_PER_DAY 86400
+
+static volatile uint32_t clockHigh;		/* timer overflows */
+static uint8_t clockRunning;
+static uint32_t clockEpochSec;			/* real time - monotonic time */
+static uint32_t clockEpochUs;			/* 0 to 999999 */
+
+/**
+ * @brief	Switch the timer to microseconds and start the time base.
+ * @param	us: time elapsed since reset.
+ */
+void clockStart(uint32_t us)
+{
+	Chip_TIMER_Disable(LPC_TIMER32_1);
+	Chip_TIMER_Init(LPC_TIMER32_1);
+	Chip_TIMER_Reset(LPC_TIMER32_1);
+	Chip_TIMER_PrescaleSet(LPC_TIMER32_1,
+			udivByConst(SystemCoreClock, CLOCK_US_PER_S) - 1);
+	LPC_TIMER32_1->TC = us;
+	Chip_TIMER_SetMatch(LPC_TIMER32_1, 0, 0);
+	Chip_TIMER_MatchEnableInt(LPC_TIMER32_1, 0);
+	Chip_TIMER_ClearMatch(LPC_TIMER32_1, 0);
+	clockHigh = 0;
+	clockRunning = TRUE;
+	NVIC_ClearPendingIRQ(TIMER_32_1_IRQn);
+	NVIC_EnableIRQ(TIMER_32_1_IRQn);
+	Chip_TIMER_Enable(LPC_TIMER32_1);
+}
+
+/**
+ * @brief	Get the monotonic time; can be called from interrupts.
+ * @return	microseconds since reset, 0 before the time base is started.
+ */
+uint64_t clockMicros(void)
+{
+	uint32_t mask, high, low;
+
+	if (!clockRunning)
+		return 0;
+
+	mask = portSET_INTERRUPT_MASK_FROM_ISR();
+	high = clockHigh;
+	low = Chip_TIMER_ReadCount(LPC_TIMER32_1);
+
+	/* the counter wrapped but the interrupt hasn't run yet; a big count was
+	 * read just before the wrap */
+	if (Chip_TIMER_MatchPending(LPC_TIMER32_1, 0) && low < 0x80000000)
+		high++;
+	portCLEAR_INTERRUPT_MASK_FROM_ISR(mask);
+	return ((uint64_t) high << 32) | low;
+}
+
+/**
+ * @brief	Split a microseconds count into seconds and microseconds, without
+ * 			a 64 bits division: 2^32 us = 4294 s + 967296 us, the high word
+ * 			shrinks 4000 times at each round.
+ * @param	t: microseconds.
+ * @param	us: where to return the microseconds (0 to 999999).
+ * @return	the seconds.
+ */
+static uint32_t clockSplit(uint64_t t, uint32_t *us)
+{
+	uint32_t high = t >> 32, low = t, sec = 0, rest;
+
+	while (high)
+	{
+		sec += high * 4294;
+		rest = high * 967296;
+		high = udivMulHi(high, 967296);
+		low += rest;
+		if (low < rest)
+			high++;
+	}
+	sec += udivByConst(low, CLOCK_US_PER_S);
+	*us = low - udivByConst(low, CLOCK_US_PER_S) * CLOCK_US_PER_S;
+	return sec;
+}
+
+/**
+ * @brief	Get the time elapsed since reset.
+ * @return	seconds.
+ */
+uint32_t clockUptime(void)
+{
+	uint32_t us;
+
+	return clockSplit(clockMicros(), &us);
+}
+
+/**
+ * @brief	Get the real time.
+ * @param	us: where to return the microseconds (0 to 999999).
+ * @return	the seconds since 1970-01-01 00:00 UTC.
+ */
+static uint32_t clockSeconds(uint32_t *us)
+{
+	uint32_t sec;
+
+	sec = clockSplit(clockMicros(), us) + clockEpochSec;
+	*us += clockEpochUs;
+	if (*us >= CLOCK_US_PER_S)
+	{
+		*us -= CLOCK_US_PER_S;
+		sec++;
+	}
+	return sec;
+}
+
+/**
+ * @brief	Set the real time.
+ * @param	sec: seconds since 1970-01-01 00:00 UTC.
+ * @param	usec: microseconds (0 to 999999).
+ */
+static void clockSetSeconds(uint32_t sec, uint32_t usec)
+{
+	uint32_t us, epochSec;
+
+	epochSec = sec - clockSplit(clockMicros(), &us);
+	if (usec < us)
+	{
+		usec += CLOCK_US_PER_S;
+		epochSec--;
+	}
+	usec -= us;
+
+	taskENTER_CRITICAL();
+	clockEpochSec = epochSec;
+	clockEpochUs = usec;
+	taskEXIT_CRITICAL();
+}
+
+/**
+ * @brief	Get the time of a clock, like clock_gettime().
+ * @param	clk: CLK_MONOTONIC or CLK_REALTIME.
+ * @param	ts: where to return the time.
+ * @return	SUCCESS or ERROR if the clock doesn't exist.
+ */
+int clockGetTime(int clk, struct timespec *ts)
+{
+	uint32_t sec, us;
+
+	if (clk != CLK_MONOTONIC && clk != CLK_REALTIME)
+		return ERROR;
+
+	if (clk == CLK_REALTIME)
+		sec = clockSeconds(&us);
+	else
+		sec = clockSplit(clockMicros(), &us);
+	ts->tv_sec = sec;
+	ts->tv_nsec = us * 1000;
+	return SUCCESS;
+}
+
+/**
+ * @brief	Set the real time clock.
+ * @param	ts: the current time, seconds since 1970-01-01 00:00 UTC.
+ * @return	SUCCESS or ERROR if the time is out of range.
+ */
+int clockSetTime(const struct timespec *ts)
+{
+	if (ts->tv_nsec < 0 || ts->tv_nsec >= 1000000000 || ts->tv_sec < 0
+			|| (uint64_t) ts->tv_sec > 0xFFFFFFFF)
+		return ERROR;
+
+	clockSetSeconds(ts->tv_sec, udivByConst(ts->tv_nsec, 1000));
+	return SUCCESS;
+}
+
+/**
+ * @brief	Days from 1970-01-01 to a date of the proleptic Gregorian calendar,
+ * 			with the years starting in March so that the leap day is last.
+ * @param	year: 1970 to 2105.
+ * @param	month: 1 to 12.
+ * @param	day: 1 to 31.
+ * @return	the number of days.
+ */
+static uint32_t clockDays(uint32_t year, uint32_t month, uint32_t day)
+{
+	uint32_t era, yoe, doy;
+
+	if (month <= 2)
+		year--;
+	era = udivByConst(year, 400);
+	yoe = year - era * 400;
+	doy = udivByConst(153 * (month > 2 ? month - 3 : month + 9) + 2, 5) + day - 1;
+	return era * 146097 + yoe * 365 + (yoe >> 2) - udivByConst(yoe, 100) + doy
+			- 719468;
+}
+
+/**
+ * @brief	Get the calendar date and time (UTC).
+ * @param	tm: where to return the date; tm_yday and tm_isdst are not set.
+ * @param	us: where to return the microseconds, or NULL.
+ * @return	always SUCCESS.
+ */
+int clockGetDate(struct tm *tm, uint32_t *us)
+{
+	uint32_t sec, usec, days, era, doe, yoe, doy, mp;
+
+	sec = clockSeconds(&usec);
+	days = udivByConst(sec, CLOCK_S_PER_DAY);
+	sec -= days * CLOCK_S_PER_DAY;
+	tm->tm_hour = udivByConst(sec, 3600);
+	sec -= tm->tm_hour * 3600;
+	tm->tm_min = udivByConst(sec, 60);
+	tm->tm_sec = sec - tm->tm_min * 60;
+	tm->tm_wday = (days + 4) - udivByConst(days + 4, 7) * 7;	/* a Thursday */
+
+	days += 719468;					/* from 0000-03-01 */
+	era = udivByConst(days, 146097);
+	doe = days - era * 146097;
+	yoe = udivByConst(doe - udivByConst(doe, 1460) + udivByConst(doe, 36524)
+			- udivByConst(doe, 146096), 365);
+	doy = doe - (yoe * 365 + (yoe >> 2) - udivByConst(yoe, 100));
+	mp = udivByConst(5 * doy + 2, 153);
+	tm->tm_mday = doy - udivByConst(153 * mp + 2, 5) + 1;
+	tm->tm_mon = mp < 10 ? mp + 2 : mp - 10;
+	tm->tm_year = yoe + era * 400 + (tm->tm_mon <= 1) - 1900;
+	tm->tm_yday = 0;
+	tm->tm_isdst = 0;
+	if (us)
+		*us = usec;
+	return SUCCESS;
+}
+
+/**
+ * @brief	Set the real time clock to a calendar date and time (UTC).
+ * @param	tm: the date; only the year, month, day, hour, minute and second
+ * 			are used.
+ * @return	SUCCESS or ERROR if the date is out of range.
+ */
+int clockSetDate(const struct tm *tm)
+{
+	static const uint8_t monthDays[12] =
+	{ 31, 29, 31, 30, 31, 30, 31, 31, 30, 31, 30, 31 };
+	uint32_t year = tm->tm_year + 1900;
+
+	if (year < CLOCK_MIN_YEAR || year > CLOCK_MAX_YEAR || tm->tm_mon < 0
+			|| tm->tm_mon > 11 || tm->tm_mday < 1
+			|| tm->tm_mday > monthDays[tm->tm_mon] || tm->tm_hour < 0
+			|| tm->tm_hour > 23 || tm->tm_min < 0 || tm->tm_min > 59
+			|| tm->tm_sec < 0 || tm->tm_sec > 59)
+		return ERROR;
+	if (tm->tm_mon == 1 && tm->tm_mday == 29 && ((year & 3) || year == 2100))
+		return ERROR;
+
+	clockSetSeconds(clockDays(year, tm->tm_mon + 1, tm->tm_mday)
+			* CLOCK_S_PER_DAY + (uint32_t) tm->tm_hour * 3600
+			+ (uint32_t) tm->tm_min * 60 + tm->tm_sec, 0);
+	return SUCCESS;
+}
+
+/**
+ * @brief	Time base interrupt: the timer wrapped.
+ */
+void TIMER32_1_IRQHandler(void)
+{
+	Chip_TIMER_ClearMatch(LPC_TIMER32_1, 0);
+	clockHigh++;
+}
@@ -48,6 +48,8 @@ extern "C" {
 
 /* Include sys_config.h to get the CHIP_11* device identifier */
 #include "sys_config.h"
+#include <string.h>
+#include "boot.h"
 
 //*****************************************************************************
 #if defined (__cplusplus)
@@ -554,19 +556,14 @@ void (* const g_pfnVectors[])(void) = {
 //*****************************************************************************
 __attribute__ ((section(".after_vectors")))
 void data_init(unsigned int romstart, unsigned int start, unsigned int len) {
-	unsigned int *pulDest = (unsigned int*) start;
-	unsigned int *pulSrc = (unsigned int*) romstart;
-	unsigned int loop;
-	for (loop = 0; loop < len; loop = loop + 4)
-		*pulDest++ = *pulSrc++;
+	// memcpy() and memset() (src/string.S) don't use any initialised data and
+	// move 16 bytes per ldm/stm pair
+	memcpy((void *) start, (const void *) romstart, len);
 }
 
 __attribute__ ((section(".after_vectors")))
 void bss_init(unsigned int start, unsigned int len) {
-	unsigned int *pulDest = (unsigned int*) start;
-	unsigned int loop;
-	for (loop = 0; loop < len; loop = loop + 4)
-		*pulDest++ = 0;
+	memset((void *) start, 0, len);
 }
 
 //*****************************************************************************
@@ -591,11 +588,23 @@ __attribute__ ((section(".after_vectors")))
 void
 ResetISR(void) {
 
+	unsigned int LoadAddr, ExeAddr, SectionLen;
+	unsigned int *SectionTableAddr;
+
+	// Time the boot phases (see boot.c)
+	bootStart();
+
+	//
+	// Set up the clocks first, so that the sections below are initialised
+	// at full speed; SystemInit() must not use any initialised data.
+	//
+	extern void SystemInit(void);
+	SystemInit();
+	bootMark(BOOT_CLOCKS);
+
     //
     // Copy the data sections from flash to SRAM.
     //
-	unsigned int LoadAddr, ExeAddr, SectionLen;
-	unsigned int *SectionTableAddr;
 
 	// Load base address of Global Section Table
 	SectionTableAddr = &__data_section_table;
@@ -614,9 +623,7 @@ ResetISR(void) {
 		SectionLen = *SectionTableAddr++;
 		bss_init(ExeAddr, SectionLen);
 	}
-
-	extern void SystemInit(void);
-	SystemInit();
+	bootMark(BOOT_DATA);
 
 #if defined (__cplusplus)
 	//
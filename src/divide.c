@@ -0,0 +1,110 @@
+/*
+ * divide.c
+ *
+ * Created on: 18 Oct 2026 (LNP)
+ *
+ * Copyright (c) 2026 Lixco Microsystems <lix@paulian.net>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+/*
+ * Signed division on top of the unsigned one in divide.S, and the set up of
+ * divisors for the reciprocal multiplication (T. Granlund, P. Montgomery,
+ * "Division by invariant integers using multiplication"):
+ *
+ *   l = ceil(log2(d)), m = floor(2^32 * (2^l - d) / d) + 1
+ *   t = (m * n) >> 32, q = (t + ((n - t) >> 1)) >> (l - 1)
+ *
+ * which is exact for every 32 bits n and d.
+ */
+
+#include "divide.h"
+
+uint64_t __aeabi_uidivmod(uint32_t n, uint32_t d);
+int64_t __aeabi_idivmod(int32_t n, int32_t d);
+int32_t __aeabi_idiv(int32_t n, int32_t d);
+
+/**
+ * @brief	Signed division: the quotient is rounded toward zero and the
+ * 			remainder has the sign of the dividend.
+ * @param	n: dividend.
+ * @param	d: divisor.
+ * @return	the quotient in the low word (r0), the remainder in the high one
+ * 			(r1), as required by the run time ABI.
+ */
+int64_t __aeabi_idivmod(int32_t n, int32_t d)
+{
+	uint64_t res;
+	uint32_t q, r;
+
+	res = __aeabi_uidivmod(n < 0 ? -(uint32_t) n : (uint32_t) n,
+			d < 0 ? -(uint32_t) d : (uint32_t) d);
+	q = (uint32_t) res;
+	r = (uint32_t) (res >> 32);
+	if ((n ^ d) < 0)
+		q = -q;
+	if (n < 0)
+		r = -r;
+	return (int64_t) (((uint64_t) r << 32) | q);
+}
+
+/**
+ * @brief	Signed division, quotient only.
+ * @param	n: dividend.
+ * @param	d: divisor.
+ * @return	n / d.
+ */
+int32_t __aeabi_idiv(int32_t n, int32_t d)
+{
+	return (int32_t) __aeabi_idivmod(n, d);
+}
+
+/**
+ * @brief	Prepare a divisor for udivConst(); the magic number is computed
+ * 			bit by bit, without any 64 bits division.
+ * @param	dc: the prepared divisor.
+ * @param	d: divisor, not 0.
+ */
+void udivConstInit(udiv_const_t *dc, uint32_t d)
+{
+	uint32_t r, m = 0, carry;
+	int l = 0, i;
+
+	while (l < 32 && (1ULL << l) < d)
+		l++;
+
+	/* m = 2^32 * (2^l - d) / d, long division of a 64 bits numerator whose
+	 * high word (2^l - d) is already smaller than d */
+	r = (uint32_t) ((1ULL << l) - d);
+	for (i = 0; i < 32; i++)
+	{
+		carry = r >> 31;
+		r <<= 1;
+		m <<= 1;
+		if (carry || r >= d)
+		{
+			r -= d;
+			m |= 1;
+		}
+	}
+	dc->magic = m + 1;
+	dc->shift1 = l < 1 ? l : 1;
+	dc->shift2 = l > 1 ? l - 1 : 0;
+}
@@ -0,0 +1,452 @@
+/*
+ * dsp.c
+ *
+ * Created on: 18 Oct 2026 (LNP)
+ *
+ * Copyright (c) 2026 Lixco Microsystems <lix@paulian.net>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+/*
+ * This file implements fixed point filters for the Cortex-M0, which has a
+ * 32x32->32 bits multiplier and no divider: the Q15 kernels multiply 16 bits
+ * operands and accumulate in 32 bits, the Q31 ones split the 32 bits data in
+ * two 16 bits halves, and every scaling is a shift (block lengths, averaging
+ * windows and decimation factors are powers of 2). All filters process
+ * blocks and can work in place (out == in).
+ */
+
+#include <string.h>
+#include "lpc_types.h"
+#include "adc.h"
+#include "dsp.h"
+
+/**
+ * @brief	Saturate a value to 16 bits.
+ * @param	x: value.
+ * @return	x clipped to the Q15 range.
+ */
+static inline q15_t dspSat16(int32_t x)
+{
+	if (x > INT16_MAX)
+		return INT16_MAX;
+	if (x < INT16_MIN)
+		return INT16_MIN;
+	return x;
+}
+
+/**
+ * @brief	Multiply Q31 data by a Q14 coefficient, with 32 bits products only.
+ * @param	x: Q31 value.
+ * @param	c: Q14 coefficient.
+ * @return	the product in Q29.
+ */
+static inline int32_t dspMulQ31Q14(q31_t x, q15_t c)
+{
+	return (x >> 16) * c + (((x & 0xFFFF) * c) >> 16);
+}
+
+/**
+ * @brief	Initialise a FIR filter.
+ * @param	fir: filter.
+ * @param	coeffs: coefficients.
+ * @param	state: buffer of 2 * taps samples.
+ * @param	taps: number of coefficients.
+ */
+void dspFirInit(dsp_fir_t *fir, const q15_t *coeffs, q15_t *state, uint16_t taps)
+{
+	fir->coeffs = coeffs;
+	fir->state = state;
+	fir->taps = taps;
+	fir->pos = 0;
+	memset(state, 0, 2 * taps * sizeof(q15_t));
+}
+
+/**
+ * @brief	Filter a block of samples. The delay line is stored twice, so
+ * 			that the last taps samples are always contiguous and the inner
+ * 			loop has no wrap around test.
+ * @param	fir: filter.
+ * @param	in: input samples.
+ * @param	out: output samples.
+ * @param	count: number of samples.
+ */
+void dspFirQ15(dsp_fir_t *fir, const q15_t *in, q15_t *out, int count)
+{
+	const q15_t *c, *x;
+	int taps = fir->taps, pos = fir->pos, k;
+	int32_t acc;
+
+	while (count--)
+	{
+		if (pos == 0)
+			pos = taps;
+		pos--;
+		fir->state[pos] = fir->state[pos + taps] = *in++;
+
+		/* x[0] is the newest sample */
+		c = fir->coeffs;
+		x = &fir->state[pos];
+		acc = 1 << 14;
+		for (k = taps >> 1; k; k--)
+		{
+			acc += *c++ * *x++;
+			acc += *c++ * *x++;
+		}
+		if (taps & 1)
+			acc += *c * *x;
+		*out++ = dspSat16(acc >> 15);
+	}
+	fir->pos = pos;
+}
+
+/**
+ * @brief	Initialise a Q15 biquad cascade.
+ * @param	bq: filter.
+ * @param	coeffs: 5 coefficients for each stage.
+ * @param	state: buffer of 4 * stages samples.
+ * @param	stages: number of stages.
+ */
+void dspBiquadInit(dsp_biquad_t *bq, const q15_t *coeffs, q15_t *state, uint8_t stages)
+{
+	bq->coeffs = coeffs;
+	bq->state = state;
+	bq->stages = stages;
+	memset(state, 0, 4 * stages * sizeof(q15_t));
+}
+
+/**
+ * @brief	Filter a block of samples, one stage at a time.
+ * @param	bq: filter.
+ * @param	in: input samples.
+ * @param	out: output samples.
+ * @param	count: number of samples.
+ */
+void dspBiquadQ15(dsp_biquad_t *bq, const q15_t *in, q15_t *out, int count)
+{
+	const q15_t *c = bq->coeffs;
+	q15_t *s = bq->state, x, x1, x2, y1, y2;
+	int stage, i;
+	int32_t acc;
+
+	for (stage = bq->stages; stage; stage--)
+	{
+		x1 = s[0];
+		x2 = s[1];
+		y1 = s[2];
+		y2 = s[3];
+		for (i = 0; i < count; i++)
+		{
+			x = in[i];
+
+			/* each product is below 2^30 in magnitude; the sum of the
+			 * feed forward and of the feedback terms can't overflow in a
+			 * stable filter with a bounded output */
+			acc = (1 << 13) + c[0] * x + c[1] * x1 + c[2] * x2;
+			acc -= c[3] * y1 + c[4] * y2;
+			x2 = x1;
+			x1 = x;
+			y2 = y1;
+			y1 = dspSat16(acc >> 14);
+			out[i] = y1;
+		}
+		s[0] = x1;
+		s[1] = x2;
+		s[2] = y1;
+		s[3] = y2;
+		in = out;			/* the next stages filter the output in place */
+		c += 5;
+		s += 4;
+	}
+}
+
+/**
+ * @brief	Initialise a Q31 biquad cascade.
+ * @param	bq: filter.
+ * @param	coeffs: 5 coefficients for each stage.
+ * @param	state: buffer of 4 * stages samples.
+ * @param	stages: number of stages.
+ */
+void dspBiquad32Init(dsp_biquad32_t *bq, const q15_t *coeffs, q31_t *state, uint8_t stages)
+{
+	bq->coeffs = coeffs;
+	bq->state = state;
+	bq->stages = stages;
+	memset(state, 0, 4 * stages * sizeof(q31_t));
+}
+
+/**
+ * @brief	Filter a block of Q31 samples, one stage at a time; the products
+ * 			are truncated to 29 fractional bits and accumulated in 64 bits.
+ * @param	bq: filter.
+ * @param	in: input samples.
+ * @param	out: output samples.
+ * @param	count: number of samples.
+ */
+void dspBiquadQ31(dsp_biquad32_t *bq, const q31_t *in, q31_t *out, int count)
+{
+	const q15_t *c = bq->coeffs;
+	q31_t *s = bq->state, x, x1, x2, y1, y2;
+	int stage, i;
+	int64_t acc;
+
+	for (stage = bq->stages; stage; stage--)
+	{
+		x1 = s[0];
+		x2 = s[1];
+		y1 = s[2];
+		y2 = s[3];
+		for (i = 0; i < count; i++)
+		{
+			x = in[i];
+			acc = (int64_t) dspMulQ31Q14(x, c[0]) + dspMulQ31Q14(x1, c[1])
+					+ dspMulQ31Q14(x2, c[2]) - dspMulQ31Q14(y1, c[3])
+					- dspMulQ31Q14(y2, c[4]);
+			x2 = x1;
+			x1 = x;
+			y2 = y1;
+			if (acc > (INT32_MAX >> 2))
+				y1 = INT32_MAX;
+			else if (acc < (INT32_MIN >> 2))
+				y1 = INT32_MIN;
+			else
+				y1 = (int32_t) acc * 4;	/* not << 2, undefined if negative */
+			out[i] = y1;
+		}
+		s[0] = x1;
+		s[1] = x2;
+		s[2] = y1;
+		s[3] = y2;
+		in = out;
+		c += 5;
+		s += 4;
+	}
+}
+
+/**
+ * @brief	Initialise a moving average.
+ * @param	avg: filter.
+ * @param	hist: buffer of 2^log2len samples.
+ * @param	log2len: window length, as a power of 2 (at most 15).
+ * @return	SUCCESS, or ERROR if the length is too big.
+ */
+int dspAvgInit(dsp_avg_t *avg, q15_t *hist, uint8_t log2len)
+{
+	if (log2len > 15)
+		return ERROR;
+	avg->hist = hist;
+	avg->sum = 0;
+	avg->mask = (1 << log2len) - 1;
+	avg->pos = 0;
+	avg->shift = log2len;
+	memset(hist, 0, (1 << log2len) * sizeof(q15_t));
+	return SUCCESS;
+}
+
+/**
+ * @brief	Filter a block of samples; the running sum makes the cost
+ * 			independent of the window length.
+ * @param	avg: filter.
+ * @param	in: input samples.
+ * @param	out: output samples.
+ * @param	count: number of samples.
+ */
+void dspAvgQ15(dsp_avg_t *avg, const q15_t *in, q15_t *out, int count)
+{
+	int32_t sum = avg->sum;
+	int pos = avg->pos;
+	q15_t x;
+
+	while (count--)
+	{
+		x = *in++;
+		sum += x - avg->hist[pos];
+		avg->hist[pos] = x;
+		pos = (pos + 1) & avg->mask;
+		*out++ = sum >> avg->shift;
+	}
+	avg->sum = sum;
+	avg->pos = pos;
+}
+
+/**
+ * @brief	Initialise a CIC decimator (differential delay 1).
+ * @param	cic: decimator.
+ * @param	order: number of integrator/comb pairs, 1 to DSP_CIC_MAX_ORDER.
+ * @param	log2r: decimation factor, as a power of 2.
+ * @return	SUCCESS, or ERROR if the gain (2^(order * log2r)) doesn't fit
+ * 			in the 16 spare bits of the integrators.
+ */
+int dspCicInit(dsp_cic_t *cic, uint8_t order, uint8_t log2r)
+{
+	if (order < 1 || order > DSP_CIC_MAX_ORDER || order * log2r > 16)
+		return ERROR;
+	memset(cic, 0, sizeof(dsp_cic_t));
+	cic->order = order;
+	cic->log2r = log2r;
+	return SUCCESS;
+}
+
+/**
+ * @brief	Decimate a block of samples. The integrators wrap around, which
+ * 			is harmless as long as the output fits in their width: the combs
+ * 			difference cancels the overflows.
+ * @param	cic: decimator.
+ * @param	in: input samples.
+ * @param	out: output samples, at most count / 2^log2r + 1.
+ * @param	count: number of input samples.
+ * @return	the number of output samples.
+ */
+int dspCicQ15(dsp_cic_t *cic, const q15_t *in, q15_t *out, int count)
+{
+	uint32_t mask = (1UL << cic->log2r) - 1;
+	int order = cic->order, n = 0, i;
+	int32_t acc, prev;
+
+	while (count--)
+	{
+		acc = *in++;
+		for (i = 0; i < order; i++)
+			acc = cic->integ[i] = (uint32_t) cic->integ[i] + (uint32_t) acc;
+		if ((++cic->phase & mask) == 0)
+		{
+			for (i = 0; i < order; i++)
+			{
+				prev = cic->comb[i];
+				cic->comb[i] = acc;
+				acc = (uint32_t) acc - (uint32_t) prev;
+			}
+			out[n++] = acc >> (order * cic->log2r);
+		}
+	}
+	return n;
+}
+
+/**
+ * @brief	Initialise a level detector.
+ * @param	level: detector.
+ * @param	shift: window length, as a power of 2 (1 to 16).
+ */
+void dspLevelInit(dsp_level_t *level, uint8_t shift)
+{
+	level->ms = 0;
+	level->peak = 0;
+	level->shift = shift;
+}
+
+/**
+ * @brief	Update a level detector with a block of samples.
+ * @param	level: detector.
+ * @param	in: input samples.
+ * @param	count: number of samples.
+ */
+void dspLevelQ15(dsp_level_t *level, const q15_t *in, int count)
+{
+	uint32_t ms = level->ms, sq;
+	int shift = level->shift;
+	q15_t peak = level->peak, x;
+
+	while (count--)
+	{
+		x = *in++;
+		if (x < 0)
+			x = (x == INT16_MIN) ? INT16_MAX : -x;
+		sq = x * x;		/* Q30 */
+		if (sq > ms)
+			ms += (sq - ms) >> shift;
+		else
+			ms -= (ms - sq) >> shift;
+		peak -= peak >> shift;
+		if (x > peak)
+			peak = x;
+	}
+	level->ms = ms;
+	level->peak = peak;
+}
+
+/**
+ * @brief	Get the RMS value measured by a level detector.
+ * @param	level: detector.
+ * @return	the RMS value.
+ */
+q15_t dspLevelRms(const dsp_level_t *level)
+{
+	return dspSqrt(level->ms);
+}
+
+/**
+ * @brief	Integer square root, bit by bit (no divisions).
+ * @param	x: value.
+ * @return	the square root of x, rounded down.
+ */
+uint16_t dspSqrt(uint32_t x)
+{
+	uint32_t root = 0, bit = 1UL << 30;
+
+	while (bit > x)
+		bit >>= 2;
+	while (bit)
+	{
+		if (x >= root + bit)
+		{
+			x -= root + bit;
+			root = (root >> 1) + bit;
+		}
+		else
+			root >>= 1;
+		bit >>= 2;
+	}
+	return root;
+}
+
+/**
+ * @brief	Convert 10 bits ADC samples to Q15, mid scale being 0.
+ * @param	in: ADC samples.
+ * @param	out: Q15 samples.
+ * @param	count: number of samples.
+ */
+void dspAdcToQ15(const uint16_t *in, q15_t *out, int count)
+{
+	while (count--)
+		*out++ = (q15_t) ((*in++ << 6) - 0x8000);
+}
+
+/**
+ * @brief	Take the available samples out of the ADC ring, converted to Q15,
+ * 			without an intermediate copy.
+ * @param	out: Q15 samples.
+ * @param	count: max number of samples.
+ * @return	the number of samples.
+ */
+int dspReadAdc(q15_t *out, int count)
+{
+	const uint16_t *data;
+	int done = 0, n;
+
+	while (done < count && (n = adcPeek(&data)) > 0)
+	{
+		if (n > count - done)
+			n = count - done;
+		dspAdcToQ15(data, out + done, n);
+		adcConsume(n);
+		done += n;
+	}
+	return done;
+}
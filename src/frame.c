@@ -0,0 +1,447 @@
+/*
+ * frame.c
+ *
+ * Created on: 18 Oct 2026 (LNP)
+ *
+ * Copyright (c) 2026 Lixco Microsystems <lix@paulian.net>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+/*
+ * This file implements a framed binary request/response protocol for machine
+ * clients. Frames share the serial line with the text CLI: the CLI hands over
+ * to frameProcess() whenever it receives a frame delimiter, which can't be
+ * typed on a terminal. See frame.h for the frame format.
+ */
+
+#include <string.h>
+#include <stdint.h>
+#include "FreeRTOS.h"
+#include "task.h"
+#include "olimex_p1114.h"
+#include "cli.h"
+#include "frame.h"
+
+#define FRAME_TIMEOUT MS100_DELAY	/* max time between two bytes of a frame */
+#define FRAME_BAUD_TIMEOUT (5 * ONE_SECOND_DELAY)
+
+/* memory regions accessible to the read and write commands */
+typedef struct
+{
+	uint32_t start;
+	uint32_t size;
+	uint8_t writable;
+} mem_region_t;
+
+static const mem_region_t memRegions[] =
+{
+		{ 0x00000000, 0x8000, FALSE },	/* flash */
+		{ 0x10000000, 0x2000, TRUE },	/* RAM */
+		{ 0x1FFF0000, 0x4000, FALSE },	/* boot ROM */
+		{ 0, 0, FALSE }
+};
+
+/* frame buffer, used to receive, decode, execute and answer a frame */
+static uint8_t frameBuff[FRAME_MAX_ENCODED];
+
+/* baud rate to switch to after the current response was sent */
+static uint32_t pendingBaud;
+
+frame_stats_t g_frameStats;
+
+/* function prototypes */
+static int framePing(uint8_t *data, int len);
+static int frameInfo(uint8_t *data, int len);
+static int frameBaud(uint8_t *data, int len);
+static int frameRead(uint8_t *data, int len);
+static int frameWrite(uint8_t *data, int len);
+
+/* frame commands table */
+static const frame_cmds_t framecmds[] =
+{
+		{ FRAME_CMD_PING, framePing },
+		{ FRAME_CMD_INFO, frameInfo },
+		{ FRAME_CMD_BAUD, frameBaud },
+		{ FRAME_CMD_READ, frameRead },
+		{ FRAME_CMD_WRITE, frameWrite },
+		{ 0, NULL }
+};
+
+/* CRC32 (IEEE 802.3) nibble table, a good trade-off between speed and flash */
+static const uint32_t crcTable[16] =
+{
+		0x00000000, 0x1DB71064, 0x3B6E20C8, 0x26D930AC,
+		0x76DC4190, 0x6B6B51F4, 0x4DB26158, 0x5005713C,
+		0xEDB88320, 0xF00F9344, 0xD6D6A3E8, 0xCB61B38C,
+		0x9B64C2B0, 0x86D3D2D4, 0xA00AE278, 0xBDBDF21C
+};
+
+/**
+ * @brief	Compute the CRC32 (IEEE 802.3) of a block of data.
+ * @param	crc: the CRC of the previous blocks, 0 for the first block.
+ * @param	data: pointer on the data.
+ * @param	len: length of the data.
+ * @return	the updated CRC.
+ */
+uint32_t crc32(uint32_t crc, const uint8_t *data, int len)
+{
+	crc = ~crc;
+	while (len--)
+	{
+		crc ^= *data++;
+		crc = (crc >> 4) ^ crcTable[crc & 0x0F];
+		crc = (crc >> 4) ^ crcTable[crc & 0x0F];
+	}
+	return ~crc;
+}
+
+/**
+ * @brief	Read a little endian 32-bit value.
+ * @param	p: pointer on the value.
+ * @return	the value.
+ */
+static uint32_t get32(const uint8_t *p)
+{
+	return p[0] | (p[1] << 8) | (p[2] << 16) | ((uint32_t) p[3] << 24);
+}
+
+/**
+ * @brief	Store a little endian 32-bit value.
+ * @param	p: pointer where to store the value.
+ * @param	value: the value.
+ */
+static void put32(uint8_t *p, uint32_t value)
+{
+	p[0] = value;
+	p[1] = value >> 8;
+	p[2] = value >> 16;
+	p[3] = value >> 24;
+}
+
+/**
+ * @brief	Receive an encoded frame (without delimiters) in the frame buffer;
+ * 			the opening delimiter was already received.
+ * @return	the length of the encoded frame, or -1 on timeout or overflow.
+ */
+static int frameReceive(void)
+{
+	int c, len = 0;
+
+	for (;;)
+	{
+		c = getCharSerial(FRAME_TIMEOUT);
+		if (c == EOF || c == UART_ERROR)
+			return -1;
+
+		if (c == FRAME_DELIMITER)
+		{
+			if (len == 0)
+				continue;		/* back to back delimiters, wait for data */
+			return len > (int) sizeof(frameBuff) ? -1 : len;
+		}
+		if (len < (int) sizeof(frameBuff))
+			frameBuff[len] = c;
+		len++;					/* on overflow, drop until the delimiter */
+	}
+}
+
+/**
+ * @brief	Decode a COBS encoded buffer in place.
+ * @param	buff: pointer on the encoded data.
+ * @param	len: length of the encoded data.
+ * @return	the length of the decoded data, or -1 if the encoding is invalid.
+ */
+static int cobsDecode(uint8_t *buff, int len)
+{
+	uint8_t *src = buff, *dst = buff, *end = buff + len;
+	int code, i;
+
+	while (src < end)
+	{
+		code = *src++;
+		if (code == 0 || src + code - 1 > end)
+			return -1;
+		for (i = 1; i < code; i++)
+			*dst++ = *src++;
+		if (code < 0xFF && src < end)
+			*dst++ = 0;			/* a block shorter than 254 ends with a zero */
+	}
+	return dst - buff;
+}
+
+/**
+ * @brief	Send a frame: the data is COBS encoded on the fly, block by block,
+ * 			so no second buffer is needed. sendCharSerial() only writes less
+ * 			than asked when the UART stopped draining its queue; the frame is
+ * 			then abandoned and counted, the host drops it on the CRC.
+ * @param	data: pointer on the raw frame.
+ * @param	len: length of the raw frame.
+ */
+static void frameSend(uint8_t *data, int len)
+{
+	uint8_t code, delimiter = FRAME_DELIMITER;
+	int i, ok;
+
+	ok = sendCharSerial(&delimiter, 1) == 1;
+	while (ok)
+	{
+		for (i = 0; i < len && i < 254 && data[i] != 0; i++)
+			;
+		code = i + 1;
+		ok = sendCharSerial(&code, 1) == 1 && sendCharSerial(data, i) == i;
+		if (i == len)
+			break;
+		if (i < 254)
+			i++;				/* skip the zero, it is implied by the code */
+		data += i;
+		len -= i;
+	}
+	if (!ok || sendCharSerial(&delimiter, 1) != 1)
+		g_frameStats.tx_errors++;
+}
+
+/**
+ * @brief	Ping command: the data is returned unchanged.
+ * @param	data: pointer on the command data, also receives the response.
+ * @param	len: length of the command data.
+ * @return	length of the response data.
+ */
+static int framePing(uint8_t *data, int len)
+{
+	(void) data;
+
+	return len;
+}
+
+/**
+ * @brief	Info command: return the protocol version, the maximum data length,
+ * 			the receive window, the baud rate, the frame statistics and the
+ * 			platform name.
+ * @param	data: pointer on the command data, also receives the response.
+ * @param	len: length of the command data.
+ * @return	length of the response data.
+ */
+static int frameInfo(uint8_t *data, int len)
+{
+	(void) len;
+
+	data[0] = FRAME_VERSION;
+	data[1] = FRAME_MAX_DATA;
+	data[2] = UART_RX_QUEUE_SIZE & 0xFF;
+	data[3] = UART_RX_QUEUE_SIZE >> 8;
+	put32(data + 4, UART_GetBaudRate());
+	put32(data + 8, g_frameStats.frames);
+	put32(data + 12, g_frameStats.crc_errors);
+	put32(data + 16, g_frameStats.format_errors);
+	put32(data + 20, g_frameStats.tx_errors);
+	strcpy((char *) data + 24, PLATFORMNAME " " VERSION);
+
+	return 24 + sizeof(PLATFORMNAME " " VERSION) - 1;
+}
+
+/**
+ * @brief	Baud rate command: the response (actual rate and error in ppm) is
+ * 			sent at the current rate, then the rate is changed. The host must
+ * 			send a valid frame at the new rate within FRAME_BAUD_TIMEOUT,
+ * 			otherwise the previous rate is restored.
+ * @param	data: pointer on the command data, also receives the response.
+ * @param	len: length of the command data.
+ * @return	length of the response data or a negative status.
+ */
+static int frameBaud(uint8_t *data, int len)
+{
+	uint32_t rate, actual;
+	int32_t ppm;
+
+	if (len != 4)
+		return -FRAME_ERR_LENGTH;
+
+	rate = get32(data);
+	if (!(actual = UART_CheckBaudRate(rate, &ppm)))
+		return -FRAME_ERR_PARAM;
+
+	pendingBaud = rate;
+	put32(data, actual);
+	put32(data + 4, ppm);
+	return 8;
+}
+
+/**
+ * @brief	Check if a memory range lies within one of the accessible regions.
+ * @param	address: start of the range.
+ * @param	size: size of the range.
+ * @param	write: TRUE if the range will be written.
+ * @return	TRUE if the range can be accessed, FALSE otherwise.
+ */
+static int memCheck(uint32_t address, uint32_t size, int write)
+{
+	const mem_region_t *region;
+
+	for (region = memRegions; region->size; region++)
+	{
+		if (address >= region->start && size <= region->size
+				&& address - region->start <= region->size - size)
+			return !write || region->writable;
+	}
+	return FALSE;
+}
+
+/**
+ * @brief	Read command: return a block of memory.
+ * @param	data: pointer on the command data, also receives the response.
+ * @param	len: length of the command data.
+ * @return	length of the response data or a negative status.
+ */
+static int frameRead(uint8_t *data, int len)
+{
+	uint32_t address;
+	int size;
+
+	if (len != 6)
+		return -FRAME_ERR_LENGTH;
+
+	address = get32(data);
+	size = data[4] | (data[5] << 8);
+	if (size > FRAME_MAX_DATA)
+		return -FRAME_ERR_LENGTH;
+	if (!memCheck(address, size, FALSE))
+		return -FRAME_ERR_ADDRESS;
+
+	memcpy(data, (void *) address, size);
+	return size;
+}
+
+/**
+ * @brief	Write command: store a block of data in RAM.
+ * @param	data: pointer on the command data, also receives the response.
+ * @param	len: length of the command data.
+ * @return	length of the response data or a negative status.
+ */
+static int frameWrite(uint8_t *data, int len)
+{
+	uint32_t address;
+
+	if (len < 4)
+		return -FRAME_ERR_LENGTH;
+
+	address = get32(data);
+	if (!memCheck(address, len - 4, TRUE))
+		return -FRAME_ERR_ADDRESS;
+
+	memcpy((void *) address, data + 4, len - 4);
+	return 0;
+}
+
+/**
+ * @brief	Receive, execute and answer one frame.
+ * @return	SUCCESS if a valid frame was received, ERROR otherwise.
+ */
+static int frameHandle(void)
+{
+	const frame_cmds_t *pcmd;
+	int len, result;
+
+	if ((len = frameReceive()) < 0 || (len = cobsDecode(frameBuff, len)) < 0
+			|| len < FRAME_HEADER + FRAME_CRC || len > FRAME_MAX_RAW)
+	{
+		g_frameStats.format_errors++;
+		return ERROR;
+	}
+
+	len -= FRAME_CRC;
+	if (crc32(0, frameBuff, len) != get32(frameBuff + len))
+	{
+		g_frameStats.crc_errors++;
+		return ERROR;			/* the header can't be trusted, don't answer */
+	}
+	g_frameStats.frames++;
+
+	/* lookup in the commands table */
+	result = -FRAME_ERR_CMD;
+	if (frameBuff[2] == FRAME_OK && !(frameBuff[1] & FRAME_RESPONSE))
+	{
+		for (pcmd = framecmds; pcmd->func; pcmd++)
+		{
+			if (frameBuff[1] == pcmd->cmd)
+			{
+				result = (*pcmd->func)(frameBuff + FRAME_HEADER, len - FRAME_HEADER);
+				break;
+			}
+		}
+	}
+
+	/* the response reuses the sequence number and the command */
+	frameBuff[1] |= FRAME_RESPONSE;
+	if (result < 0)
+	{
+		frameBuff[2] = -result;
+		result = 0;
+	}
+	else
+		frameBuff[2] = FRAME_OK;
+
+	len = FRAME_HEADER + result;
+	put32(frameBuff + len, crc32(0, frameBuff, len));
+	frameSend(frameBuff, len + FRAME_CRC);
+	return SUCCESS;
+}
+
+/**
+ * @brief	Wait for the opening delimiter of a frame.
+ * @param	timeout: maximum time to wait.
+ * @return	SUCCESS if a delimiter was received, ERROR on timeout.
+ */
+static int frameWaitStart(portTickType timeout)
+{
+	portTickType start = xTaskGetTickCount(), elapsed;
+
+	while ((elapsed = xTaskGetTickCount() - start) < timeout)
+	{
+		if (getCharSerial(timeout - elapsed) == FRAME_DELIMITER)
+			return SUCCESS;
+	}
+	return ERROR;
+}
+
+/**
+ * @brief	Frame protocol entry point, called by the CLI after receiving a
+ * 			frame delimiter.
+ * @return	SUCCESS if a valid frame was received, ERROR otherwise.
+ */
+int frameProcess(void)
+{
+	uint32_t previous;
+	int result;
+
+	result = frameHandle();
+
+	if (pendingBaud)
+	{
+		previous = UART_GetBaudRate();
+		UART_SetBaudRate(pendingBaud, NULL);
+		pendingBaud = 0;
+
+		/* the host confirms the new rate with a valid frame */
+		if (frameWaitStart(FRAME_BAUD_TIMEOUT) != SUCCESS
+				|| frameHandle() != SUCCESS)
+			UART_SetBaudRate(previous, NULL);
+	}
+	return result;
+}
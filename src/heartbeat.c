@@ -0,0 +1,191 @@
+/*
+ * heartbeat.c
+ *
+ * Created on: 18 Oct 2026 (LNP)
+ *
+ * Copyright (c) 2026 Lixco Microsystems <lix@paulian.net>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+/*
+ * The LEDs blink by patterns of up to 32 bits, each bit lasting HB_STEP_MS,
+ * with a common brightness. They are driven by the match interrupts of
+ * TIMER16_1: MR0 ends a step, or a PWM period when the LEDs are dimmed, MR1
+ * ends the on time of a PWM period. The LEDs of this board are GPIOs without
+ * a timer match function, so the interrupt sets them; it is short and calls
+ * no kernel function, so the heartbeat never wakes the scheduler.
+ *
+ * The LEDs without a pattern are not touched and stay under the control of
+ * the application (LED_Set(), etc.).
+ */
+
+#include "chip.h"
+#include "FreeRTOS.h"
+#include "task.h"
+#include "olimex_p1114.h"
+#include "heartbeat.h"
+
+#define HB_LEDS 8
+#define HB_TIMER_HZ 100000		/* timer count rate */
+
+static uint32_t hbPatterns[HB_LEDS];
+static uint8_t hbLength[HB_LEDS];	/* 0 if the LED has no pattern */
+static uint8_t hbPos[HB_LEDS];		/* current bit of each pattern */
+static uint8_t hbUsed;				/* LEDs with a pattern, bit mask */
+static uint8_t hbOn;				/* LEDs lit in the current step */
+static uint8_t hbDuty = 100;		/* brightness, percent */
+static uint16_t hbPeriods;			/* timer periods per step */
+static uint16_t hbCount;
+
+/**
+ * @brief	Program the timer for the current brightness: one period per step
+ * 			if fully on or off, PWM periods otherwise.
+ */
+static void hbConfigure(void)
+{
+	uint32_t period;
+
+	Chip_TIMER_Disable(LPC_TIMER16_1);
+	Chip_TIMER_Reset(LPC_TIMER16_1);
+	if (hbDuty == 0 || hbDuty >= 100)
+	{
+		period = HB_TIMER_HZ / 1000 * HB_STEP_MS;
+		hbPeriods = 1;
+		Chip_TIMER_MatchDisableInt(LPC_TIMER16_1, 1);
+	}
+	else
+	{
+		period = HB_TIMER_HZ / HB_PWM_HZ;
+		hbPeriods = HB_STEP_MS * HB_PWM_HZ / 1000;
+		Chip_TIMER_SetMatch(LPC_TIMER16_1, 1, period * hbDuty / 100);
+		Chip_TIMER_MatchEnableInt(LPC_TIMER16_1, 1);
+	}
+	hbCount = 0;
+	Chip_TIMER_SetMatch(LPC_TIMER16_1, 0, period - 1);
+	Chip_TIMER_Enable(LPC_TIMER16_1);
+}
+
+/**
+ * @brief	Set the LEDs with a pattern.
+ * @param	on: LEDs to light, bit mask.
+ */
+static void hbApply(uint8_t on)
+{
+	int i;
+
+	for (i = 0; i < HB_LEDS; i++)
+	{
+		if (hbUsed & (1 << i))
+			LED_Set(i, on & (1 << i));
+	}
+}
+
+/**
+ * @brief	Start the heartbeat timer; the patterns can be set before or after.
+ */
+void hbStart(void)
+{
+	Chip_TIMER_Init(LPC_TIMER16_1);
+	Chip_TIMER_PrescaleSet(LPC_TIMER16_1, SystemCoreClock / HB_TIMER_HZ - 1);
+	Chip_TIMER_ResetOnMatchEnable(LPC_TIMER16_1, 0);
+	Chip_TIMER_MatchEnableInt(LPC_TIMER16_1, 0);
+	hbConfigure();
+	NVIC_SetPriority(TIMER_16_1_IRQn, (1 << __NVIC_PRIO_BITS) - 1);
+	NVIC_ClearPendingIRQ(TIMER_16_1_IRQn);
+	NVIC_EnableIRQ(TIMER_16_1_IRQn);
+}
+
+/**
+ * @brief	Set the blink pattern of a LED: bit 0 is shown first, a bit set
+ * 			lights the LED during a step.
+ * @param	led: LED number (LED0 to LED7).
+ * @param	pattern: the pattern.
+ * @param	length: number of bits in the pattern (1 to 32), 0 gives the LED
+ * 			back to the application.
+ * @return	SUCCESS or ERROR if the parameters are out of range.
+ */
+int hbPattern(uint8_t led, uint32_t pattern, uint8_t length)
+{
+	if (led >= HB_LEDS || length > 32)
+		return ERROR;
+
+	taskENTER_CRITICAL();
+	hbPatterns[led] = pattern;
+	hbLength[led] = length;
+	hbPos[led] = 0;
+	if (length)
+		hbUsed |= 1 << led;
+	else
+		hbUsed &= ~(1 << led);
+	taskEXIT_CRITICAL();
+	return SUCCESS;
+}
+
+/**
+ * @brief	Set the brightness of the LEDs with a pattern.
+ * @param	percent: 0 (off) to 100 (fully on).
+ * @return	SUCCESS or ERROR if the brightness is out of range.
+ */
+int hbBrightness(uint8_t percent)
+{
+	if (percent > 100)
+		return ERROR;
+
+	taskENTER_CRITICAL();
+	hbDuty = percent;
+	hbConfigure();
+	taskEXIT_CRITICAL();
+	return SUCCESS;
+}
+
+/**
+ * @brief	Heartbeat timer interrupt: step the patterns, switch the LEDs on
+ * 			and off.
+ */
+void TIMER16_1_IRQHandler(void)
+{
+	int i;
+
+	if (Chip_TIMER_MatchPending(LPC_TIMER16_1, 1))
+	{
+		/* end of the on time */
+		Chip_TIMER_ClearMatch(LPC_TIMER16_1, 1);
+		hbApply(0);
+	}
+	if (Chip_TIMER_MatchPending(LPC_TIMER16_1, 0))
+	{
+		Chip_TIMER_ClearMatch(LPC_TIMER16_1, 0);
+		if (++hbCount >= hbPeriods)
+		{
+			hbCount = 0;
+			hbOn = 0;
+			for (i = 0; i < HB_LEDS; i++)
+			{
+				if (!hbLength[i])
+					continue;
+				if (hbPatterns[i] & (1UL << hbPos[i]))
+					hbOn |= 1 << i;
+				if (++hbPos[i] >= hbLength[i])
+					hbPos[i] = 0;
+			}
+		}
+		hbApply(hbDuty ? hbOn : 0);
+	}
+}
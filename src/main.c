@@ -29,10 +29,10 @@
  * as a starting point for other projects. The project is build using the
  * "gnuarmeclipse" plugins (http://gnuarmeclipse.livius.net).
  *
- * In this file we start two tasks: a LED blinking task and a serial CLI task
- * (command line interface). Add your own tasks depending on the application
- * and of course of the available memory. You can remove the CLI task, or some
- * or all of its commands and add other commands.
+ * In this file we start a serial CLI task (command line interface) and the LED
+ * heartbeat, run by a hardware timer. Add your own tasks depending on
+ * the application and of course of the available memory. You can remove the
+ * CLI task, or some or all of its commands and add other commands.
  */
 
 #include <stdio.h>
@@ -40,12 +40,12 @@
 #include "FreeRTOS.h"
 #include "task.h"
 #include "cli.h"
-
-/* uptime variable */
-volatile uint32_t uptime = 0;
+#include "can.h"
+#include "canopen.h"
+#include "boot.h"
+#include "heartbeat.h"
 
 /* forward declarations */
-static void vLEDTask(void *pvParameters);
 static void cliTask(void *pvParameters);
 
 
@@ -57,17 +57,23 @@ int main(void)
 	SystemCoreClockUpdate();
 	Board_Init();
 
+	/* blink LED6 and LED7 alternatively */
+	hbPattern(LED6, HB_DEFAULT_PATTERN, HB_DEFAULT_LENGTH);
+	hbPattern(LED7, ~HB_DEFAULT_PATTERN, HB_DEFAULT_LENGTH);
+	hbStart();
+#if BOARD_HAS_CAN
+	if (canInit(CAN_DEFAULT_BITRATE) == SUCCESS)
+		canopenInit(CANOPEN_NODE_ID);
+#endif
+	bootMark(BOOT_BOARD);
+
 	/* create the CLI task */
 	xTaskCreate(cliTask, "cli",
 			configMINIMAL_STACK_SIZE * 5, NULL, (tskIDLE_PRIORITY + 1UL),
 			(xTaskHandle *) NULL);
 
-	/* create the LEDs toggle task */
-	xTaskCreate(vLEDTask, "blinkLEDs",
-			configMINIMAL_STACK_SIZE, NULL, (tskIDLE_PRIORITY + 2UL),
-			(xTaskHandle *) NULL);
-
 	/* start the scheduler */
+	bootMark(BOOT_TASKS);
 	vTaskStartScheduler();
 
 	/* should never land here */
@@ -75,24 +81,6 @@ int main(void)
 		;
 }
 
-/**
- * @brief	This task increments the uptime and blinks LED6 and LED7 alternatively.
- * @param 	pvParameters: not used.
- */
-static void vLEDTask(void *pvParameters)
-{
-	(void) pvParameters;
-
-	for (;;)
-	{
-		LED_Toggle(LED6);
-		LED_Set(LED7, !LED_Test(LED6));
-		vTaskDelay(configTICK_RATE_HZ / 2);	/* half a second */
-		if (LED_Test(LED6))
-			uptime++;
-	}
-}
-
 /**
  * @brief	The serial CLI task is started here.
  * @param	pvParameters: not used.
@@ -101,6 +89,8 @@ static void cliTask(void *pvParameters)
 {
 	(void) pvParameters;
 
+	bootDone();
+
 	/* disable output buffering */
 	setvbuf(stdout, NULL, _IONBF, 0);
 
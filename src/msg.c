@@ -0,0 +1,201 @@
+/*
+ * msg.c
+ *
+ * Created on: 18 Oct 2026 (LNP)
+ *
+ * Copyright (c) 2026 Lixco Microsystems <lix@paulian.net>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+/*
+ * A message is a buffer from a pool, preceded by a header with its pool
+ * and its reference count. The queues carry only the pointer to the message,
+ * whatever its size, instead of copying the whole message in and out of the
+ * queue storage. Sending a message hands the sender's reference over to the
+ * receiver, which frees it after use; a message for several receivers gets
+ * one more reference per receiver (msgRef()). Freeing the last reference
+ * returns the buffer to its pool.
+ *
+ * The pools are protected by masking the interrupts, so messages can be
+ * allocated, sent and freed from interrupts.
+ */
+
+#include "FreeRTOS.h"
+#include "task.h"
+#include "queue.h"
+#include "msg.h"
+
+/* message header, two words */
+typedef struct
+{
+	msg_pool_t *pool;
+	uint32_t refs;
+} msg_hdr_t;
+
+/**
+ * @brief	Initialise a pool.
+ * @param	pool: the pool.
+ * @param	storage: MSG_POOL_WORDS(size, count) words of storage.
+ * @param	size: size of a message, bytes.
+ * @param	count: number of messages.
+ * @return	SUCCESS or ERROR if the size or the count is 0.
+ */
+int msgPoolInit(msg_pool_t *pool, uint32_t *storage, uint16_t size,
+		uint16_t count)
+{
+	uint32_t words = 2 + (size + 3) / 4;
+	int i;
+
+	if (!size || !count)
+		return ERROR;
+
+	pool->size = (size + 3) & ~3;
+	pool->count = count;
+	pool->used = 0;
+	pool->peak = 0;
+	pool->free = NULL;
+	for (i = count - 1; i >= 0; i--)
+	{
+		/* the free list link is in the first word of the message */
+		*(void **) &storage[i * words + 2] = pool->free;
+		pool->free = &storage[i * words];
+	}
+	return SUCCESS;
+}
+
+/**
+ * @brief	Allocate a message, with one reference; can be called from
+ * 			interrupts.
+ * @param	pool: the pool.
+ * @return	the message, or NULL if the pool is empty.
+ */
+void *msgAlloc(msg_pool_t *pool)
+{
+	msg_hdr_t *hdr;
+	uint32_t mask;
+
+	mask = portSET_INTERRUPT_MASK_FROM_ISR();
+	if ((hdr = pool->free))
+	{
+		pool->free = *(void **) (hdr + 1);
+		if (++pool->used > pool->peak)
+			pool->peak = pool->used;
+	}
+	portCLEAR_INTERRUPT_MASK_FROM_ISR(mask);
+	if (!hdr)
+		return NULL;
+
+	hdr->pool = pool;
+	hdr->refs = 1;
+	return hdr + 1;
+}
+
+/**
+ * @brief	Add a reference to a message, for one more receiver.
+ * @param	msg: the message.
+ */
+void msgRef(void *msg)
+{
+	msg_hdr_t *hdr = (msg_hdr_t *) msg - 1;
+	uint32_t mask;
+
+	mask = portSET_INTERRUPT_MASK_FROM_ISR();
+	hdr->refs++;
+	portCLEAR_INTERRUPT_MASK_FROM_ISR(mask);
+}
+
+/**
+ * @brief	Drop a reference to a message; the last one returns the message
+ * 			to its pool. Can be called from interrupts.
+ * @param	msg: the message.
+ */
+void msgFree(void *msg)
+{
+	msg_hdr_t *hdr = (msg_hdr_t *) msg - 1;
+	msg_pool_t *pool = hdr->pool;
+	uint32_t mask;
+
+	configASSERT(hdr->refs);
+	mask = portSET_INTERRUPT_MASK_FROM_ISR();
+	if (!--hdr->refs)
+	{
+		*(void **) msg = pool->free;
+		pool->free = hdr;
+		pool->used--;
+	}
+	portCLEAR_INTERRUPT_MASK_FROM_ISR(mask);
+}
+
+/**
+ * @brief	Send a message; the receiver gets the sender's reference.
+ * @param	queue: a queue created with msgQueueCreate().
+ * @param	msg: the message.
+ * @param	timeout: maximum time to wait for room in the queue.
+ * @return	SUCCESS, or ERROR if the queue stayed full; the sender then keeps
+ * 			its reference.
+ */
+int msgSend(xQueueHandle queue, void *msg, portTickType timeout)
+{
+	return xQueueSend(queue, &msg, timeout) == pdPASS ? SUCCESS : ERROR;
+}
+
+/**
+ * @brief	Send a message from an interrupt.
+ * @param	queue: a queue created with msgQueueCreate().
+ * @param	msg: the message.
+ * @param	woken: set to pdTRUE if a context switch is needed at the end of
+ * 			the interrupt.
+ * @return	SUCCESS, or ERROR if the queue is full.
+ */
+int msgSendFromISR(xQueueHandle queue, void *msg, portBASE_TYPE *woken)
+{
+	return xQueueSendFromISR(queue, &msg, woken) == pdPASS ? SUCCESS : ERROR;
+}
+
+/**
+ * @brief	Receive a message; the receiver frees it after use.
+ * @param	queue: a queue created with msgQueueCreate().
+ * @param	timeout: maximum time to wait for a message.
+ * @return	the message, or NULL on timeout.
+ */
+void *msgReceive(xQueueHandle queue, portTickType timeout)
+{
+	void *msg;
+
+	if (xQueueReceive(queue, &msg, timeout) != pdPASS)
+		return NULL;
+	return msg;
+}
+
+/**
+ * @brief	Receive a message from an interrupt.
+ * @param	queue: a queue created with msgQueueCreate().
+ * @param	woken: set to pdTRUE if a context switch is needed at the end of
+ * 			the interrupt.
+ * @return	the message, or NULL if the queue is empty.
+ */
+void *msgReceiveFromISR(xQueueHandle queue, portBASE_TYPE *woken)
+{
+	void *msg;
+
+	if (xQueueReceiveFromISR(queue, &msg, woken) != pdPASS)
+		return NULL;
+	return msg;
+}
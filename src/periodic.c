@@ -0,0 +1,254 @@
+/*
+ * periodic.c
+ *
+ * Created on: 18 Oct 2026 (LNP)
+ *
+ * Copyright (c) 2026 Lixco Microsystems <lix@paulian.net>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+/*
+ * Each periodic task is released by vTaskDelayUntil(), so its period doesn't
+ * stretch with the execution time, and is timed with the microseconds time
+ * base. The nominal releases are counted from the first start of the task:
+ * the lateness of a start is its distance from its nominal release, the
+ * release jitter is the spread between the smallest and the largest
+ * lateness, and a run misses its deadline when it ends later than the
+ * nominal release plus the deadline.
+ *
+ * periodicLoad() starts a load generator: rate monotonic tasks of 5, 10 and
+ * 20 ms above the CLI task, each spinning for its share of the requested
+ * processor load, to check the task set and the statistics under load.
+ */
+
+#include "FreeRTOS.h"
+#include "task.h"
+#include "clock.h"
+#include "boot.h"
+#include "divide.h"
+#include "periodic.h"
+
+#define PERIODIC_US_PER_TICK (1000000 / configTICK_RATE_HZ)
+#define PERIODIC_AVG_SHIFT 4	/* execution time average over 2^n runs */
+#define PERIODIC_LOAD_TASKS 3
+
+typedef struct
+{
+	periodic_fn_t fn;
+	void *param;
+	portTickType period;
+	int32_t late_min;			/* lateness of the starts, us */
+	int32_t late_max;
+	periodic_stats_t stats;
+} periodic_t;
+
+static periodic_t perTasks[PERIODIC_MAX];
+static int perCount;
+
+/* load generator: periods (ticks) and spin time of each run (us) */
+static const uint8_t perLoadPeriod[PERIODIC_LOAD_TASKS] = { 5, 10, 20 };
+static const char * const perLoadName[PERIODIC_LOAD_TASKS] =
+{ "load5", "load10", "load20" };
+static volatile uint32_t perLoadSpin[PERIODIC_LOAD_TASKS];
+static uint8_t perLoadRunning;
+
+/**
+ * @brief	Account for a run of a periodic task.
+ * @param	per: the periodic task descriptor.
+ * @param	release: nominal release of the run, us.
+ * @param	start: start of the run, us.
+ * @param	end: end of the run, us.
+ */
+static void perAccount(periodic_t *per, uint32_t release, uint32_t start,
+		uint32_t end)
+{
+	uint32_t exec;
+	int32_t late;
+
+	/* the differences are right across the wrap of the low word */
+	late = (int32_t) (start - release);
+	exec = end - start;
+	taskENTER_CRITICAL();
+	if (!per->stats.releases || late < per->late_min)
+		per->late_min = late;
+	if (!per->stats.releases || late > per->late_max)
+		per->late_max = late;
+	per->stats.jitter = per->late_max - per->late_min;
+	if (end - release > per->stats.deadline)
+		per->stats.misses++;
+	if (exec > per->stats.exec_max)
+		per->stats.exec_max = exec;
+	if (per->stats.releases)
+		per->stats.exec_avg += ((int32_t) (exec - per->stats.exec_avg))
+				>> PERIODIC_AVG_SHIFT;
+	else
+		per->stats.exec_avg = exec;
+	per->stats.releases++;
+	taskEXIT_CRITICAL();
+}
+
+/**
+ * @brief	Body of the periodic tasks.
+ * @param	pvParameters: the periodic task descriptor.
+ */
+static void perTask(void *pvParameters)
+{
+	periodic_t *per = pvParameters;
+	portTickType lastWake;
+	uint32_t release, start;
+
+	bootDone();					/* start the time base if the first task */
+
+	/* start on a tick, like the next releases */
+	vTaskDelay(1);
+	lastWake = xTaskGetTickCount();
+	release = (uint32_t) clockMicros();
+	for (;;)
+	{
+		start = (uint32_t) clockMicros();
+		per->fn(per->param);
+		perAccount(per, release, start, (uint32_t) clockMicros());
+
+		vTaskDelayUntil(&lastWake, per->period);
+		release += per->stats.period;
+	}
+}
+
+/**
+ * @brief	Work of the load generator tasks: spin for the given time.
+ * @param	param: pointer on the spin time, us.
+ */
+static void perLoad(void *param)
+{
+	uint32_t spin = *(volatile uint32_t *) param;
+	uint32_t start = (uint32_t) clockMicros();
+
+	while ((uint32_t) clockMicros() - start < spin)
+		;
+}
+
+/**
+ * @brief	Create a periodic task.
+ * @param	name: task name.
+ * @param	fn: function called once per period.
+ * @param	param: parameter of the function.
+ * @param	period: period, ticks.
+ * @param	deadline: deadline from the release, ticks; 0 for the period.
+ * @param	prio: task priority; with rate monotonic scheduling, the shorter
+ * 			the period, the higher the priority.
+ * @param	stack: stack size, words.
+ * @return	SUCCESS, or ERROR if there are too many periodic tasks, the
+ * 			parameters are wrong or the task couldn't be created.
+ */
+int periodicCreate(const char *name, periodic_fn_t fn, void *param,
+		portTickType period, portTickType deadline, unsigned portBASE_TYPE prio,
+		uint16_t stack)
+{
+	periodic_t *per;
+
+	if (perCount >= PERIODIC_MAX || !fn || !period || deadline > period)
+		return ERROR;
+
+	per = &perTasks[perCount];
+	per->fn = fn;
+	per->param = param;
+	per->period = period;
+	per->stats.name = name;
+	per->stats.period = period * PERIODIC_US_PER_TICK;
+	per->stats.deadline = (deadline ? deadline : period) * PERIODIC_US_PER_TICK;
+	if (xTaskCreate(perTask, name, stack, per, prio, (xTaskHandle *) NULL)
+			!= pdPASS)
+		return ERROR;
+	perCount++;
+	return SUCCESS;
+}
+
+/**
+ * @brief	Get the statistics of a periodic task.
+ * @param	index: task index, in the order of creation.
+ * @param	stats: where to return the statistics.
+ * @return	SUCCESS or ERROR if there is no such task.
+ */
+int periodicGetStats(int index, periodic_stats_t *stats)
+{
+	if (index < 0 || index >= perCount)
+		return ERROR;
+
+	taskENTER_CRITICAL();
+	*stats = perTasks[index].stats;
+	taskEXIT_CRITICAL();
+	return SUCCESS;
+}
+
+/**
+ * @brief	Start the load generator, or change its load; the statistics are
+ * 			cleared. The load is shared evenly by the three tasks; as the
+ * 			spin is measured in elapsed time, preemption by a task of higher
+ * 			priority is part of it.
+ * @param	percent: processor load, 0 to 100.
+ * @return	SUCCESS, or ERROR if the load is out of range or the tasks
+ * 			couldn't be created.
+ */
+int periodicLoad(uint32_t percent)
+{
+	int i;
+
+	if (percent > 100)
+		return ERROR;
+
+	for (i = 0; i < PERIODIC_LOAD_TASKS; i++)
+		perLoadSpin[i] = udivByConst(percent * perLoadPeriod[i]
+				* PERIODIC_US_PER_TICK, 100 * PERIODIC_LOAD_TASKS);
+	if (!perLoadRunning)
+	{
+		/* rate monotonic priorities, all above the CLI task */
+		for (i = 0; i < PERIODIC_LOAD_TASKS; i++)
+		{
+			if (periodicCreate(perLoadName[i], perLoad,
+					(void *) &perLoadSpin[i], perLoadPeriod[i], 0,
+					tskIDLE_PRIORITY + 1 + PERIODIC_LOAD_TASKS - i,
+					configMINIMAL_STACK_SIZE) == ERROR)
+				return ERROR;
+		}
+		perLoadRunning = TRUE;
+	}
+	periodicResetStats();
+	return SUCCESS;
+}
+
+/**
+ * @brief	Clear the statistics of all the periodic tasks; the nominal
+ * 			releases are kept.
+ */
+void periodicResetStats(void)
+{
+	int i;
+
+	taskENTER_CRITICAL();
+	for (i = 0; i < perCount; i++)
+	{
+		perTasks[i].stats.releases = 0;
+		perTasks[i].stats.misses = 0;
+		perTasks[i].stats.jitter = 0;
+		perTasks[i].stats.exec_max = 0;
+		perTasks[i].stats.exec_avg = 0;
+	}
+	taskEXIT_CRITICAL();
+}
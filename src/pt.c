@@ -0,0 +1,234 @@
+/*
+ * pt.c
+ *
+ * Created on: 18 Oct 2026 (LNP)
+ *
+ * Copyright (c) 2026 Lixco Microsystems <lix@paulian.net>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+/*
+ * The protothreads (after A. Dunkels) keep no stack between two runs: a
+ * protothread is a function which returns when it blocks and resumes at the
+ * line it blocked at, so it costs only its pt_t, some 24 bytes, where a task
+ * costs its TCB and a stack of a few hundred bytes. They are run in turn by
+ * one task, which sleeps while none is ready: until the nearest end of a
+ * delay, or until an event is posted (a task notification).
+ *
+ * The kernel co-routines (croutine.c) are not used: their control blocks are
+ * allocated on the heap, they run only from the idle task and can only wait
+ * on queues.
+ */
+
+#include "FreeRTOS.h"
+#include "task.h"
+#include "pt.h"
+
+#define PT_STATE_READY 0
+#define PT_STATE_WAIT 1			/* for events, no timeout */
+#define PT_STATE_TIMED 2		/* for events or the end of a delay */
+
+static pt_t *ptList;			/* run by the scheduler */
+static pt_t *ptNew;				/* started, not in the list yet */
+static xTaskHandle ptTaskHandle;
+
+/**
+ * @brief	Check if a protothread can run, and if so take its events.
+ * @param	pt: the protothread.
+ * @param	now: the tick count.
+ * @return	TRUE if the protothread can run.
+ */
+static int ptReady(pt_t *pt, portTickType now)
+{
+	uint32_t got;
+
+	if (pt->state == PT_STATE_READY)
+		return TRUE;
+
+	taskENTER_CRITICAL();
+	got = pt->events & pt->wait;
+	pt->events &= ~got;
+	taskEXIT_CRITICAL();
+	if (got || (pt->state == PT_STATE_TIMED
+			&& (int32_t) (now - pt->wake) >= 0))
+	{
+		pt->wait = got;
+		return TRUE;
+	}
+	return FALSE;
+}
+
+/**
+ * @brief	Run the protothreads ready, once each.
+ * @return	ticks until the next one is ready, 0 if one is already,
+ * 			portMAX_DELAY if they all wait for events only.
+ */
+static portTickType ptRun(void)
+{
+	pt_t **pp, *pt;
+	portTickType now, timeout, elapsed;
+	int ready;
+
+	/* take the protothreads started since the last pass */
+	taskENTER_CRITICAL();
+	while ((pt = ptNew))
+	{
+		ptNew = pt->next;
+		pt->next = ptList;
+		ptList = pt;
+	}
+	taskEXIT_CRITICAL();
+
+	now = xTaskGetTickCount();
+	ready = FALSE;
+	timeout = portMAX_DELAY;
+	for (pp = &ptList; (pt = *pp);)
+	{
+		if (ptReady(pt, now))
+		{
+			pt->state = PT_STATE_READY;
+			switch (pt->fn(pt))
+			{
+			case PT_EXITED:
+			case PT_ENDED:
+				*pp = pt->next;
+				continue;
+			case PT_YIELDED:
+				ready = TRUE;
+				break;
+			default:
+				/* events posted before the wait */
+				if (pt->events & pt->wait)
+					ready = TRUE;
+				break;
+			}
+		}
+		if (pt->state == PT_STATE_TIMED
+				&& (portTickType) (pt->wake - now) < timeout)
+			timeout = pt->wake - now;
+		pp = &pt->next;
+	}
+
+	/* the delays are counted from the start of the pass */
+	if (ready)
+		return 0;
+	if (timeout != portMAX_DELAY)
+	{
+		elapsed = xTaskGetTickCount() - now;
+		timeout = timeout > elapsed ? timeout - elapsed : 0;
+	}
+	return timeout;
+}
+
+/**
+ * @brief	The scheduler task: run the protothreads ready, then sleep until
+ * 			the next one is.
+ * @param	pvParameters: not used.
+ */
+static void ptTask(void *pvParameters)
+{
+	(void) pvParameters;
+
+	for (;;)
+		ulTaskNotifyTake(pdTRUE, ptRun());
+}
+
+/**
+ * @brief	Create the task which runs the protothreads.
+ * @param	prio: task priority.
+ * @param	stack: stack size, words; the protothreads run on this stack.
+ * @return	SUCCESS or ERROR if the task couldn't be created.
+ */
+int ptInit(unsigned portBASE_TYPE prio, uint16_t stack)
+{
+	if (xTaskCreate(ptTask, "pt", stack, NULL, prio, &ptTaskHandle) != pdPASS)
+		return ERROR;
+	return SUCCESS;
+}
+
+/**
+ * @brief	Start a protothread; can be called by a task or a protothread.
+ * @param	pt: the protothread, which must not be running.
+ * @param	fn: the protothread function.
+ */
+void ptStart(pt_t *pt, pt_fn_t fn)
+{
+	pt->fn = fn;
+	pt->lc = 0;
+	pt->events = 0;
+	pt->wait = 0;
+	pt->state = PT_STATE_READY;
+	taskENTER_CRITICAL();
+	pt->next = ptNew;
+	ptNew = pt;
+	taskEXIT_CRITICAL();
+	if (ptTaskHandle)
+		xTaskNotifyGive(ptTaskHandle);
+}
+
+/**
+ * @brief	Prepare a wait; used by the PT_xxx macros.
+ * @param	pt: the protothread.
+ * @param	mask: events to wait for, 0 for a delay only.
+ * @param	timeout: ticks, portMAX_DELAY for no timeout.
+ */
+void ptWait(pt_t *pt, uint32_t mask, portTickType timeout)
+{
+	pt->wait = mask;
+	if (timeout == portMAX_DELAY)
+		pt->state = PT_STATE_WAIT;
+	else
+	{
+		pt->wake = xTaskGetTickCount() + timeout;
+		pt->state = PT_STATE_TIMED;
+	}
+}
+
+/**
+ * @brief	Post events to a protothread.
+ * @param	pt: the protothread.
+ * @param	events: the events, a bit mask.
+ */
+void ptPost(pt_t *pt, uint32_t events)
+{
+	taskENTER_CRITICAL();
+	pt->events |= events;
+	taskEXIT_CRITICAL();
+	if (ptTaskHandle)
+		xTaskNotifyGive(ptTaskHandle);
+}
+
+/**
+ * @brief	Post events to a protothread from an interrupt.
+ * @param	pt: the protothread.
+ * @param	events: the events, a bit mask.
+ * @param	woken: set to pdTRUE if a context switch is needed at the end of
+ * 			the interrupt.
+ */
+void ptPostFromISR(pt_t *pt, uint32_t events, portBASE_TYPE *woken)
+{
+	uint32_t mask;
+
+	mask = portSET_INTERRUPT_MASK_FROM_ISR();
+	pt->events |= events;
+	portCLEAR_INTERRUPT_MASK_FROM_ISR(mask);
+	if (ptTaskHandle)
+		vTaskNotifyGiveFromISR(ptTaskHandle, woken);
+}
@@ -0,0 +1,350 @@
+/*
+ * nxpclient.c
+ *
+ * Created on: 18 Oct 2026 (LNP)
+ *
+ * Copyright (c) 2026 Lixco Microsystems <lix@paulian.net>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+/*
+ * Command line client for the framed binary protocol. Build it on the host
+ * with:
+ *
+ *   cc -O2 -o nxpclient nxpclient.c nxpframe.c
+ *
+ * Usage: nxpclient device baud command [args]
+ *   info                        show the device information
+ *   ping                        send a ping
+ *   baud rate                   switch both ends to a new baud rate
+ *   bench [count [size]]        ping throughput, stop-and-wait vs. pipelined
+ *   read {flash|ram|address size} file
+ *                               read a memory range with framed requests
+ *   write address file          write a file in RAM with framed requests
+ *   rawdump {flash|ram|address size} file
+ *                               read a memory range with "dump -b"
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <poll.h>
+#include "nxpframe.h"
+
+#define TIMEOUT 1000			/* ms */
+#define MAX_IMAGE 0x8000		/* largest memory range, the flash */
+
+/**
+ * @brief	Read a little endian 32-bit value.
+ * @param	p: pointer on the value.
+ * @return	the value.
+ */
+static uint32_t get32(const uint8_t *p)
+{
+	return p[0] | (p[1] << 8) | (p[2] << 16) | ((uint32_t) p[3] << 24);
+}
+
+/**
+ * @brief	Return a monotonic time stamp.
+ * @return	the time in seconds.
+ */
+static double now(void)
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+/**
+ * @brief	Get the device information; also sets the pipelining window.
+ * @param	h: the connection.
+ * @param	print: if TRUE, print the information.
+ * @return	0 on success, an error otherwise.
+ */
+static int info(nxp_t *h, int print)
+{
+	nxp_resp_t resp;
+	int result, name;
+
+	if ((result = nxp_request(h, NXP_CMD_INFO, NULL, 0, &resp, TIMEOUT)) != 0)
+		return result;
+
+	h->window = resp.data[2] | (resp.data[3] << 8);
+	if (print)
+	{
+		name = resp.data[0] >= 2 ? 24 : 20;	/* version 2 adds the tx errors */
+		printf("%.*s, protocol %d, max data %d, window %d\n", resp.len - name,
+				(char *) resp.data + name, resp.data[0], resp.data[1], h->window);
+		printf("baud %u, frames %u, CRC errors %u, format errors %u",
+				get32(resp.data + 4), get32(resp.data + 8),
+				get32(resp.data + 12), get32(resp.data + 16));
+		if (resp.data[0] >= 2)
+			printf(", tx errors %u", get32(resp.data + 20));
+		printf("\n");
+	}
+	return 0;
+}
+
+/**
+ * @brief	Ping throughput: count pings with size bytes of data each, with
+ * 			up to window bytes of requests in flight.
+ * @param	h: the connection.
+ * @param	count: number of pings.
+ * @param	size: ping data size.
+ * @param	window: maximum bytes in flight, 0 for stop-and-wait.
+ * @return	0 on success, an error otherwise.
+ */
+static int bench(nxp_t *h, int count, int size, int window)
+{
+	uint8_t data[NXP_FRAME_MAX_DATA];
+	nxp_resp_t resp;
+	int i, sent = 0, received = 0, inflight = 0, frame, result;
+	double start, elapsed;
+
+	for (i = 0; i < size; i++)
+		data[i] = i;
+	frame = nxp_frame_size(size);
+
+	start = now();
+	while (received < count)
+	{
+		if (sent < count && (inflight == 0 || inflight + frame <= window))
+		{
+			if ((result = nxp_send(h, NXP_CMD_PING, data, size)) < 0)
+				return result;
+			sent++;
+			inflight += frame;
+			continue;
+		}
+		if ((result = nxp_recv(h, &resp, TIMEOUT)) < 0)
+			return result;
+		if (resp.status != 0 || resp.len != size || memcmp(resp.data, data, size))
+			return NXP_ERR_FRAME;
+		received++;
+		inflight -= frame;
+	}
+	elapsed = now() - start;
+
+	printf("%-8s size %3d: %7.1f req/s, %8.0f bytes/s payload each way\n",
+			window ? "pipeline" : "stopwait", size, count / elapsed,
+			count * size / elapsed);
+	return 0;
+}
+
+/**
+ * @brief	Parse a memory range: "flash", "ram" or an address and a size.
+ * @param	argv: the arguments.
+ * @param	address: pointer to return the start address.
+ * @param	size: pointer to return the size.
+ * @return	the number of arguments used, 0 if the range is invalid.
+ */
+static int parseRange(char *argv[], uint32_t *address, int *size)
+{
+	if (!strcmp(argv[0], "flash"))
+	{
+		*address = 0x00000000;
+		*size = 0x8000;
+		return 1;
+	}
+	if (!strcmp(argv[0], "ram"))
+	{
+		*address = 0x10000000;
+		*size = 0x2000;
+		return 1;
+	}
+	if (!argv[1])
+		return 0;
+	*address = strtoul(argv[0], NULL, 16);
+	*size = strtoul(argv[1], NULL, 16);
+	return (*size > 0 && *size <= MAX_IMAGE) ? 2 : 0;
+}
+
+/**
+ * @brief	Read exactly len bytes from the serial port.
+ * @param	h: the connection.
+ * @param	buff: buffer receiving the data.
+ * @param	len: number of bytes to read.
+ * @return	0 on success, an error otherwise.
+ */
+static int readRaw(nxp_t *h, uint8_t *buff, int len)
+{
+	struct pollfd pfd = { h->fd, POLLIN, 0 };
+	int n;
+
+	while (len > 0)
+	{
+		if (poll(&pfd, 1, TIMEOUT) <= 0)
+			return NXP_ERR_TIMEOUT;
+		if ((n = read(h->fd, buff, len)) <= 0)
+			return NXP_ERR_IO;
+		buff += n;
+		len -= n;
+	}
+	return 0;
+}
+
+/**
+ * @brief	Read a memory range with the text "dump -b" command: raw data
+ * 			after a "BIN" line, followed by its CRC32.
+ * @param	h: the connection.
+ * @param	address: start address on the device.
+ * @param	buff: buffer receiving the data.
+ * @param	size: number of bytes to read.
+ * @return	0 on success, an error otherwise.
+ */
+static int rawDump(nxp_t *h, uint32_t address, uint8_t *buff, int size)
+{
+	static const char marker[] = "BIN\r\n";
+	char cmd[40];
+	uint8_t c, crc[4];
+	int n, matched = 0, result;
+
+	n = snprintf(cmd, sizeof(cmd), "dump -b %x %x\r", address, size);
+	if (write(h->fd, cmd, n) != n)
+		return NXP_ERR_IO;
+
+	/* skip the echo up to the marker */
+	while (marker[matched])
+	{
+		if ((result = readRaw(h, &c, 1)) < 0)
+			return result;
+		matched = (c == (uint8_t) marker[matched]) ? matched + 1 : (c == 'B');
+	}
+	if ((result = readRaw(h, buff, size)) < 0 || (result = readRaw(h, crc, 4)) < 0)
+		return result;
+	if (get32(crc) != nxp_crc32(0, buff, size))
+		return NXP_ERR_FRAME;
+	return 0;
+}
+
+/**
+ * @brief	Save a buffer to a file.
+ * @param	name: the file name.
+ * @param	buff: the data.
+ * @param	size: the data size.
+ * @return	0 on success, 1 otherwise.
+ */
+static int saveFile(const char *name, const uint8_t *buff, int size)
+{
+	FILE *f;
+	int result;
+
+	if (!(f = fopen(name, "wb")))
+	{
+		perror(name);
+		return 1;
+	}
+	result = fwrite(buff, 1, size, f) != (size_t) size;
+	fclose(f);
+	return result;
+}
+
+int main(int argc, char *argv[])
+{
+	static uint8_t image[MAX_IMAGE];
+	nxp_t h;
+	nxp_resp_t resp;
+	int32_t ppm;
+	uint32_t address;
+	int result = 0, count, size, n;
+	double start;
+	FILE *f;
+
+	if (argc < 4)
+	{
+		fprintf(stderr, "Usage: %s device baud {info|ping|baud rate|"
+				"bench [count [size]]}\n", argv[0]);
+		return 1;
+	}
+	if (nxp_open(&h, argv[1], strtoul(argv[2], NULL, 0)) < 0)
+	{
+		perror(argv[1]);
+		return 1;
+	}
+
+	if (!strcmp(argv[3], "info"))
+		result = info(&h, 1);
+	else if (!strcmp(argv[3], "ping"))
+	{
+		if ((result = nxp_request(&h, NXP_CMD_PING, NULL, 0, &resp, TIMEOUT)) == 0)
+			printf("pong\n");
+	}
+	else if (!strcmp(argv[3], "baud") && argc == 5)
+	{
+		if ((result = nxp_change_baud(&h, strtoul(argv[4], NULL, 0), &ppm)) == 0)
+			printf("baud rate %u (%d ppm)\n", h.baud, ppm);
+	}
+	else if (!strcmp(argv[3], "bench"))
+	{
+		count = argc > 4 ? atoi(argv[4]) : 1000;
+		size = argc > 5 ? atoi(argv[5]) : 32;
+		if (size < 0 || size > NXP_FRAME_MAX_DATA)
+			size = NXP_FRAME_MAX_DATA;
+		if ((result = info(&h, 0)) == 0
+				&& (result = bench(&h, count, size, 0)) == 0)
+			result = bench(&h, count, size, h.window);
+	}
+	else if ((!strcmp(argv[3], "read") || !strcmp(argv[3], "rawdump"))
+			&& argc > 5 && (n = parseRange(&argv[4], &address, &size))
+			&& argc == 5 + n)
+	{
+		start = now();
+		if (!strcmp(argv[3], "read"))
+		{
+			if ((result = info(&h, 0)) == 0)
+				result = nxp_read_mem(&h, address, image, size);
+		}
+		else
+			result = rawDump(&h, address, image, size);
+		if (result == 0)
+		{
+			printf("%d bytes in %.2f s\n", size, now() - start);
+			result = saveFile(argv[4 + n], image, size);
+		}
+	}
+	else if (!strcmp(argv[3], "write") && argc == 6)
+	{
+		address = strtoul(argv[4], NULL, 16);
+		if (!(f = fopen(argv[5], "rb")))
+		{
+			perror(argv[5]);
+			return 1;
+		}
+		size = fread(image, 1, sizeof(image), f);
+		fclose(f);
+		start = now();
+		if ((result = info(&h, 0)) == 0
+				&& (result = nxp_write_mem(&h, address, image, size)) == 0)
+			printf("%d bytes in %.2f s\n", size, now() - start);
+	}
+	else
+	{
+		fprintf(stderr, "unknown command %s\n", argv[3]);
+		result = 1;
+	}
+
+	if (result)
+		fprintf(stderr, "error %d\n", result);
+	nxp_close(&h);
+	return result != 0;
+}
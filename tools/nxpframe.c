@@ -0,0 +1,468 @@
+/*
+ * nxpframe.c
+ *
+ * Created on: 18 Oct 2026 (LNP)
+ *
+ * Copyright (c) 2026 Lixco Microsystems <lix@paulian.net>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+/*
+ * Host (Linux) side of the framed binary protocol. Requests can be pipelined:
+ * nxp_send() returns the sequence number of the request and nxp_recv()
+ * returns the responses in the order the device answers them. Keep the
+ * encoded size of the requests in flight below nxp_t.window, the device
+ * receive queue is small.
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <termios.h>
+#include "nxpframe.h"
+
+/* time to let the device switch its baud rate, in microseconds */
+#define BAUD_SWITCH_DELAY 20000
+
+static const struct
+{
+	uint32_t rate;
+	speed_t speed;
+} speeds[] =
+{
+		{ 9600, B9600 }, { 19200, B19200 }, { 38400, B38400 },
+		{ 57600, B57600 }, { 115200, B115200 }, { 230400, B230400 },
+		{ 460800, B460800 }, { 500000, B500000 }, { 921600, B921600 },
+		{ 1000000, B1000000 }, { 1500000, B1500000 }, { 2000000, B2000000 },
+		{ 3000000, B3000000 }, { 0, B0 }
+};
+
+/**
+ * @brief	Compute the CRC32 (IEEE 802.3) of a block of data.
+ * @param	crc: the CRC of the previous blocks, 0 for the first block.
+ * @param	data: pointer on the data.
+ * @param	len: length of the data.
+ * @return	the updated CRC.
+ */
+uint32_t nxp_crc32(uint32_t crc, const uint8_t *data, int len)
+{
+	int i;
+
+	crc = ~crc;
+	while (len--)
+	{
+		crc ^= *data++;
+		for (i = 0; i < 8; i++)
+			crc = (crc >> 1) ^ (0xEDB88320 & -(crc & 1));
+	}
+	return ~crc;
+}
+
+/**
+ * @brief	Set the baud rate of the host serial port.
+ * @param	h: the connection.
+ * @param	baud: the new baud rate.
+ * @return	0 on success, NXP_ERR_IO otherwise.
+ */
+int nxp_set_baud(nxp_t *h, uint32_t baud)
+{
+	struct termios tio;
+	int i;
+
+	for (i = 0; speeds[i].rate && speeds[i].rate != baud; i++)
+		;
+	if (!speeds[i].rate || tcgetattr(h->fd, &tio) < 0)
+		return NXP_ERR_IO;
+
+	tcdrain(h->fd);
+	cfsetispeed(&tio, speeds[i].speed);
+	cfsetospeed(&tio, speeds[i].speed);
+	if (tcsetattr(h->fd, TCSANOW, &tio) < 0)
+		return NXP_ERR_IO;
+	h->baud = baud;
+	return 0;
+}
+
+/**
+ * @brief	Open a connection to the device.
+ * @param	h: the connection.
+ * @param	device: the serial device, e.g. /dev/ttyUSB0.
+ * @param	baud: the current baud rate of the device.
+ * @return	0 on success, NXP_ERR_IO otherwise.
+ */
+int nxp_open(nxp_t *h, const char *device, uint32_t baud)
+{
+	struct termios tio;
+
+	memset(h, 0, sizeof(*h));
+	h->rxlen = -1;
+	h->window = 128;			/* updated from the info command */
+	if ((h->fd = open(device, O_RDWR | O_NOCTTY)) < 0)
+		return NXP_ERR_IO;
+
+	if (tcgetattr(h->fd, &tio) < 0)
+	{
+		close(h->fd);
+		return NXP_ERR_IO;
+	}
+	cfmakeraw(&tio);
+	tio.c_cflag |= CLOCAL | CREAD;
+	tio.c_cc[VMIN] = 0;
+	tio.c_cc[VTIME] = 0;
+	if (tcsetattr(h->fd, TCSANOW, &tio) < 0 || nxp_set_baud(h, baud) < 0)
+	{
+		close(h->fd);
+		return NXP_ERR_IO;
+	}
+	tcflush(h->fd, TCIOFLUSH);
+	return 0;
+}
+
+/**
+ * @brief	Close a connection.
+ * @param	h: the connection.
+ */
+void nxp_close(nxp_t *h)
+{
+	close(h->fd);
+}
+
+/**
+ * @brief	Compute the number of bytes sent on the line for a request.
+ * @param	len: length of the request data.
+ * @return	the encoded frame size, with delimiters.
+ */
+int nxp_frame_size(int len)
+{
+	len += NXP_FRAME_HEADER + NXP_FRAME_CRC;
+	return len + len / 254 + 1 + 2;
+}
+
+/**
+ * @brief	Send a request, without waiting for the response.
+ * @param	h: the connection.
+ * @param	cmd: the command.
+ * @param	data: the command data.
+ * @param	len: length of the command data.
+ * @return	the sequence number of the request, or a negative error.
+ */
+int nxp_send(nxp_t *h, uint8_t cmd, const uint8_t *data, int len)
+{
+	uint8_t raw[NXP_FRAME_MAX_RAW], out[NXP_FRAME_MAX_ENCODED + 2];
+	uint8_t *code;
+	uint32_t crc;
+	int i, n, seq;
+
+	if (len < 0 || len > NXP_FRAME_MAX_DATA)
+		return NXP_ERR_FRAME;
+
+	seq = h->seq++;
+	raw[0] = seq;
+	raw[1] = cmd;
+	raw[2] = 0;
+	if (len)
+		memcpy(raw + NXP_FRAME_HEADER, data, len);
+	len += NXP_FRAME_HEADER;
+	crc = nxp_crc32(0, raw, len);
+	for (i = 0; i < NXP_FRAME_CRC; i++)
+		raw[len++] = crc >> (8 * i);
+
+	/* COBS encode between two delimiters */
+	n = 0;
+	out[n++] = 0;
+	code = &out[n++];
+	*code = 1;
+	for (i = 0; i < len; i++)
+	{
+		if (raw[i] == 0)
+		{
+			code = &out[n++];
+			*code = 1;
+			continue;
+		}
+		out[n++] = raw[i];
+		if (++*code == 0xFF && i + 1 < len)
+		{
+			code = &out[n++];
+			*code = 1;
+		}
+	}
+	out[n++] = 0;
+
+	if (write(h->fd, out, n) != n)
+		return NXP_ERR_IO;
+	return seq;
+}
+
+/**
+ * @brief	Decode and check the frame accumulated in the receive buffer.
+ * @param	h: the connection.
+ * @param	resp: pointer on a structure to return the response.
+ * @return	0 if the frame is a valid response, NXP_ERR_FRAME otherwise.
+ */
+static int nxp_decode(nxp_t *h, nxp_resp_t *resp)
+{
+	uint8_t raw[NXP_FRAME_MAX_ENCODED];
+	uint32_t crc;
+	int i, n = 0, code, pos = 0;
+
+	while (pos < h->rxlen)
+	{
+		code = h->rx[pos++];
+		if (pos + code - 1 > h->rxlen)
+			return NXP_ERR_FRAME;
+		for (i = 1; i < code; i++)
+			raw[n++] = h->rx[pos++];
+		if (code < 0xFF && pos < h->rxlen)
+			raw[n++] = 0;
+	}
+
+	if (n < NXP_FRAME_HEADER + NXP_FRAME_CRC || n > NXP_FRAME_MAX_RAW)
+		return NXP_ERR_FRAME;
+	n -= NXP_FRAME_CRC;
+	crc = raw[n] | (raw[n + 1] << 8) | (raw[n + 2] << 16) | ((uint32_t) raw[n + 3] << 24);
+	if (crc != nxp_crc32(0, raw, n) || !(raw[1] & NXP_FRAME_RESPONSE))
+		return NXP_ERR_FRAME;
+
+	resp->seq = raw[0];
+	resp->cmd = raw[1] & ~NXP_FRAME_RESPONSE;
+	resp->status = raw[2];
+	resp->len = n - NXP_FRAME_HEADER;
+	memcpy(resp->data, raw + NXP_FRAME_HEADER, resp->len);
+	return 0;
+}
+
+/**
+ * @brief	Wait for the next response. Text output of the CLI and corrupted
+ * 			frames are skipped.
+ * @param	h: the connection.
+ * @param	resp: pointer on a structure to return the response.
+ * @param	timeout_ms: maximum time to wait, in milliseconds.
+ * @return	0 on success, or a negative error.
+ */
+int nxp_recv(nxp_t *h, nxp_resp_t *resp, int timeout_ms)
+{
+	struct pollfd pfd;
+	uint8_t c;
+
+	pfd.fd = h->fd;
+	pfd.events = POLLIN;
+	for (;;)
+	{
+		if (h->inpos == h->inlen)
+		{
+			if (poll(&pfd, 1, timeout_ms) <= 0)
+				return NXP_ERR_TIMEOUT;
+			if ((h->inlen = read(h->fd, h->in, sizeof(h->in))) <= 0)
+				return NXP_ERR_IO;
+			h->inpos = 0;
+		}
+
+		c = h->in[h->inpos++];
+		if (c == 0)
+		{
+			/* a delimiter closes the current frame and opens the next one */
+			if (h->rxlen > 0 && nxp_decode(h, resp) == 0)
+			{
+				h->rxlen = 0;
+				return 0;
+			}
+			h->rxlen = 0;
+		}
+		else if (h->rxlen >= 0)
+		{
+			if (h->rxlen < (int) sizeof(h->rx))
+				h->rx[h->rxlen++] = c;
+			else
+				h->rxlen = -1;	/* overflow, wait for the next delimiter */
+		}
+	}
+}
+
+/**
+ * @brief	Send a request and wait for its response.
+ * @param	h: the connection.
+ * @param	cmd: the command.
+ * @param	data: the command data.
+ * @param	len: length of the command data.
+ * @param	resp: pointer on a structure to return the response.
+ * @param	timeout_ms: maximum time to wait, in milliseconds.
+ * @return	the device status (0 if OK), or a negative error.
+ */
+int nxp_request(nxp_t *h, uint8_t cmd, const uint8_t *data, int len,
+		nxp_resp_t *resp, int timeout_ms)
+{
+	int seq, result;
+
+	if ((seq = nxp_send(h, cmd, data, len)) < 0)
+		return seq;
+	do
+	{
+		if ((result = nxp_recv(h, resp, timeout_ms)) < 0)
+			return result;
+	} while (resp->seq != seq);	/* skip late responses of older requests */
+
+	return resp->status;
+}
+
+/**
+ * @brief	Change the baud rate of both the device and the host. No other
+ * 			request may be in flight.
+ * @param	h: the connection.
+ * @param	baud: the new baud rate.
+ * @param	ppm: pointer to return the device rate error in ppm; can be NULL.
+ * @return	the device status (0 if OK), or a negative error.
+ */
+int nxp_change_baud(nxp_t *h, uint32_t baud, int32_t *ppm)
+{
+	nxp_resp_t resp;
+	uint8_t data[4];
+	uint32_t previous = h->baud;
+	int result;
+
+	data[0] = baud;
+	data[1] = baud >> 8;
+	data[2] = baud >> 16;
+	data[3] = baud >> 24;
+	if ((result = nxp_request(h, NXP_CMD_BAUD, data, 4, &resp, 1000)) != 0)
+		return result;
+	if (ppm && resp.len >= 8)
+		*ppm = resp.data[4] | (resp.data[5] << 8) | (resp.data[6] << 16)
+				| ((uint32_t) resp.data[7] << 24);
+
+	/* switch, then confirm the new rate with a ping */
+	if ((result = nxp_set_baud(h, baud)) < 0)
+		return result;
+	usleep(BAUD_SWITCH_DELAY);
+	tcflush(h->fd, TCIFLUSH);
+	h->inpos = h->inlen = 0;
+	if ((result = nxp_request(h, NXP_CMD_PING, NULL, 0, &resp, 1000)) != 0)
+		nxp_set_baud(h, previous);	/* the device falls back too */
+	return result;
+}
+
+/**
+ * @brief	Store a little endian 32-bit value.
+ * @param	p: pointer where to store the value.
+ * @param	value: the value.
+ */
+static void put32(uint8_t *p, uint32_t value)
+{
+	p[0] = value;
+	p[1] = value >> 8;
+	p[2] = value >> 16;
+	p[3] = value >> 24;
+}
+
+/**
+ * @brief	Transfer a memory range with pipelined read or write requests.
+ * @param	h: the connection.
+ * @param	cmd: NXP_CMD_READ or NXP_CMD_WRITE.
+ * @param	address: start address on the device.
+ * @param	buff: the host buffer.
+ * @param	size: number of bytes to transfer.
+ * @param	chunk: number of bytes per request.
+ * @return	0 on success, the device status or a negative error otherwise.
+ */
+static int nxp_transfer(nxp_t *h, uint8_t cmd, uint32_t address, uint8_t *buff,
+		int size, int chunk)
+{
+	uint8_t req[NXP_FRAME_MAX_DATA];
+	int offsets[256];				/* buffer offset of each sequence number */
+	nxp_resp_t resp;
+	int sent = 0, done = 0, inflight = 0, n, len, frame, seq, result;
+
+	while (done < size)
+	{
+		n = size - sent < chunk ? size - sent : chunk;
+		len = cmd == NXP_CMD_READ ? 6 : 4 + n;
+		frame = nxp_frame_size(len);
+		if (sent < size && (inflight == 0 || inflight + frame <= h->window))
+		{
+			put32(req, address + sent);
+			if (cmd == NXP_CMD_READ)
+			{
+				req[4] = n;
+				req[5] = n >> 8;
+			}
+			else
+				memcpy(req + 4, buff + sent, n);
+			if ((seq = nxp_send(h, cmd, req, len)) < 0)
+				return seq;
+			offsets[seq] = sent;
+			sent += n;
+			inflight += frame;
+			continue;
+		}
+
+		if ((result = nxp_recv(h, &resp, 1000)) < 0)
+			return result;
+		if (resp.cmd != cmd)
+			continue;
+		if (resp.status)
+			return resp.status;
+		n = size - offsets[resp.seq] < chunk ? size - offsets[resp.seq] : chunk;
+		if (cmd == NXP_CMD_READ)
+		{
+			if (resp.len != n)
+				return NXP_ERR_FRAME;
+			memcpy(buff + offsets[resp.seq], resp.data, n);
+		}
+		done += n;
+		inflight -= nxp_frame_size(cmd == NXP_CMD_READ ? 6 : 4 + n);
+	}
+	return 0;
+}
+
+/**
+ * @brief	Read a memory range from the device (flash, RAM or boot ROM).
+ * @param	h: the connection.
+ * @param	address: start address on the device.
+ * @param	buff: buffer receiving the data.
+ * @param	size: number of bytes to read.
+ * @return	0 on success, the device status or a negative error otherwise.
+ */
+int nxp_read_mem(nxp_t *h, uint32_t address, uint8_t *buff, int size)
+{
+	return nxp_transfer(h, NXP_CMD_READ, address, buff, size,
+			NXP_FRAME_MAX_DATA);
+}
+
+/**
+ * @brief	Write a memory range on the device (RAM only).
+ * @param	h: the connection.
+ * @param	address: start address on the device.
+ * @param	buff: the data to write.
+ * @param	size: number of bytes to write.
+ * @return	0 on success, the device status or a negative error otherwise.
+ */
+int nxp_write_mem(nxp_t *h, uint32_t address, const uint8_t *buff, int size)
+{
+	int chunk;
+
+	/* keep two write requests in the device receive window */
+	for (chunk = NXP_FRAME_MAX_DATA - 4;
+			chunk > 16 && 2 * nxp_frame_size(4 + chunk) > h->window; chunk--)
+		;
+	return nxp_transfer(h, NXP_CMD_WRITE, address, (uint8_t *) buff, size,
+			chunk);
+}
@@ -0,0 +1,74 @@
+/*
+ * nxpframe.h
+ *
+ * Host side client library for the framed binary protocol (see
+ * include/frame.h for the frame format).
+ *
+ * Created on: 18 Oct 2026 (LNP)
+ *
+ * (c) 2026 Lixco Microsystems <lix@paulian.net>
+ */
+
+#ifndef NXPFRAME_H_
+#define NXPFRAME_H_
+
+#include <stdint.h>
+
+/* protocol constants, must match include/frame.h */
+#define NXP_FRAME_HEADER 3
+#define NXP_FRAME_CRC 4
+#define NXP_FRAME_MAX_DATA 128
+#define NXP_FRAME_MAX_RAW (NXP_FRAME_HEADER + NXP_FRAME_MAX_DATA + NXP_FRAME_CRC)
+#define NXP_FRAME_MAX_ENCODED (NXP_FRAME_MAX_RAW + NXP_FRAME_MAX_RAW / 254 + 1)
+#define NXP_FRAME_RESPONSE 0x80
+
+#define NXP_CMD_PING 0x01
+#define NXP_CMD_INFO 0x02
+#define NXP_CMD_BAUD 0x03
+#define NXP_CMD_READ 0x10
+#define NXP_CMD_WRITE 0x11
+
+/* library errors (the device status codes are positive) */
+#define NXP_ERR_IO (-1)
+#define NXP_ERR_TIMEOUT (-2)
+#define NXP_ERR_FRAME (-3)
+#define NXP_ERR_SEQ (-4)
+
+/* a connection to the device */
+typedef struct
+{
+	int fd;
+	uint32_t baud;
+	uint8_t seq;				/* next sequence number */
+	int window;					/* max bytes in flight towards the device */
+	uint8_t rx[NXP_FRAME_MAX_ENCODED];
+	int rxlen;					/* bytes of the current frame in rx, -1 if
+								   the frame overflowed */
+	uint8_t in[256];			/* raw input from the serial port */
+	int inpos, inlen;
+} nxp_t;
+
+/* a received response */
+typedef struct
+{
+	uint8_t seq;
+	uint8_t cmd;
+	uint8_t status;
+	int len;
+	uint8_t data[NXP_FRAME_MAX_DATA];
+} nxp_resp_t;
+
+uint32_t nxp_crc32(uint32_t crc, const uint8_t *data, int len);
+int nxp_open(nxp_t *h, const char *device, uint32_t baud);
+void nxp_close(nxp_t *h);
+int nxp_set_baud(nxp_t *h, uint32_t baud);
+int nxp_frame_size(int len);
+int nxp_send(nxp_t *h, uint8_t cmd, const uint8_t *data, int len);
+int nxp_recv(nxp_t *h, nxp_resp_t *resp, int timeout_ms);
+int nxp_request(nxp_t *h, uint8_t cmd, const uint8_t *data, int len,
+		nxp_resp_t *resp, int timeout_ms);
+int nxp_change_baud(nxp_t *h, uint32_t baud, int32_t *ppm);
+int nxp_read_mem(nxp_t *h, uint32_t address, uint8_t *buff, int size);
+int nxp_write_mem(nxp_t *h, uint32_t address, const uint8_t *buff, int size);
+
+#endif /* NXPFRAME_H_ */
@@ -0,0 +1,405 @@
+/*
+ * nxpsize.c
+ *
+ * Created on: 18 Oct 2026 (LNP)
+ *
+ * Copyright (c) 2026 Lixco Microsystems <lix@paulian.net>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+/*
+ * Flash and RAM size profiler: reads the linker map file of the firmware,
+ * adds up the size of every input section per object and per module, and
+ * checks the modules against the budgets in size_budget.txt. Build it on the
+ * host with:
+ *
+ *   cc -O2 -o nxpsize nxpsize.c
+ *
+ * The map file is written by the linker when "Generate map" is checked in
+ * the linker settings (or with -Wl,-Map,LPC1114.map). The post-build step
+ * of both configurations runs
+ *
+ *   ../tools/nxpsize -w ${ProjName}.map ../tools/size_budget.txt
+ *
+ * when the tool has been built, and says so otherwise. Without -w the exit
+ * status is 1 when a module grows past its budget, which makes the build
+ * fail; the step only reports until the budgets come from an ARM build.
+ *
+ * Usage: nxpsize [-v] [-u] [-w] mapfile budgetfile
+ *   -v    also list the objects and the 20 largest symbols
+ *   -u    write the current sizes as the new budgets
+ *   -w    only warn, the exit status is 0 even over budget
+ *
+ * With -ffunction-sections and -fdata-sections every function and variable
+ * has its own input section, whose name gives the symbol.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define MAX_LINE 512
+#define MAX_MODULES 16
+#define MAX_PATTERNS 8
+#define MAX_ENTRIES 4096
+#define TOP_SYMBOLS 20
+#define BUDGET_ROUND 64			/* budgets written by -u are rounded up to this */
+
+/* a module, as defined in the budget file */
+typedef struct
+{
+	char name[32];
+	char *patterns[MAX_PATTERNS];	/* object path substrings */
+	int npatterns;
+	unsigned long flash_budget;
+	unsigned long ram_budget;
+	unsigned long flash;
+	unsigned long ram;
+} module_t;
+
+/* an input section */
+typedef struct
+{
+	char symbol[128];			/* see the %.127s in addSection() */
+	char object[256];
+	int module;
+	unsigned long flash;
+	unsigned long ram;
+} entry_t;
+
+static module_t modules[MAX_MODULES];
+static int nmodules;
+static entry_t entries[MAX_ENTRIES];
+static int nentries;
+
+/**
+ * @brief	Read the budget file: one module per line, with its flash and RAM
+ * 			budgets and the path substrings of its objects; the first module
+ * 			whose pattern matches gets the object.
+ * @param	name: file name.
+ * @return	0 on success, -1 otherwise.
+ */
+static int readBudgets(const char *name)
+{
+	char line[MAX_LINE], *tok, *flash, *ram;
+	module_t *m;
+	FILE *f;
+
+	if (!(f = fopen(name, "r")))
+	{
+		perror(name);
+		return -1;
+	}
+	while (fgets(line, sizeof(line), f) && nmodules < MAX_MODULES - 1)
+	{
+		if (!(tok = strtok(line, " \t\r\n")) || *tok == '#')
+			continue;
+		flash = strtok(NULL, " \t\r\n");
+		ram = strtok(NULL, " \t\r\n");
+		if (!flash || !ram)
+			continue;
+		m = &modules[nmodules++];
+		snprintf(m->name, sizeof(m->name), "%s", tok);
+		m->flash_budget = strtoul(flash, NULL, 0);
+		m->ram_budget = strtoul(ram, NULL, 0);
+		while ((tok = strtok(NULL, " \t\r\n")) && m->npatterns < MAX_PATTERNS)
+			m->patterns[m->npatterns++] = strdup(tok);
+	}
+	fclose(f);
+
+	/* catch all for the objects matching no pattern, without budget */
+	snprintf(modules[nmodules].name, sizeof(modules[nmodules].name), "other");
+	nmodules++;
+	return 0;
+}
+
+/**
+ * @brief	Find the module of an object.
+ * @param	object: object path, as written in the map file.
+ * @return	the module index.
+ */
+static int findModule(const char *object)
+{
+	int i, j;
+
+	for (i = 0; i < nmodules - 1; i++)
+	{
+		for (j = 0; j < modules[i].npatterns; j++)
+		{
+			if (strstr(object, modules[i].patterns[j]))
+				return i;
+		}
+	}
+	return nmodules - 1;
+}
+
+/**
+ * @brief	Account an input section.
+ * @param	outsect: output section it is placed in.
+ * @param	insect: input section name.
+ * @param	size: size in bytes.
+ * @param	object: object path.
+ */
+static void addSection(const char *outsect, const char *insect,
+		unsigned long size, const char *object)
+{
+	unsigned long flash = 0, ram = 0;
+	const char *sym;
+	entry_t *e;
+
+	/* .data is stored in flash and copied to RAM */
+	if (!strcmp(outsect, ".text") || !strncmp(outsect, ".ARM.ex", 7))
+		flash = size;
+	else if (!strcmp(outsect, ".data"))
+		flash = ram = size;
+	else if (!strcmp(outsect, ".bss") || !strcmp(outsect, ".noinit")
+			|| !strcmp(outsect, ".uninit_RESERVED"))
+		ram = size;
+	else
+		return;			/* debug information and the like */
+	if (!size || nentries >= MAX_ENTRIES)
+		return;
+
+	/* .text.name, .bss.name... give the symbol, otherwise use the object */
+	if (!strcmp(insect, "*fill*"))
+		sym = "(fill)";
+	else if ((sym = strchr(insect + 1, '.')))
+		sym++;
+	else if (!(sym = strrchr(object, '/')) || !*++sym)
+		sym = object;
+
+	e = &entries[nentries++];
+	snprintf(e->symbol, sizeof(e->symbol), "%.127s", sym);	/* long names are cut */
+	snprintf(e->object, sizeof(e->object), "%s", *object ? object : "(fill)");
+	e->module = findModule(e->object);
+	e->flash = flash;
+	e->ram = ram;
+	modules[e->module].flash += flash;
+	modules[e->module].ram += ram;
+}
+
+/**
+ * @brief	Parse the memory map part of a GNU ld map file. Output sections
+ * 			start in the first column, input sections in the second one;
+ * 			a long section name is followed by its address, size and object
+ * 			on the next line.
+ * @param	name: file name.
+ * @return	0 on success, -1 otherwise.
+ */
+static int readMap(const char *name)
+{
+	char line[MAX_LINE], outsect[64] = "", insect[128] = "", object[256];
+	char *p, *end;
+	unsigned long size;
+	int inmap = 0, pending = 0;
+	FILE *f;
+
+	if (!(f = fopen(name, "r")))
+	{
+		perror(name);
+		return -1;
+	}
+	while (fgets(line, sizeof(line), f))
+	{
+		line[strcspn(line, "\r\n")] = '\0';
+		if (!inmap)
+		{
+			inmap = !strncmp(line, "Linker script and memory map", 28);
+			continue;
+		}
+		if (line[0] == '.')			/* output section */
+		{
+			sscanf(line, "%63s", outsect);
+			pending = 0;
+			continue;
+		}
+		if (line[0] != ' ')
+		{
+			pending = 0;
+			continue;
+		}
+
+		p = line + 1;
+		if (!pending)
+		{
+			/* " .text.name", " COMMON" or " *fill*", not " *(.text*)" */
+			if (*p == ' ' || (*p == '*' && strncmp(p, "*fill*", 6)))
+				continue;
+			sscanf(p, "%127s", insect);
+			p += strlen(insect);
+		}
+		while (*p == ' ')
+			p++;
+		if (!*p)				/* name alone, the rest on the next line */
+		{
+			pending = 1;
+			continue;
+		}
+		pending = 0;
+
+		/* address, size, object */
+		if (strncmp(p, "0x", 2) || !(p = strchr(p, ' ')))
+			continue;
+		while (*p == ' ')
+			p++;
+		if (strncmp(p, "0x", 2))
+			continue;			/* symbol or assignment line */
+		size = strtoul(p, &end, 16);
+		while (*end == ' ')
+			end++;
+		snprintf(object, sizeof(object), "%s", end);
+		addSection(outsect, insect, size, object);
+	}
+	fclose(f);
+	if (!inmap)
+	{
+		fprintf(stderr, "%s: no memory map found\n", name);
+		return -1;
+	}
+	return 0;
+}
+
+/**
+ * @brief	Compare two entries by their total size, largest first.
+ */
+static int bySize(const void *a, const void *b)
+{
+	const entry_t *ea = a, *eb = b;
+	unsigned long sa = ea->flash + ea->ram, sb = eb->flash + eb->ram;
+
+	return sa < sb ? 1 : sa > sb ? -1 : 0;
+}
+
+/**
+ * @brief	List the size of every object.
+ */
+static void listObjects(void)
+{
+	unsigned long flash, ram;
+	int i, j, seen;
+
+	printf("\n%-40s %-10s %8s %8s\n", "Object", "Module", "Flash", "RAM");
+	for (i = 0; i < nentries; i++)
+	{
+		for (seen = 0, j = 0; j < i && !seen; j++)
+			seen = !strcmp(entries[j].object, entries[i].object);
+		if (seen)
+			continue;
+		for (flash = ram = 0, j = i; j < nentries; j++)
+		{
+			if (!strcmp(entries[j].object, entries[i].object))
+			{
+				flash += entries[j].flash;
+				ram += entries[j].ram;
+			}
+		}
+		printf("%-40s %-10s %8lu %8lu\n", entries[i].object,
+				modules[entries[i].module].name, flash, ram);
+	}
+}
+
+/**
+ * @brief	Write the current sizes as the new budgets.
+ * @param	name: budget file name.
+ * @return	0 on success, -1 otherwise.
+ */
+static int writeBudgets(const char *name)
+{
+	FILE *f;
+	int i, j;
+
+	if (!(f = fopen(name, "w")))
+	{
+		perror(name);
+		return -1;
+	}
+	fprintf(f, "# Flash and RAM budgets per module, checked by nxpsize; "
+			"the objects\n# belong to the first module with a matching "
+			"path substring.\n#\n# module\tflash\tram\tpatterns\n");
+	for (i = 0; i < nmodules - 1; i++)
+	{
+		fprintf(f, "%s\t%lu\t%lu\t", modules[i].name,
+				(modules[i].flash + BUDGET_ROUND - 1) / BUDGET_ROUND * BUDGET_ROUND,
+				(modules[i].ram + BUDGET_ROUND - 1) / BUDGET_ROUND * BUDGET_ROUND);
+		for (j = 0; j < modules[i].npatterns; j++)
+			fprintf(f, "%s%s", j ? " " : "", modules[i].patterns[j]);
+		fprintf(f, "\n");
+	}
+	fclose(f);
+	return 0;
+}
+
+int main(int argc, char *argv[])
+{
+	unsigned long flash = 0, ram = 0;
+	int verbose = 0, update = 0, warn = 0, failed = 0, i;
+	module_t *m;
+
+	for (; argc > 1 && argv[1][0] == '-'; argc--, argv++)
+	{
+		if (!strcmp(argv[1], "-v"))
+			verbose = 1;
+		else if (!strcmp(argv[1], "-u"))
+			update = 1;
+		else if (!strcmp(argv[1], "-w"))
+			warn = 1;
+	}
+	if (argc != 3)
+	{
+		fprintf(stderr, "Usage: nxpsize [-v] [-u] [-w] mapfile budgetfile\n");
+		return 2;
+	}
+	if (readBudgets(argv[2]) < 0 || readMap(argv[1]) < 0)
+		return 2;
+
+	printf("%-10s %8s %8s %8s %8s\n", "Module", "Flash", "Budget", "RAM",
+			"Budget");
+	for (i = 0; i < nmodules; i++)
+	{
+		m = &modules[i];
+		printf("%-10s %8lu %8lu %8lu %8lu", m->name, m->flash, m->flash_budget,
+				m->ram, m->ram_budget);
+		if (i < nmodules - 1
+				&& (m->flash > m->flash_budget || m->ram > m->ram_budget))
+		{
+			printf("  over budget");
+			failed = 1;
+		}
+		printf("\n");
+		flash += m->flash;
+		ram += m->ram;
+	}
+	printf("%-10s %8lu %8s %8lu\n", "total", flash, "", ram);
+
+	if (verbose)
+	{
+		listObjects();
+		qsort(entries, nentries, sizeof(entry_t), bySize);
+		printf("\n%-32s %-10s %8s %8s\n", "Symbol", "Module", "Flash", "RAM");
+		for (i = 0; i < nentries && i < TOP_SYMBOLS; i++)
+			printf("%-32s %-10s %8lu %8lu\n", entries[i].symbol,
+					modules[entries[i].module].name, entries[i].flash,
+					entries[i].ram);
+	}
+
+	if (update)
+		return writeBudgets(argv[2]) < 0 ? 2 : 0;
+	return warn ? 0 : failed;
+}
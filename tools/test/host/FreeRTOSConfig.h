@@ -0,0 +1,71 @@
+/*
+ * FreeRTOSConfig.h
+ *
+ * Kernel configuration of the host tests: the target settings, without the
+ * hardware. The scheduler is never started, the tests call the kernel
+ * functions themselves and move the tick with xTaskIncrementTick().
+ *
+ * Created on: 18 Oct 2026 (LNP)
+ *
+ * (c) 2026 Lixco Microsystems <lix@paulian.net>
+ */
+
+#ifndef FREERTOS_CONFIG_H
+#define FREERTOS_CONFIG_H
+
+#include <stdio.h>
+#include <stdlib.h>
+#include "lpc_types.h"			/* SUCCESS, ERROR, TRUE... as on the target */
+
+#define configUSE_PREEMPTION			1
+#define configUSE_IDLE_HOOK				0
+#define configUSE_TICK_HOOK				0
+#define configCPU_CLOCK_HZ				( 48000000UL )
+#define configTICK_RATE_HZ				( ( portTickType ) 1000 )
+#define configMAX_PRIORITIES			( 8 )
+#define configMINIMAL_STACK_SIZE		( ( unsigned short ) 64 )
+#define configTOTAL_HEAP_SIZE			( ( size_t ) (4 * 1024) )
+#define configMAX_TASK_NAME_LEN			( 10 )
+#define configUSE_TRACE_FACILITY		1
+#define configUSE_16_BIT_TICKS			0
+#define configIDLE_SHOULD_YIELD			1
+#define configUSE_MUTEXES				1
+#define configQUEUE_REGISTRY_SIZE		0
+#define configCHECK_FOR_STACK_OVERFLOW	0
+#define configUSE_RECURSIVE_MUTEXES		1
+#define configUSE_MALLOC_FAILED_HOOK	0
+#define configUSE_APPLICATION_TASK_TAG	0
+#define configUSE_COUNTING_SEMAPHORES	1
+#define configGENERATE_RUN_TIME_STATS	0
+#define configUSE_TICKLESS_IDLE			1
+#define configUSE_STATS_FORMATTING_FUNCTIONS 0
+#define configUSE_PORT_OPTIMISED_TASK_SELECTION 0
+#ifndef configUSE_TIMING_WHEEL					/* the tests build both */
+#define configUSE_TIMING_WHEEL			0
+#endif
+#define configTIMING_WHEEL_BITS			4
+
+#define configUSE_CO_ROUTINES 			0
+#define configMAX_CO_ROUTINE_PRIORITIES ( 2 )
+
+#define configUSE_TIMERS				1
+#define configUSE_TICK_TIMERS			1
+#define configTIMER_TASK_ON_DEMAND		1
+#define configTIMER_TASK_PRIORITY		( configMAX_PRIORITIES - 1 )
+#define configTIMER_QUEUE_LENGTH		16
+#define configTIMER_TASK_STACK_DEPTH	( configMINIMAL_STACK_SIZE * 2 )
+
+#define INCLUDE_vTaskPrioritySet		1
+#define INCLUDE_uxTaskPriorityGet		1
+#define INCLUDE_vTaskDelete				1
+#define INCLUDE_vTaskCleanUpResources	1
+#define INCLUDE_vTaskSuspend			1
+#define INCLUDE_vTaskDelayUntil			1
+#define INCLUDE_vTaskDelay				1
+#define INCLUDE_xTaskGetCurrentTaskHandle 1
+
+#define configASSERT( x ) if( ( x ) == 0 ) { printf( "%s:%d: assert %s\n", __FILE__, __LINE__, #x ); exit( 1 ); }
+
+#define RAMFUNC
+
+#endif /* FREERTOS_CONFIG_H */
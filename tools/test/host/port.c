@@ -0,0 +1,40 @@
+/*
+ * port.c
+ *
+ * Host port of the kernel for the tests: the heap is the C library one and
+ * the scheduler never starts.
+ *
+ * Created on: 18 Oct 2026 (LNP)
+ *
+ * (c) 2026 Lixco Microsystems <lix@paulian.net>
+ */
+
+#include <stdlib.h>
+#include "FreeRTOS.h"
+
+void *pvPortMalloc(size_t size)
+{
+	return malloc(size);
+}
+
+void vPortFree(void *pv)
+{
+	free(pv);
+}
+
+StackType_t *pxPortInitialiseStack(StackType_t *pxTopOfStack,
+		TaskFunction_t pxCode, void *pvParameters)
+{
+	(void) pxCode; (void) pvParameters;
+
+	return pxTopOfStack;
+}
+
+BaseType_t xPortStartScheduler(void)
+{
+	return pdFALSE;
+}
+
+void vPortEndScheduler(void)
+{
+}
@@ -0,0 +1,55 @@
+/*
+ * chip.h
+ *
+ * Host replacement of the chip library header for the simulations of the
+ * peripherals (test_can.c, test_adc.c): the C_CAN ROM API is the simulated
+ * one, the CAN controller registers are an array, the ADC and the timer are
+ * register structures set by the tests, and the clock, reset and interrupt
+ * controls do nothing. The tests provide the chip library functions that
+ * aren't inline.
+ *
+ * Created on: 18 Oct 2026 (LNP)
+ *
+ * (c) 2026 Lixco Microsystems <lix@paulian.net>
+ */
+
+#ifndef __CHIP_H_
+#define __CHIP_H_
+
+#include <stdint.h>
+#include "lpc_types.h"
+
+#define __I							volatile const
+#define __O							volatile
+#define __IO						volatile
+
+#include "ccand_11xx.h"
+#include "adc_11xx.h"
+#include "timer_11xx.h"
+
+extern CCAN_API_T simCanApi;
+extern uint32_t simCanRegs[];
+extern int simResets;
+extern LPC_ADC_T simAdc;
+extern LPC_TIMER_T simTimer;
+
+#undef LPC_CCAN_API
+#define LPC_CCAN_API				(&simCanApi)
+#define LPC_CAN0_BASE				((uintptr_t) simCanRegs)
+#define LPC_ADC						(&simAdc)
+#define LPC_TIMER16_0				(&simTimer)
+
+#define SYSCTL_CLOCK_CAN			17
+#define RESET_CAN0					3
+#define CAN_IRQn					13
+#define ADC_IRQn					24
+
+#define Chip_Clock_GetSystemClockRate()		48000000UL
+#define Chip_Clock_EnablePeriphClock(clk)	((void) (clk))
+#define Chip_SYSCTL_PeriphReset(periph)		((void) (periph))
+#define NVIC_EnableIRQ(irq)					((void) (irq))
+#define NVIC_DisableIRQ(irq)				((void) (irq))
+#define NVIC_ClearPendingIRQ(irq)			((void) (irq))
+#define NVIC_SystemReset()					(simResets++)
+
+#endif /* __CHIP_H_ */
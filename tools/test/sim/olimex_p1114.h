@@ -0,0 +1,23 @@
+/*
+ * olimex_p1114.h
+ *
+ * Host replacement of the board header for the simulations of the
+ * peripherals: a board with a C_CAN controller. It brings the simulated
+ * chip header, which the target FreeRTOSConfig.h includes.
+ *
+ * Created on: 18 Oct 2026 (LNP)
+ *
+ * (c) 2026 Lixco Microsystems <lix@paulian.net>
+ */
+
+#ifndef __OLIMEX_P1114_H_
+#define __OLIMEX_P1114_H_
+
+#include "chip.h"
+#include <stdio.h>
+
+#define MS10_DELAY			((portTickType) 10 / portTICK_RATE_MS)
+
+#define BOARD_HAS_CAN 1
+
+#endif /* __OLIMEX_P1114_H_ */
@@ -0,0 +1,370 @@
+/*
+ * test_adc.c
+ *
+ * Host test of the continuous ADC acquisition, on a simulated ADC (sim/):
+ * the test is the converter, it writes the data registers of a scan, with
+ * its overrun flags, then runs the interrupt handler. Checked: the channel
+ * set and the burst mode set up, the scans stored whole and in channel
+ * order, dropped when the ring is full, block reads and in place reads over
+ * the end of the ring, the block time stamps, and the timer triggered mode
+ * with its latency. Built with -DADC_BENCH, it also times the handler and a
+ * consumer on the host ("make bench"). The module source is included, as
+ * the other tests.
+ *
+ * Created on: 18 Oct 2026 (LNP)
+ *
+ * (c) 2026 Lixco Microsystems <lix@paulian.net>
+ */
+
+#include <stdlib.h>
+#include <time.h>
+
+#include "../../src/adc.c"
+#include "timers.h"
+
+#define SIM_CLOCK 48000000
+
+LPC_ADC_T simAdc;
+LPC_TIMER_T simTimer;
+
+/* what the chip library was asked to do */
+static int simAdcOn, simBurst, simTimerOn;
+static uint32_t simChannels, simIntChannels, simRate;
+static ADC_START_MODE_T simStartMode;
+static uint16_t simValue;			/* next converted value */
+
+/**
+ * @brief	Stop the test.
+ * @param	msg: what went wrong.
+ */
+static void fail(const char *msg)
+{
+	printf("test_adc: %s\n", msg);
+	exit(1);
+}
+
+/* the chip library functions used by adc.c */
+
+void Chip_ADC_Init(LPC_ADC_T *pADC, ADC_CLOCK_SETUP_T *ADCSetup)
+{
+	(void) pADC;
+	ADCSetup->adcRate = 400000;
+	ADCSetup->bitsAccuracy = ADC_10BITS;
+	ADCSetup->burstMode = FALSE;
+	simAdcOn = TRUE;
+	simBurst = FALSE;
+	simChannels = simIntChannels = 0;
+	simStartMode = ADC_NO_START;
+}
+
+void Chip_ADC_DeInit(LPC_ADC_T *pADC)
+{
+	(void) pADC;
+	simAdcOn = FALSE;
+}
+
+void Chip_ADC_Int_SetChannelCmd(LPC_ADC_T *pADC, uint8_t channel, FunctionalState NewState)
+{
+	(void) pADC;
+	if (NewState == ENABLE)
+		simIntChannels |= 1 << channel;
+}
+
+void Chip_ADC_SetStartMode(LPC_ADC_T *pADC, ADC_START_MODE_T mode, ADC_EDGE_CFG_T EdgeOption)
+{
+	(void) pADC;
+	(void) EdgeOption;
+	simStartMode = mode;
+}
+
+void Chip_ADC_SetSampleRate(LPC_ADC_T *pADC, ADC_CLOCK_SETUP_T *ADCSetup, uint32_t rate)
+{
+	(void) pADC;
+	ADCSetup->adcRate = rate;
+	simRate = rate;
+}
+
+void Chip_ADC_EnableChannel(LPC_ADC_T *pADC, ADC_CHANNEL_T channel, FunctionalState NewState)
+{
+	(void) pADC;
+	if (NewState == ENABLE)
+		simChannels |= 1 << channel;
+}
+
+void Chip_ADC_SetBurstCmd(LPC_ADC_T *pADC, FunctionalState NewState)
+{
+	(void) pADC;
+	simBurst = NewState == ENABLE;
+}
+
+void Chip_TIMER_Init(LPC_TIMER_T *pTMR)
+{
+	(void) pTMR;
+	simTimerOn = TRUE;
+}
+
+void Chip_TIMER_DeInit(LPC_TIMER_T *pTMR)
+{
+	(void) pTMR;
+	simTimerOn = FALSE;
+}
+
+void Chip_TIMER_Reset(LPC_TIMER_T *pTMR)
+{
+	pTMR->TC = 0;
+}
+
+void Chip_TIMER_ExtMatchControlSet(LPC_TIMER_T *pTMR, int8_t initial_state,
+		TIMER_PIN_MATCH_STATE_T matchState, int8_t matchnum)
+{
+	(void) pTMR;
+	(void) initial_state;
+	if (matchState != TIMER_EXTMATCH_TOGGLE || matchnum != 0)
+		fail("MAT0 doesn't toggle");
+}
+
+/**
+ * @brief	Convert a scan: the channels of the set, in order, get the next
+ * 			values, then the interrupt of the last one is taken.
+ * @param	overrun: channel whose previous result was overwritten, or -1.
+ */
+static void simScan(int overrun)
+{
+	uint32_t *dr = (uint32_t *) simAdc.DR;
+	int ch;
+
+	if (!simAdcOn || !simIntChannels)
+		fail("scan while the ADC is off");
+	for (ch = 0; ch < 8; ch++)
+	{
+		if (simChannels & (1 << ch))
+			dr[ch] = (1UL << 31) | (ch == overrun ? 1UL << 30 : 0)
+					| ((simValue++ & 0x3FF) << 6);
+	}
+	ADC_IRQHandler();
+}
+
+/**
+ * @brief	The task the tick needs, as the idle task on the target.
+ * @param	pvParameters: not used.
+ */
+static void simTask(void *pvParameters)
+{
+	(void) pvParameters;
+}
+
+/**
+ * @brief	Start, set up and rate checks of the burst mode.
+ */
+static void testStart(void)
+{
+	if (adcStart(0, 50000) != ERROR || adcStart(0x07, ADC_MAX_RATE + 1) != ERROR)
+		fail("wrong channels or rate accepted");
+	if (adcStart(0x07, SIM_CLOCK / (ADC_CLOCKS * ADC_MAX_CLKDIV) - 100) != ERROR)
+		fail("a rate under the slowest ADC clock accepted");
+	if (adcStart(0x25, 30000) != SUCCESS)
+		fail("adcStart() failed");
+	if (!simBurst || simChannels != 0x25 || simIntChannels != 0x20
+			|| simRate != 30000 || adcChannels() != 3)
+		fail("wrong ADC set up");
+}
+
+/**
+ * @brief	Scans read whole and in channel order, by blocks and in place,
+ * 			over the end of the ring; a full ring drops the whole scans.
+ */
+static void testRing(void)
+{
+	uint16_t buff[ADC_RING_SIZE], expect = 0;
+	const uint16_t *data;
+	adc_stats_t stats;
+	int i, k, n, got;
+
+	simValue = 0;
+	for (i = 0; i < 10; i++)
+		simScan(i == 4 ? 2 : -1);
+	if (adcRead(buff, 31, 0) != 0)
+		fail("a block read before its samples were converted");
+	if (adcRead(buff, 30, 0) != 30)
+		fail("adcRead() failed");
+	for (i = 0; i < 30; i++)
+	{
+		if (buff[i] != (expect++ & 0x3FF))
+			fail("wrong samples read");
+	}
+
+	/* fill the ring: 85 scans of 3 fit, the next ones are dropped */
+	for (i = 0; i < 90; i++)
+		simScan(-1);
+	adcGetStats(&stats);
+	if (stats.samples != 30 + 85 * 3 || stats.dropped != 5 * 3
+			|| stats.overruns != 1 || stats.level != 255 || stats.peak != 255)
+		fail("wrong statistics of a full ring");
+
+	/* in place, the ring wraps after 256 - 30 samples */
+	n = adcPeek(&data);
+	if (n != ADC_RING_SIZE - 30 || data != &adcRing[30])
+		fail("wrong adcPeek() before the end of the ring");
+	for (i = 0; i < n; i++)
+	{
+		if (data[i] != (expect++ & 0x3FF))
+			fail("wrong samples in place");
+	}
+	adcConsume(n);
+	n = adcPeek(&data);
+	if (n != 29 || data != adcRing)
+		fail("wrong adcPeek() after the end of the ring");
+	for (i = 0; i < n; i++)
+	{
+		if (data[i] != (expect++ & 0x3FF))
+			fail("wrong samples in place");
+	}
+	adcConsume(n);
+	if (adcPeek(&data) != 0)
+		fail("samples left in the ring");
+
+	/* the dropped scans left no hole; blocks across the end of the ring */
+	expect = simValue;
+	for (k = 0; k < 50; k++)
+	{
+		for (i = 0; i < 7; i++)
+			simScan(-1);
+		got = adcRead(buff, 21, 0);
+		for (i = 0; i < got; i++)
+		{
+			if (buff[i] != (expect++ & 0x3FF))
+				fail("wrong samples read across the end of the ring");
+		}
+		if (got != 21)
+			fail("adcRead() failed across the end of the ring");
+	}
+}
+
+/**
+ * @brief	Block time stamps: the tick of the first sample of each block,
+ * 			until the block is overwritten.
+ */
+static void testTimestamps(void)
+{
+	portTickType tick, start = xTaskGetTickCount();
+	uint16_t buff[ADC_RING_SIZE];
+	adc_stats_t stats;
+	uint32_t index;
+	int i;
+
+	if (adcStart(0x01, 50000) != SUCCESS)
+		fail("adcStart() failed");
+	for (i = 0; i < 3 * ADC_BLOCK_SIZE; i++)
+	{
+		simScan(-1);
+		xTaskIncrementTick();
+	}
+	index = adcIndex();
+	if (index != 0 || adcGetTimestamp(index, &tick) != SUCCESS || tick != start)
+		fail("wrong time stamp of the first block");
+	if (adcGetTimestamp(ADC_BLOCK_SIZE + 5, &tick) != SUCCESS
+			|| tick != start + ADC_BLOCK_SIZE)
+		fail("wrong time stamp of the second block");
+	if (adcGetTimestamp(3 * ADC_BLOCK_SIZE, &tick) != ERROR)
+		fail("time stamp of a sample not converted yet");
+	adcRead(buff, 2 * ADC_BLOCK_SIZE, 0);
+
+	/* the ring fills up to the last sample */
+	for (i = 0; i < 230; i++)
+		simScan(-1);
+	adcGetStats(&stats);
+	if (stats.level != ADC_RING_SIZE || stats.dropped != 6)
+		fail("the ring didn't fill up");
+	if (adcGetTimestamp(ADC_BLOCK_SIZE + 5, &tick) != ERROR)
+		fail("time stamp of an overwritten block");
+	adcStop();
+	if (simAdcOn)
+		fail("the ADC is still on");
+}
+
+/**
+ * @brief	Timer triggered conversions: the MAT0 toggle period, the actual
+ * 			rate and the latency from the trigger, in ns.
+ */
+static void testTimed(void)
+{
+	static const uint32_t rates[] = { 1, 100, 8000, 44100, ADC_MAX_RATE };
+	adc_stats_t stats;
+	uint32_t rate, i, half, prescale;
+
+	if (adcStartTimed(8, 1000) || adcStartTimed(0, 0)
+			|| adcStartTimed(0, ADC_MAX_RATE + 1))
+		fail("wrong channel or rate accepted");
+	for (i = 0; i < sizeof(rates) / sizeof(rates[0]); i++)
+	{
+		if (!(rate = adcStartTimed(3, rates[i])))
+			fail("adcStartTimed() failed");
+		prescale = simTimer.PR + 1;
+		half = simTimer.MR[0] + 1;
+		if (half > 0x10000 || rate != SIM_CLOCK / (prescale * half * 2)
+				|| rate * 1000 < rates[i] * 999 || rate * 1000 > rates[i] * 1001)
+			fail("wrong sample rate");
+		if (!simTimerOn || !(simTimer.TCR & 1) || simChannels != 0x08
+				|| simStartMode != ADC_START_ON_CT16B0_MAT0 || simBurst)
+			fail("wrong timer triggered set up");
+	}
+
+	/* 48 MHz, no prescaler at 100 kHz: 48 counts are 1000 ns */
+	simTimer.TC = 48;
+	simScan(-1);
+	simTimer.TC = 96;
+	simScan(-1);
+	adcGetStats(&stats);
+	if (stats.latency_min != 1000 || stats.latency_max != 2000)
+		fail("wrong trigger latency");
+	adcStop();
+	if (simTimerOn || simAdcOn)
+		fail("the timer or the ADC is still on");
+}
+
+#ifdef ADC_BENCH
+/**
+ * @brief	Time the interrupt handler storing scans and a consumer reading
+ * 			them, on the host: the samples per second the ring sustains.
+ */
+static void bench(void)
+{
+	uint16_t buff[ADC_RING_SIZE / 2];
+	struct timespec start, end;
+	volatile uint32_t sink = 0;
+	int i, k, runs = 200000;
+	double ns;
+
+	adcStart(0x0F, 50000);
+	clock_gettime(CLOCK_MONOTONIC, &start);
+	for (i = 0; i < runs; i++)
+	{
+		for (k = 0; k < 8; k++)
+			ADC_IRQHandler();
+		sink += adcRead(buff, 32, 0);
+	}
+	clock_gettime(CLOCK_MONOTONIC, &end);
+	ns = ((end.tv_sec - start.tv_sec) * 1e9 + end.tv_nsec - start.tv_nsec)
+			/ (32.0 * runs);
+	printf("%-22s%8.2f ns/sample, %.1f Msamples/s\n", "adc ISR + adcRead()",
+			ns, 1e3 / ns);
+	adcStop();
+}
+#endif
+
+int main(void)
+{
+	/* the tick timer lists, as vTaskStartScheduler() does */
+	xTimerCreateTimerTask();
+	xTaskCreate(simTask, "sim", configMINIMAL_STACK_SIZE, NULL, tskIDLE_PRIORITY, NULL);
+
+	testStart();
+	testRing();
+	testTimestamps();
+	testTimed();
+	printf("test_adc: ok\n");
+#ifdef ADC_BENCH
+	bench();
+#endif
+	return 0;
+}
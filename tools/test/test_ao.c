@@ -0,0 +1,295 @@
+/*
+ * test_ao.c
+ *
+ * Host test of the active objects: after each step the reference counts of
+ * the pool events are checked against the queues holding them, and the
+ * events no queue holds must be back in the pool. Publishing with no
+ * subscriber, full queues in aoPost() and aoPublish(), the dispatch order
+ * by priority, static events and the time events are covered. The events
+ * are dispatched by the test, and the tick moved by it. The module source
+ * is included, so that the test reaches its static functions and data.
+ *
+ * Created on: 18 Oct 2026 (LNP)
+ *
+ * (c) 2026 Lixco Microsystems <lix@paulian.net>
+ */
+
+#include "../../src/ao.c"
+
+#define SIG_NONE 1				/* no subscriber */
+#define SIG_X 2
+#define SIG_T 3
+#define LOG_SIZE 32
+
+static ao_thread_t thread;
+static ao_t aoA, aoB, aoC;
+static ao_event_t *queueA[2], *queueB[4], *queueC[4];
+
+/* events dispatched: priority of the active object and signal */
+static uint8_t logPrio[LOG_SIZE], logSig[LOG_SIZE];
+static int logCount;
+
+/**
+ * @brief	Stop the test.
+ * @param	msg: what went wrong.
+ */
+static void fail(const char *msg)
+{
+	printf("test_ao: %s\n", msg);
+	exit(1);
+}
+
+/**
+ * @brief	Event handler of the three active objects: log the event, it
+ * 			must still be held.
+ * @param	ao: the active object.
+ * @param	e: the event.
+ */
+static void handler(ao_t *ao, const ao_event_t *e)
+{
+	if (!e->refs)
+		fail("an event was dispatched without a reference");
+	if (logCount >= LOG_SIZE)
+		fail("too many events dispatched");
+	logPrio[logCount] = ao->prio;
+	logSig[logCount] = e->sig;
+	logCount++;
+}
+
+/**
+ * @brief	Check the pool: a free event has no reference and is in no queue,
+ * 			the others have one reference per queue slot holding them,
+ * 			except those held by the test.
+ * @param	held: events taken with aoNew() and not posted yet.
+ */
+static void checkPool(int held)
+{
+	static ao_t * const all[] = { &aoA, &aoB, &aoC };
+	ao_event_t *e;
+	int i, k, n, slots, isFree, unheld = 0;
+
+	for (i = 0; i < AO_POOL_SIZE; i++)
+	{
+		for (isFree = 0, e = aoFree; e; e = e->next)
+			isFree += e == &aoPool[i];
+		if (isFree > 1)
+			fail("an event is twice in the free list");
+
+		for (slots = 0, k = 0; k < 3; k++)
+		{
+			for (n = 0; n < all[k]->count; n++)
+				slots += all[k]->queue[(all[k]->head + n) % all[k]->size]
+						== &aoPool[i];
+		}
+		if (isFree && (slots || aoPool[i].refs))
+			fail("a free event is still referenced");
+		if (!isFree && aoPool[i].refs != slots)
+			fail("wrong reference count");
+		if (!isFree && !slots)
+			unheld++;
+	}
+	if (unheld != held)
+		fail("an event was lost by the pool");
+}
+
+/**
+ * @brief	Take all the events of the pool, then publish them with no
+ * 			subscriber, which returns them.
+ */
+static void testPool(void)
+{
+	ao_event_t *e[AO_POOL_SIZE];
+	int i, k;
+
+	for (i = 0; i < AO_POOL_SIZE; i++)
+	{
+		if (!(e[i] = aoNew(SIG_NONE)))
+			fail("the pool is short of events");
+		for (k = 0; k < i; k++)
+		{
+			if (e[k] == e[i])
+				fail("an event was given twice");
+		}
+	}
+	if (aoNew(SIG_NONE))
+		fail("an event was given by an empty pool");
+	checkPool(AO_POOL_SIZE);
+
+	for (i = 0; i < AO_POOL_SIZE; i++)
+	{
+		if (aoPublish(e[i]) != SUCCESS)
+			fail("publishing with no subscriber failed");
+	}
+	checkPool(0);
+}
+
+/**
+ * @brief	Post to a full queue: the event returns to the pool, unless a
+ * 			queue holds it already.
+ */
+static void testPost(void)
+{
+	ao_event_t *e;
+	int i;
+
+	for (i = 0; i < 2; i++)
+	{
+		if (aoPost(&aoA, aoNew(SIG_X)) != SUCCESS)
+			fail("aoPost() failed");
+	}
+	if (aoPost(&aoA, aoNew(SIG_X)) != ERROR)
+		fail("aoPost() to a full queue succeeded");
+	checkPool(0);
+
+	e = aoNew(SIG_X);
+	if (aoPost(&aoB, e) != SUCCESS || aoPost(&aoA, e) != ERROR)
+		fail("wrong aoPost() result");
+	if (e->refs != 1)
+		fail("a held event lost its reference");
+	checkPool(0);
+
+	aoDispatch(&thread);
+	if (logCount != 3 || logPrio[0] != 3 || logPrio[1] != 1 || logPrio[2] != 1)
+		fail("wrong dispatch order");
+	if (thread.ready)
+		fail("an active object is still ready");
+	checkPool(0);
+	logCount = 0;
+}
+
+/**
+ * @brief	Publish to three subscribers, one of them with a full queue: the
+ * 			others get the event, which returns to the pool after the last
+ * 			one processed it.
+ */
+static void testPublish(void)
+{
+	ao_event_t *e;
+
+	if (aoSubscribe(&aoA, SIG_X) != SUCCESS || aoSubscribe(&aoB, SIG_X)
+			!= SUCCESS || aoSubscribe(&aoC, SIG_X) != SUCCESS)
+		fail("aoSubscribe() failed");
+	if (aoSubscribe(&aoA, AO_MAX_SIGNALS) != ERROR)
+		fail("a signal out of range was subscribed");
+
+	aoPost(&aoA, aoNew(SIG_NONE));
+	aoPost(&aoA, aoNew(SIG_NONE));
+	e = aoNew(SIG_X);
+	if (aoPublish(e) != ERROR)
+		fail("publishing to a full queue succeeded");
+	if (e->refs != 2)
+		fail("wrong references of a published event");
+	checkPool(0);
+
+	aoDispatch(&thread);
+	if (logCount != 4 || logPrio[0] != 5 || logPrio[1] != 3
+			|| logPrio[2] != 1 || logSig[2] != SIG_NONE)
+		fail("wrong dispatch order");
+	checkPool(0);
+
+	/* no subscriber left */
+	aoUnsubscribe(&aoA, SIG_X);
+	aoUnsubscribe(&aoB, SIG_X);
+	aoUnsubscribe(&aoC, SIG_X);
+	if (aoPublish(aoNew(SIG_X)) != SUCCESS || thread.ready)
+		fail("an event was published to no subscriber");
+	checkPool(0);
+	logCount = 0;
+}
+
+/**
+ * @brief	Static events are never counted nor recycled, even several times
+ * 			in a queue or rejected by a full queue.
+ */
+static void testStatic(void)
+{
+	static ao_event_t st = { .sig = SIG_X, .refs = AO_STATIC };
+
+	if (aoPost(&aoA, &st) != SUCCESS || aoPost(&aoA, &st) != SUCCESS)
+		fail("aoPost() of a static event failed");
+	if (aoPost(&aoA, &st) != ERROR)
+		fail("aoPost() to a full queue succeeded");
+	aoSubscribe(&aoB, SIG_X);
+	if (aoPublish(&st) != SUCCESS)
+		fail("publishing a static event failed");
+	aoUnsubscribe(&aoB, SIG_X);
+	if (st.refs != AO_STATIC)
+		fail("a static event was counted");
+	checkPool(0);
+
+	aoDispatch(&thread);
+	if (logCount != 3 || st.refs != AO_STATIC)
+		fail("static events not dispatched");
+	checkPool(0);
+	logCount = 0;
+}
+
+/**
+ * @brief	Time events: a periodic one posts its event every period until
+ * 			disarmed, a one shot one posts it once.
+ */
+static void testTime(void)
+{
+	ao_time_t periodic, once;
+	int i;
+
+	if (aoTimeInit(&periodic, &aoC, SIG_T, TRUE) != SUCCESS
+			|| aoTimeInit(&once, &aoB, SIG_T, FALSE) != SUCCESS)
+		fail("aoTimeInit() failed");
+	if (aoTimeArm(&periodic, 0) != ERROR)
+		fail("a time event was armed for 0 tick");
+	if (aoTimeArm(&periodic, 3) != SUCCESS || aoTimeArm(&once, 5) != SUCCESS)
+		fail("aoTimeArm() failed");
+
+	/* not dispatched for a few ticks, so that the periodic event of ticks
+	 * 6 and 9 is twice in the queue */
+	for (i = 1; i <= 12; i++)
+	{
+		xTaskIncrementTick();
+		if (i == 9 && aoC.count != 2)
+			fail("the periodic time event wasn't queued twice");
+		if (i < 6 || i > 8)
+			aoDispatch(&thread);
+	}
+	if (logCount != 5)
+		fail("wrong number of time events");
+	for (i = 0; i < logCount; i++)
+	{
+		if (logSig[i] != SIG_T)
+			fail("wrong time event signal");
+	}
+
+	aoTimeDisarm(&periodic);
+	for (i = 0; i < 12; i++)
+	{
+		xTaskIncrementTick();
+		aoDispatch(&thread);
+	}
+	if (logCount != 5 || periodic.event.refs != AO_STATIC)
+		fail("a disarmed time event was posted");
+	checkPool(0);
+}
+
+int main(void)
+{
+	/* the tick timer lists, as vTaskStartScheduler() does */
+	xTimerCreateTimerTask();
+	aoInit();
+	if (aoThreadInit(&thread, tskIDLE_PRIORITY + 2, configMINIMAL_STACK_SIZE)
+			!= SUCCESS)
+		fail("aoThreadInit() failed");
+	if (aoStart(&aoA, 1, handler, queueA, 2, &thread) != SUCCESS
+			|| aoStart(&aoB, 3, handler, queueB, 4, &thread) != SUCCESS
+			|| aoStart(&aoC, 5, handler, queueC, 4, &thread) != SUCCESS)
+		fail("aoStart() failed");
+	if (aoStart(&aoA, 1, handler, queueA, 2, &thread) != ERROR)
+		fail("a priority was taken twice");
+
+	testPool();
+	testPost();
+	testPublish();
+	testStatic();
+	testTime();
+	printf("test_ao: ok\n");
+	return 0;
+}
@@ -0,0 +1,321 @@
+/*
+ * test_args.c
+ *
+ * Host fuzz test of the CLI argument parser: numbers against a reference
+ * conversion (malformed, overlong, out of 32 bits), then random command
+ * lines of valid, malformed and out of range words, and too many
+ * arguments, against specifications like those of the CLI. The results
+ * must follow the specification, and the parser must not write past the
+ * ARGS_MAX values (the test runs under the address sanitizer). Built with
+ * -DARGS_BENCH, it also times the parsing of typical command lines ("make
+ * bench"). The module source is included, as the other tests.
+ *
+ * Created on: 18 Oct 2026 (LNP)
+ *
+ * (c) 2026 Lixco Microsystems <lix@paulian.net>
+ */
+
+#include <stdlib.h>
+#include <time.h>
+
+#include "../../src/args.c"
+
+#define FUZZ_NUMBERS 2000000
+#define FUZZ_LINES 1000000
+#define MAX_WORDS 10
+#define CANARY 0xA5
+
+static const char * const actions[] = { "start", "stop", "timed", NULL };
+
+static const arg_spec_t dumpSpec[] =
+{
+		{ "-b", ARG_FLAG, TRUE, 0, 0, NULL },
+		{ "start", ARG_HEX, FALSE, 0, 0xFFFFFFFF, NULL },
+		{ "size", ARG_HEX, TRUE, 1, 0x10000, NULL },
+		{ NULL }
+};
+
+static const arg_spec_t adcSpec[] =
+{
+		{ "action", ARG_ENUM, TRUE, 0, 0, actions },
+		{ "channels", ARG_HEX, TRUE, 0x01, 0xFF, NULL },
+		{ "rate", ARG_DEC, TRUE, 1, 100000, NULL },
+		{ NULL }
+};
+
+static const arg_spec_t dateSpec[] =
+{
+		{ "year", ARG_DEC, TRUE, 2000, 2099, NULL },
+		{ "month", ARG_DEC, TRUE, 1, 12, NULL },
+		{ "day", ARG_DEC, TRUE, 1, 31, NULL },
+		{ "hour", ARG_DEC, TRUE, 0, 23, NULL },
+		{ "min", ARG_DEC, TRUE, 0, 59, NULL },
+		{ "sec", ARG_DEC, TRUE, 0, 59, NULL },
+		{ NULL }
+};
+
+static const arg_spec_t * const specs[] = { dumpSpec, adcSpec, dateSpec };
+
+/* words of the random command lines */
+static const char * const words[] =
+{
+		"-b", "-h", "-x", "", "0", "1", "12", "59", "60", "2026", "99999",
+		"100001", "0x10000", "0x10001", "0xFF", "0x", "0X1f", "ff", "FFFFFFFF",
+		"4294967295", "4294967296", "99999999999", "0xFFFFFFFF", "0x100000000",
+		"0000000000000000000000000000000000000000000000000000000000000017",
+		"12a", "1 2", "+1", "-1", "start", "stop", "timed", "Start", "starts",
+		"\xff\xfe", NULL
+};
+
+static uint64_t rng = 88172645463325252ULL;
+
+/**
+ * @brief	Stop the test.
+ * @param	msg: what went wrong.
+ */
+static void fail(const char *msg)
+{
+	printf("test_args: %s\n", msg);
+	exit(1);
+}
+
+/**
+ * @brief	Pseudo random numbers, xorshift.
+ * @return	the next number.
+ */
+static uint32_t rnd(void)
+{
+	rng ^= rng << 13;
+	rng ^= rng >> 7;
+	rng ^= rng << 17;
+	return (uint32_t) rng;
+}
+
+/**
+ * @brief	Reference conversion of a number, in 64 bits.
+ * @param	str: the string.
+ * @param	base: 10 or 16; in base 10, a "0x" prefix selects base 16.
+ * @param	value: pointer to return the number.
+ * @return	SUCCESS or ERROR, as argNumber().
+ */
+static int refNumber(const char *str, int base, uint32_t *value)
+{
+	uint64_t n = 0;
+	int digit;
+
+	if (str[0] == '0' && (str[1] == 'x' || str[1] == 'X'))
+	{
+		base = 16;
+		str += 2;
+	}
+	if (!*str)
+		return ERROR;
+	for (; *str; str++)
+	{
+		if (*str >= '0' && *str <= '9')
+			digit = *str - '0';
+		else if (base == 16 && *str >= 'a' && *str <= 'f')
+			digit = *str - 'a' + 10;
+		else if (base == 16 && *str >= 'A' && *str <= 'F')
+			digit = *str - 'A' + 10;
+		else
+			return ERROR;
+		n = n * base + digit;
+		if (n > 0xFFFFFFFF)
+			return ERROR;
+	}
+	*value = n;
+	return SUCCESS;
+}
+
+/**
+ * @brief	Random numbers, as strings of digits, hex digits and a few other
+ * 			characters, of 0 to 24 characters, against the reference.
+ */
+static void testNumbers(void)
+{
+	static const char chars[] = "0000000123456789abcdefABCDEFxX -+g";
+	char str[32];
+	uint32_t got, want;
+	int i, k, len, base, res;
+
+	for (i = 0; i < FUZZ_NUMBERS; i++)
+	{
+		len = rnd() % 25;
+		for (k = 0; k < len; k++)
+		{
+			/* mostly digits, so that many are valid */
+			str[k] = rnd() % 4 ? (char) ('0' + rnd() % 10)
+					: chars[rnd() % (sizeof(chars) - 1)];
+		}
+		str[len] = 0;
+		if (rnd() % 8 == 0 && len > 2)
+		{
+			str[0] = '0';
+			str[1] = 'x';
+		}
+		base = rnd() & 1 ? 16 : 10;
+		got = want = 0x12345678;
+		res = argNumber(str, base, &got);
+		if (res != refNumber(str, base, &want) || got != want)
+		{
+			printf("test_args: \"%s\" base %d\n", str, base);
+			fail("number converted wrong");
+		}
+	}
+}
+
+/**
+ * @brief	Check the values of a successful parse against the specification.
+ * @param	spec: the specification.
+ * @param	argc: arguments count.
+ * @param	argv: arguments list.
+ * @param	values: the values.
+ */
+static void checkValues(const arg_spec_t *spec, int argc, char *argv[],
+		const arg_value_t *values)
+{
+	int k, i, given = 0;
+
+	for (k = 0; spec[k].name; k++)
+	{
+		if (!spec[k].optional && !values[k].present)
+			fail("a mandatory argument is missing");
+		if (!values[k].present)
+			continue;
+		given++;
+		for (i = 0; i < argc && argv[i] != values[k].str; i++)
+			;
+		if (i == argc)
+			fail("a value doesn't point to its argument");
+		if ((spec[k].type == ARG_DEC || spec[k].type == ARG_HEX)
+				&& (values[k].num < spec[k].min || values[k].num > spec[k].max))
+			fail("a number out of range was accepted");
+		if (spec[k].type == ARG_ENUM && strcmp(values[k].str,
+				spec[k].choices[values[k].num]))
+			fail("wrong word index");
+		if (spec[k].type == ARG_FLAG && strcmp(values[k].str, spec[k].name))
+			fail("wrong option");
+	}
+	/* an option can be repeated, the others can't */
+	if (given > argc)
+		fail("more values than arguments");
+}
+
+/**
+ * @brief	Random command lines against the specifications; nothing is
+ * 			written past the ARGS_MAX values.
+ */
+static void testLines(void)
+{
+	arg_value_t values[ARGS_MAX + 2];
+	char *argv[MAX_WORDS];
+	const arg_spec_t *spec;
+	uint8_t *canary;
+	int i, k, argc, res, help, nspec;
+
+	for (i = 0; i < FUZZ_LINES; i++)
+	{
+		spec = specs[rnd() % (sizeof(specs) / sizeof(specs[0]))];
+		for (nspec = 0; spec[nspec].name; nspec++)
+			;
+		argc = rnd() % MAX_WORDS;
+		for (k = 0; k < argc; k++)
+			argv[k] = (char *) words[rnd() % (sizeof(words) / sizeof(words[0]) - 1)];
+		memset(values, CANARY, sizeof(values));
+
+		res = argsParse(spec, argc, argv, values);
+		canary = (uint8_t *) &values[ARGS_MAX];
+		for (k = 0; k < (int) (2 * sizeof(arg_value_t)); k++)
+		{
+			if (canary[k] != CANARY)
+				fail("a value was written past ARGS_MAX");
+		}
+
+		help = argc && !strcmp(argv[0], "-h");
+		if (help && res != ARGS_HELP)
+			fail("\"-h\" first wasn't taken as a help request");
+		if (res == SUCCESS)
+			checkValues(spec, argc, argv, values);
+		else if (res != ERROR && res != ARGS_HELP)
+			fail("unknown result");
+
+		/* more positional arguments than specified */
+		if (res == SUCCESS && argc < MAX_WORDS)
+		{
+			for (k = 0; k < nspec && spec[k].type != ARG_FLAG; k++)
+				;
+			argv[argc] = "1";
+			if (k == nspec && argc == nspec
+					&& argsParse(spec, argc + 1, argv, values) != ERROR)
+				fail("too many arguments were accepted");
+		}
+	}
+}
+
+/**
+ * @brief	A few lines with a known result.
+ */
+static void testCases(void)
+{
+	static char *date[] = { "2026", "10", "18", "12", "30", "59", "1" };
+	static char *dump[] = { "1000", "-b", "0x10000", "-b" };
+	static char *adc[] = { "timed", "0x", "100" };
+	arg_value_t values[ARGS_MAX];
+
+	if (argsParse(dateSpec, 6, date, values) != SUCCESS || values[0].num != 2026
+			|| values[5].num != 59)
+		fail("date line rejected");
+	if (argsParse(dateSpec, 7, date, values) != ERROR)
+		fail("too many date arguments accepted");
+	date[1] = "13";
+	if (argsParse(dateSpec, 6, date, values) != ERROR)
+		fail("month 13 accepted");
+	if (argsParse(dumpSpec, 4, dump, values) != SUCCESS || !values[0].present
+			|| values[1].num != 0x1000 || values[2].num != 0x10000)
+		fail("dump line rejected");
+	if (argsParse(dumpSpec, 1, dump + 1, values) != ERROR)
+		fail("missing mandatory argument accepted");
+	if (argsParse(adcSpec, 1, adc, values) != SUCCESS || values[0].num != 2)
+		fail("adc line rejected");
+	if (argsParse(adcSpec, 3, adc, values) != ERROR)
+		fail("malformed number accepted");
+}
+
+#ifdef ARGS_BENCH
+/**
+ * @brief	Time the parsing of typical command lines, on the host.
+ */
+static void bench(void)
+{
+	static char *date[] = { "2026", "10", "18", "12", "30", "59" };
+	static char *dump[] = { "-b", "0x10000000", "100" };
+	arg_value_t values[ARGS_MAX];
+	struct timespec start, end;
+	volatile int sink = 0;
+	int i, runs = 2000000;
+
+	clock_gettime(CLOCK_MONOTONIC, &start);
+	for (i = 0; i < runs; i++)
+	{
+		sink += argsParse(dateSpec, 6, date, values);
+		sink += argsParse(dumpSpec, 3, dump, values);
+	}
+	clock_gettime(CLOCK_MONOTONIC, &end);
+	printf("%-22s%8.2f ns/line\n", "argsParse()",
+			((end.tv_sec - start.tv_sec) * 1e9 + end.tv_nsec - start.tv_nsec)
+			/ (2.0 * runs));
+}
+#endif
+
+int main(void)
+{
+	testCases();
+	testNumbers();
+	testLines();
+	printf("test_args: ok\n");
+#ifdef ARGS_BENCH
+	bench();
+#endif
+	return 0;
+}
@@ -0,0 +1,902 @@
+/*
+ * test_can.c
+ *
+ * Host simulation of the CAN driver and of the CANopen node on a virtual
+ * bus. The LPC11Cxx ROM C_CAN API is simulated (sim/chip.h): message
+ * objects with their acceptance filters, one transmit object completing on
+ * the bus, error events, and an SDO server using the node object
+ * dictionary and callbacks as the ROM one does. A simulated master then
+ * drives the node: NMT commands, SYNC, PDOs, expedited and segmented SDO
+ * transfers, with the heartbeat and the PDO timing checked against the
+ * tick. The driver is checked alone first: bit timing, transmission in the
+ * order of the identifiers, receive buffers, bus off and bus load.
+ *
+ * The sources are built with BOARD_HAS_CAN 1 and included, so that the test
+ * reaches their static functions and data; the node task is run one pass at
+ * a time, while the test moves the tick.
+ *
+ * Created on: 18 Oct 2026 (LNP)
+ *
+ * (c) 2026 Lixco Microsystems <lix@paulian.net>
+ */
+
+#include "../../src/can.c"
+#include "../../src/canopen.c"
+#include "timers.h"
+
+#define BUS_LOG 256
+#define COB_SDO_RX 0x600
+#define COB_SDO_TX 0x580
+
+/* SDO command specifiers */
+#define SDO_DOWNLOAD_SEG 0x00
+#define SDO_DOWNLOAD 0x20
+#define SDO_UPLOAD 0x40
+#define SDO_UPLOAD_SEG 0x60
+#define SDO_ABORT 0x80
+#define SDO_TOGGLE 0x10
+
+/* simulated controller */
+CCAN_API_T simCanApi;
+uint32_t simCanRegs[64];
+int simResets;
+
+static CCAN_CALLBACKS_T *romCallbacks;
+static CCAN_MSG_OBJ_T romFilter[CAN_MSGOBJ_NUM];
+static uint32_t romFilterUsed;			/* bitmap of the receive objects */
+static CCAN_MSG_OBJ_T romRx[CAN_MSGOBJ_NUM];
+static uint32_t romRxPending;			/* objects with a new frame */
+static CCAN_MSG_OBJ_T romTx;
+static int romTxPending, romTxDone;
+static uint32_t romErrorInfo;
+static uint32_t romCanCfg[2];
+static CCAN_CANOPENCFG_T *romCanopen;
+static CCAN_MSG_OBJ_T romSdoReq;
+static int romSdoPending;
+
+/* SDO server state */
+static int sdoMode;						/* 0, SDO_UPLOAD or SDO_DOWNLOAD */
+static uint8_t sdoToggle;
+static uint16_t sdoIndex;
+static uint8_t sdoSub;
+
+/* frames sent by the node, in their order on the bus */
+static CCAN_MSG_OBJ_T busLog[BUS_LOG];
+static int busCount;
+
+/**
+ * @brief	Stop the test.
+ * @param	msg: what went wrong.
+ */
+static void fail(const char *msg)
+{
+	printf("test_can: %s (tick %u)\n", msg, (unsigned) xTaskGetTickCount());
+	exit(1);
+}
+
+/**
+ * @brief	Put a frame sent by the node in the bus log.
+ * @param	msg: the frame.
+ */
+static void busPut(const CCAN_MSG_OBJ_T *msg)
+{
+	if (busCount >= BUS_LOG)
+		fail("bus log full");
+	busLog[busCount++] = *msg;
+}
+
+/**
+ * @brief	Send an SDO response of the simulated server.
+ * @param	data: the 8 bytes of the response.
+ */
+static void sdoRespond(const uint8_t *data)
+{
+	CCAN_MSG_OBJ_T msg;
+
+	msg.mode_id = (COB_SDO_TX + romCanopen->node_id) | CAN_MSGOBJ_STD;
+	msg.dlc = 8;
+	msg.msgobj = romCanopen->msgobj_tx;
+	memcpy(msg.data, data, 8);
+	busPut(&msg);
+}
+
+/**
+ * @brief	Send an SDO abort.
+ * @param	code: the abort code.
+ */
+static void sdoAbort(uint32_t code)
+{
+	uint8_t resp[8] = { SDO_ABORT, sdoIndex, sdoIndex >> 8, sdoSub,
+			code, code >> 8, code >> 16, code >> 24 };
+
+	sdoMode = 0;
+	sdoRespond(resp);
+}
+
+/**
+ * @brief	Serve an SDO request from the object dictionary of the node, as
+ * 			the ROM server does: the expedited objects are read and written
+ * 			directly, after the write callback accepted the value, the
+ * 			segmented ones through the segment callbacks.
+ * @param	req: the request.
+ */
+static void sdoServe(const CCAN_MSG_OBJ_T *req)
+{
+	const CCAN_ODCONSTENTRY_T *cst = NULL;
+	const CCAN_ODENTRY_T *ent = NULL;
+	uint8_t resp[8] = { 0 }, cmd = req->data[0], type = 0, len, last;
+	uint32_t i, code;
+
+	if ((cmd & 0xE0) == SDO_ABORT)
+	{
+		sdoMode = 0;
+		return;
+	}
+	if ((cmd & 0xE0) == SDO_UPLOAD || (cmd & 0xE0) == SDO_DOWNLOAD)
+	{
+		sdoIndex = req->data[1] | (req->data[2] << 8);
+		sdoSub = req->data[3];
+		for (i = 0; i < romCanopen->od_const_num; i++)
+		{
+			if (romCanopen->od_const_table[i].index == sdoIndex
+					&& romCanopen->od_const_table[i].subindex == sdoSub)
+				cst = &romCanopen->od_const_table[i];
+		}
+		for (i = 0; i < romCanopen->od_num; i++)
+		{
+			if (romCanopen->od_table[i].index == sdoIndex
+					&& romCanopen->od_table[i].subindex == sdoSub)
+				ent = &romCanopen->od_table[i];
+		}
+		if (!cst && !ent)
+		{
+			sdoAbort(SDO_ABORT_NOT_EXISTS);
+			return;
+		}
+		type = ent ? ent->entrytype_len & 0xF0 : OD_EXP_RO;
+	}
+	resp[1] = sdoIndex;
+	resp[2] = sdoIndex >> 8;
+	resp[3] = sdoSub;
+
+	switch (cmd & 0xE0)
+	{
+	case SDO_UPLOAD:
+		if (type == OD_EXP_WO || type == OD_SEG_WO)
+		{
+			sdoAbort(SDO_ABORT_WRITEONLY);
+			return;
+		}
+		if (cst)
+		{
+			resp[0] = 0x43 | ((4 - cst->len) << 2);
+			memcpy(resp + 4, &cst->val, cst->len);
+		}
+		else if (type <= OD_EXP_RW)
+		{
+			len = ent->entrytype_len & 0x0F;
+			resp[0] = 0x43 | ((4 - len) << 2);
+			memcpy(resp + 4, ent->val, len);
+		}
+		else
+		{
+			if ((code = romCallbacks->CANOPEN_sdo_seg_read(sdoIndex, sdoSub,
+					CAN_SDOSEG_OPEN, &len, NULL, &last)))
+			{
+				sdoAbort(code);
+				return;
+			}
+			sdoMode = SDO_UPLOAD;
+			sdoToggle = 0;
+			resp[0] = 0x40;
+		}
+		break;
+
+	case SDO_UPLOAD_SEG:
+		if (sdoMode != SDO_UPLOAD || (cmd & SDO_TOGGLE) != sdoToggle)
+		{
+			sdoAbort(sdoMode != SDO_UPLOAD ? SDO_ABORT_UNKNOWN_COMMAND
+					: SDO_ABORT_TOGGLE);
+			return;
+		}
+		last = FALSE;
+		if ((code = romCallbacks->CANOPEN_sdo_seg_read(sdoIndex, sdoSub,
+				CAN_SDOSEG_SEGMENT, &len, resp + 1, &last)))
+		{
+			sdoAbort(code);
+			return;
+		}
+		resp[0] = sdoToggle | ((7 - len) << 1) | (last ? 1 : 0);
+		sdoToggle ^= SDO_TOGGLE;
+		if (last)
+		{
+			romCallbacks->CANOPEN_sdo_seg_read(sdoIndex, sdoSub,
+					CAN_SDOSEG_CLOSE, &len, NULL, &last);
+			sdoMode = 0;
+		}
+		break;
+
+	case SDO_DOWNLOAD:
+		if (type != OD_EXP_WO && type != OD_EXP_RW && type != OD_SEG_WO
+				&& type != OD_SEG_RW)
+		{
+			sdoAbort(SDO_ABORT_READONLY);
+			return;
+		}
+		if (cmd & 0x02)			/* expedited */
+		{
+			len = (cmd & 0x01) ? 4 - ((cmd >> 2) & 3) : 4;
+			if (type >= OD_SEG_RO || len != (ent->entrytype_len & 0x0F))
+			{
+				sdoAbort(SDO_ABORT_TYPEMISMATCH);
+				return;
+			}
+			if (romCallbacks->CANOPEN_sdo_write && (code
+					= romCallbacks->CANOPEN_sdo_write(sdoIndex, sdoSub,
+					(uint8_t *) req->data + 4)))
+			{
+				sdoAbort(code);
+				return;
+			}
+			memcpy(ent->val, req->data + 4, len);
+		}
+		else
+		{
+			if (type < OD_SEG_RO)
+			{
+				sdoAbort(SDO_ABORT_TYPEMISMATCH);
+				return;
+			}
+			if ((code = romCallbacks->CANOPEN_sdo_seg_write(sdoIndex, sdoSub,
+					CAN_SDOSEG_OPEN, 0, NULL, NULL)))
+			{
+				sdoAbort(code);
+				return;
+			}
+			sdoMode = SDO_DOWNLOAD;
+			sdoToggle = 0;
+		}
+		resp[0] = 0x60;
+		break;
+
+	case SDO_DOWNLOAD_SEG:
+		if (sdoMode != SDO_DOWNLOAD || (cmd & SDO_TOGGLE) != sdoToggle)
+		{
+			sdoAbort(sdoMode != SDO_DOWNLOAD ? SDO_ABORT_UNKNOWN_COMMAND
+					: SDO_ABORT_TOGGLE);
+			return;
+		}
+		len = 7 - ((cmd >> 1) & 7);
+		if ((code = romCallbacks->CANOPEN_sdo_seg_write(sdoIndex, sdoSub,
+				CAN_SDOSEG_SEGMENT, len, (uint8_t *) req->data + 1, NULL)))
+		{
+			sdoAbort(code);
+			return;
+		}
+		memset(resp, 0, sizeof(resp));
+		resp[0] = 0x20 | sdoToggle;
+		sdoToggle ^= SDO_TOGGLE;
+		if (cmd & 0x01)
+		{
+			romCallbacks->CANOPEN_sdo_seg_write(sdoIndex, sdoSub,
+					CAN_SDOSEG_CLOSE, 0, NULL, NULL);
+			sdoMode = 0;
+		}
+		break;
+
+	default:
+		sdoAbort(SDO_ABORT_UNKNOWN_COMMAND);
+		return;
+	}
+	sdoRespond(resp);
+}
+
+/* the simulated ROM API */
+
+static void romInitCan(uint32_t *can_cfg, uint8_t isr_ena)
+{
+	(void) isr_ena;
+	romCanCfg[0] = can_cfg[0];
+	romCanCfg[1] = can_cfg[1];
+}
+
+static void romIsr(void)
+{
+	int i;
+
+	if (romErrorInfo)
+	{
+		romCallbacks->CAN_error(romErrorInfo);
+		romErrorInfo = 0;
+	}
+	if (romSdoPending)
+	{
+		romSdoPending = FALSE;
+		sdoServe(&romSdoReq);
+	}
+	for (i = 0; i < CAN_MSGOBJ_NUM; i++)
+	{
+		if (romRxPending & (1UL << i))
+		{
+			romRxPending &= ~(1UL << i);
+			romCallbacks->CAN_rx(i);
+		}
+	}
+	if (romTxDone)
+	{
+		romTxDone = FALSE;
+		romCallbacks->CAN_tx(CAN_TX_MSGOBJ);
+	}
+}
+
+static void romConfigRx(CCAN_MSG_OBJ_T *msg_obj)
+{
+	romFilter[msg_obj->msgobj] = *msg_obj;
+	romFilterUsed |= 1UL << msg_obj->msgobj;
+}
+
+static uint8_t romReceive(CCAN_MSG_OBJ_T *msg_obj)
+{
+	*msg_obj = romRx[msg_obj->msgobj];
+	return TRUE;
+}
+
+static void romTransmit(CCAN_MSG_OBJ_T *msg_obj)
+{
+	if (romTxPending)
+		fail("frame loaded in a busy message object");
+	romTx = *msg_obj;
+	romTxPending = TRUE;
+}
+
+static void romConfigCanopen(CCAN_CANOPENCFG_T *canopen_cfg)
+{
+	romCanopen = canopen_cfg;
+}
+
+static void romConfigCalb(CCAN_CALLBACKS_T *callback_cfg)
+{
+	romCallbacks = callback_cfg;
+}
+
+CCAN_API_T simCanApi =
+{
+		romInitCan, romIsr, romConfigRx, romReceive, romTransmit,
+		romConfigCanopen, NULL, romConfigCalb
+};
+
+/**
+ * @brief	Complete the transmissions: the frame of the transmit object goes
+ * 			on the bus, then the interrupt lets the driver load the next one.
+ */
+static void busRun(void)
+{
+	while (romTxPending)
+	{
+		busPut(&romTx);
+		romTxPending = FALSE;
+		romTxDone = TRUE;
+		CAN_IRQHandler();
+	}
+}
+
+/**
+ * @brief	Send a frame from the master: the SDO server takes its requests,
+ * 			the other frames go to the first message object whose filter
+ * 			accepts them, if any.
+ * @param	mode_id: identifier and flags.
+ * @param	data: frame data.
+ * @param	dlc: data length.
+ */
+static void masterSend(uint32_t mode_id, const uint8_t *data, uint8_t dlc)
+{
+	CCAN_MSG_OBJ_T msg;
+	int i;
+
+	msg.mode_id = mode_id;
+	msg.mask = 0;
+	msg.dlc = dlc;
+	memset(msg.data, 0, 8);
+	if (dlc)
+		memcpy(msg.data, data, dlc);
+
+	if (romCanopen && mode_id == ((COB_SDO_RX + romCanopen->node_id) | CAN_MSGOBJ_STD))
+	{
+		romSdoReq = msg;
+		romSdoPending = TRUE;
+	}
+	else
+	{
+		for (i = 0; i < CAN_MSGOBJ_NUM; i++)
+		{
+			if ((romFilterUsed & (1UL << i))
+					&& ((mode_id ^ romFilter[i].mode_id) & CAN_MSGOBJ_EXT) == 0
+					&& ((mode_id ^ romFilter[i].mode_id) & romFilter[i].mask) == 0)
+				break;
+		}
+		if (i == CAN_MSGOBJ_NUM)
+			return;				/* no acceptance filter */
+		msg.msgobj = i;
+		romRx[i] = msg;
+		romRxPending |= 1UL << i;
+	}
+	CAN_IRQHandler();
+	busRun();
+}
+
+/**
+ * @brief	Run the node task until it would block, as after its wake-up.
+ */
+static void nodeStep(void)
+{
+	can_msg_t *msg;
+
+	for (;;)
+	{
+		canopenTimers();
+		busRun();
+		if (xQueueReceive(canopenQueue, &msg, 0) != pdTRUE)
+			break;
+		if (msg)
+		{
+			canopenReceive(msg);
+			canRelease(msg);
+		}
+	}
+	busRun();
+}
+
+/**
+ * @brief	Run the node for a number of ticks.
+ * @param	ticks: number of ticks.
+ */
+static void runTicks(int ticks)
+{
+	while (ticks--)
+	{
+		nodeStep();
+		xTaskIncrementTick();
+	}
+}
+
+/**
+ * @brief	Count the frames of an identifier in the bus log.
+ * @param	id: the identifier.
+ * @return	the number of frames.
+ */
+static int busFrames(uint32_t id)
+{
+	int i, n = 0;
+
+	for (i = 0; i < busCount; i++)
+		n += (busLog[i].mode_id & 0x1FFFFFFF) == id;
+	return n;
+}
+
+/**
+ * @brief	Send an SDO request and get the response.
+ * @param	req: the 8 bytes of the request.
+ * @param	resp: the 8 bytes of the response.
+ */
+static void sdoRequest(const uint8_t *req, uint8_t *resp)
+{
+	int i;
+
+	busCount = 0;
+	masterSend(COB_SDO_RX + CANOPEN_NODE_ID, req, 8);
+	for (i = 0; i < busCount && (busLog[i].mode_id & 0x7FF)
+			!= COB_SDO_TX + CANOPEN_NODE_ID; i++)
+		;
+	if (i == busCount)
+		fail("no SDO response");
+	memcpy(resp, busLog[i].data, 8);
+}
+
+/**
+ * @brief	Expedited SDO upload.
+ * @param	index: object index.
+ * @param	sub: object subindex.
+ * @param	value: pointer to return the value.
+ * @return	0 or the abort code.
+ */
+static uint32_t sdoRead(uint16_t index, uint8_t sub, uint32_t *value)
+{
+	uint8_t req[8] = { SDO_UPLOAD, index, index >> 8, sub }, resp[8];
+
+	sdoRequest(req, resp);
+	if (resp[0] == SDO_ABORT)
+		return resp[4] | (resp[5] << 8) | (resp[6] << 16) | ((uint32_t) resp[7] << 24);
+	if ((resp[0] & 0xF3) != 0x43)
+		fail("not an expedited upload");
+	*value = resp[4] | (resp[5] << 8) | (resp[6] << 16) | ((uint32_t) resp[7] << 24);
+	*value &= 0xFFFFFFFF >> (8 * ((resp[0] >> 2) & 3));
+	return 0;
+}
+
+/**
+ * @brief	Expedited SDO download.
+ * @param	index: object index.
+ * @param	sub: object subindex.
+ * @param	value: the value.
+ * @param	len: its length, 1 to 4 bytes.
+ * @return	0 or the abort code.
+ */
+static uint32_t sdoWriteValue(uint16_t index, uint8_t sub, uint32_t value, int len)
+{
+	uint8_t req[8] = { 0x23 | ((4 - len) << 2), index, index >> 8, sub,
+			value, value >> 8, value >> 16, value >> 24 }, resp[8];
+
+	sdoRequest(req, resp);
+	if (resp[0] == SDO_ABORT)
+		return resp[4] | (resp[5] << 8) | (resp[6] << 16) | ((uint32_t) resp[7] << 24);
+	if (resp[0] != 0x60)
+		fail("wrong download response");
+	return 0;
+}
+
+/**
+ * @brief	Segmented SDO download.
+ * @param	index: object index.
+ * @param	sub: object subindex.
+ * @param	data: the data.
+ * @param	len: its length.
+ * @return	0 or the abort code.
+ */
+static uint32_t sdoDownload(uint16_t index, uint8_t sub, const uint8_t *data, int len)
+{
+	uint8_t req[8] = { 0x21, index, index >> 8, sub, len, len >> 8 }, resp[8];
+	uint8_t toggle = 0;
+	int n;
+
+	sdoRequest(req, resp);
+	while (resp[0] != SDO_ABORT)
+	{
+		if (!len)
+			return 0;
+		n = len > 7 ? 7 : len;
+		memset(req, 0, 8);
+		req[0] = toggle | ((7 - n) << 1) | (n == len);
+		memcpy(req + 1, data, n);
+		sdoRequest(req, resp);
+		if (resp[0] != SDO_ABORT && resp[0] != (0x20 | toggle))
+			fail("wrong segment response");
+		data += n;
+		len -= n;
+		toggle ^= SDO_TOGGLE;
+	}
+	return resp[4] | (resp[5] << 8) | (resp[6] << 16) | ((uint32_t) resp[7] << 24);
+}
+
+/**
+ * @brief	Segmented SDO upload.
+ * @param	index: object index.
+ * @param	sub: object subindex.
+ * @param	data: buffer receiving the data.
+ * @param	size: buffer size.
+ * @return	the length, -1 on an abort.
+ */
+static int sdoUpload(uint16_t index, uint8_t sub, uint8_t *data, int size)
+{
+	uint8_t req[8] = { SDO_UPLOAD, index, index >> 8, sub }, resp[8];
+	uint8_t toggle = 0;
+	int n, len = 0;
+
+	sdoRequest(req, resp);
+	if (resp[0] != 0x40)
+		return -1;
+	do
+	{
+		memset(req, 0, 8);
+		req[0] = SDO_UPLOAD_SEG | toggle;
+		sdoRequest(req, resp);
+		if (resp[0] == SDO_ABORT || (resp[0] & SDO_TOGGLE) != toggle)
+			return -1;
+		n = 7 - ((resp[0] >> 1) & 7);
+		if (len + n > size)
+			fail("segmented upload too long");
+		memcpy(data + len, resp + 1, n);
+		len += n;
+		toggle ^= SDO_TOGGLE;
+	} while (!(resp[0] & 0x01));
+	return len;
+}
+
+/**
+ * @brief	Bit timing: the bitrate is exact, the sample point near 87.5 %;
+ * 			the low bitrates use the clock divider, an impossible one is
+ * 			refused.
+ */
+static void testBitTiming(void)
+{
+	static const uint32_t rates[] = { 1000000, 800000, 500000, 250000, 125000,
+			100000, 50000 };
+	uint32_t i, btr, brp, tseg1, tseg2, sjw, tq;
+
+	for (i = 0; i < sizeof(rates) / sizeof(rates[0]); i++)
+	{
+		if (canBitTiming(48000000, rates[i], &btr) != SUCCESS)
+			fail("bitrate not supported");
+		brp = (btr & 0x3F) + 1;
+		sjw = ((btr >> 6) & 3) + 1;
+		tseg1 = ((btr >> 8) & 0xF) + 1;
+		tseg2 = ((btr >> 12) & 7) + 1;
+		tq = 1 + tseg1 + tseg2;
+		if (48000000 / (brp * tq) != rates[i] || 48000000 % (brp * tq))
+			fail("wrong bitrate");
+		if ((1 + tseg1) * 100 / tq < 80 || (1 + tseg1) * 100 / tq > 90
+				|| sjw > tseg2)
+			fail("wrong sample point");
+	}
+
+	if (canInit(33333) != ERROR)
+		fail("an impossible bitrate was accepted");
+	if (canInit(10000) != SUCCESS)
+		fail("10 kbit/s not supported");
+	btr = romCanCfg[1];
+	tq = 3 + ((btr >> 8) & 0xF) + ((btr >> 12) & 7);
+	if (48000000 / (romCanCfg[0] + 1) / (((btr & 0x3F) + 1) * tq) != 10000)
+		fail("wrong bitrate with the clock divider");
+}
+
+/**
+ * @brief	The driver alone: frames sent in the order of their identifiers,
+ * 			reception in the buffers, frames lost when none is free, bus off
+ * 			recovery and the error counters.
+ */
+static void testDriver(void)
+{
+	static const uint32_t order[] = { 0x300, 0x028, 0x00A00001 | CAN_MSGOBJ_EXT,
+			0x123, 0x123, 0x7FF };
+	can_msg_t msg, *rx;
+	can_stats_t stats;
+	uint8_t data[8] = { 1, 2, 3, 4, 5, 6, 7, 8 };
+	int i;
+
+	if (canInit(CAN_DEFAULT_BITRATE) != SUCCESS)
+		fail("canInit() failed");
+	if (canAddFilter(0x300 | CAN_MSGOBJ_STD, 0x700, NULL) != CAN_RX_FIRST)
+		fail("wrong filter message object");
+
+	/* the first frame is on the bus while the others are queued */
+	busCount = 0;
+	memset(&msg, 0, sizeof(msg));
+	msg.dlc = 1;
+	msg.mode_id = order[0];
+	canSend(&msg, 0);
+	for (i = 5; i > 0; i--)
+	{
+		msg.mode_id = order[i];
+		msg.data[0] = i;
+		if (canSend(&msg, 0) != SUCCESS)
+			fail("canSend() failed");
+	}
+	busRun();
+	if (busCount != 6)
+		fail("frames not sent");
+	for (i = 0; i < 6; i++)
+	{
+		if (busLog[i].mode_id != order[i] || busLog[i].msgobj != CAN_TX_MSGOBJ)
+			fail("frames not sent in the order of their identifiers");
+	}
+	if (busLog[3].data[0] != 4 || busLog[4].data[0] != 3)
+		fail("frames of the same identifier not sent in order");
+	if (uxQueueMessagesWaiting(canTxFree) != CAN_TX_QUEUE_SIZE)
+		fail("transmit queue room lost");
+
+	/* reception: 10 frames for 8 buffers, none for another identifier */
+	masterSend(0x400 | CAN_MSGOBJ_STD, data, 8);
+	for (i = 0; i < 10; i++)
+	{
+		data[0] = i;
+		masterSend(0x305 | CAN_MSGOBJ_STD, data, 8);
+	}
+	canGetStats(&stats);
+	if (stats.rx_frames != 10 || stats.rx_lost != 2 || stats.tx_frames != 6)
+		fail("wrong receive statistics");
+	for (i = 0; i < 8; i++)
+	{
+		if (!(rx = canReceive(0)) || rx->data[0] != i || rx->dlc != 8
+				|| rx->msgobj != CAN_RX_FIRST)
+			fail("wrong frame received");
+		canRelease(rx);
+	}
+	if (canReceive(0) || canRxFree != (1 << CAN_RX_BUFFERS) - 1)
+		fail("receive buffers lost");
+
+	/* bus off: the controller restarts by itself */
+	simCanRegs[0] = CAN_CNTL_INIT;
+	romErrorInfo = CAN_ERROR_BOFF | CAN_ERROR_ACK | CAN_ERROR_PASS;
+	CAN_IRQHandler();
+	simCanRegs[2] = 0x00002A05;		/* REC 42, TEC 5 */
+	canGetStats(&stats);
+	if (stats.bus_off != 1 || stats.errors[CAN_ERR_ACK] != 1
+			|| stats.status != (CAN_ERROR_BOFF | CAN_ERROR_PASS)
+			|| (simCanRegs[0] & CAN_CNTL_INIT))
+		fail("bus off not recovered");
+	if (stats.tec != 5 || stats.rec != 42)
+		fail("wrong error counters");
+}
+
+/**
+ * @brief	Bus load: 10 frames of 111 bits in 100 ms at 500 kbit/s, 2.2 %.
+ * 			Run with the node task created, as the tick needs a task.
+ */
+static void testLoad(void)
+{
+	static const uint8_t data[8] = { 0 };
+	can_stats_t stats;
+	int i;
+
+	canGetStats(&stats);
+	for (i = 0; i < 100; i++)
+		xTaskIncrementTick();
+	for (i = 0; i < 10; i++)
+	{
+		masterSend(0x305 | CAN_MSGOBJ_STD, data, 8);
+		canRelease(canReceive(0));
+	}
+	canGetStats(&stats);
+	if (stats.load != 22)
+		fail("wrong bus load");
+}
+
+/**
+ * @brief	The CANopen node driven by the master.
+ */
+static void testNode(void)
+{
+	static const uint8_t start[] = { NMT_CMD_START, 0 },
+			startOther[] = { NMT_CMD_START, CANOPEN_NODE_ID + 1 },
+			stop[] = { NMT_CMD_STOP, CANOPEN_NODE_ID },
+			resetComm[] = { NMT_CMD_RESET_COMM, CANOPEN_NODE_ID },
+			resetNode[] = { NMT_CMD_RESET_NODE, 0 },
+			rpdoData[] = { 0x11, 0x22, 0x33, 0x44, 0x55, 0x66, 0x77, 0x88 };
+	uint8_t buff[CANOPEN_DOMAIN_SIZE + 8];
+	uint32_t value;
+	int i;
+
+	if (canopenInit(CANOPEN_NODE_ID) != SUCCESS)
+		fail("canopenInit() failed");
+	if (!romCanopen || romCanopen->msgobj_rx != CAN_SDO_RX_MSGOBJ
+			|| romCanopen->node_id != CANOPEN_NODE_ID)
+		fail("SDO server not configured");
+
+	/* boot-up, then the heartbeat every second in pre-operational */
+	busCount = 0;
+	runTicks(2500);
+	if (busCount != 4 || busLog[0].mode_id != COB_HEARTBEAT + CANOPEN_NODE_ID
+			|| busLog[0].data[0] != NMT_BOOTUP
+			|| busLog[3].data[0] != NMT_PRE_OPERATIONAL)
+		fail("wrong boot-up or heartbeat");
+
+	/* operational: the TPDO every 100 ms, with the process data */
+	g_canopenOut[0] = 0x1234;
+	g_canopenOut[3] = 0xABCD;
+	masterSend(COB_NMT, startOther, 2);
+	nodeStep();
+	if (canopenGetState() != NMT_PRE_OPERATIONAL)
+		fail("NMT command for another node taken");
+	masterSend(COB_NMT, start, 2);
+	busCount = 0;
+	runTicks(1000);
+	if (canopenGetState() != NMT_OPERATIONAL
+			|| busFrames(COB_TPDO1 + CANOPEN_NODE_ID) != 10)
+		fail("wrong TPDO timing");
+	for (i = 0; i < busCount && busLog[i].mode_id != COB_TPDO1 + CANOPEN_NODE_ID; i++)
+		;
+	if (busLog[i].dlc != 8 || busLog[i].data[0] != 0x34 || busLog[i].data[1] != 0x12
+			|| busLog[i].data[7] != 0xAB)
+		fail("wrong TPDO data");
+
+	/* RPDO, a short one is ignored */
+	masterSend(COB_RPDO1 + CANOPEN_NODE_ID, rpdoData, 8);
+	nodeStep();
+	if (g_canopenIn[0] != 0x2211 || g_canopenIn[3] != 0x8877)
+		fail("RPDO not received");
+	masterSend(COB_RPDO1 + CANOPEN_NODE_ID, rpdoData + 4, 4);
+	nodeStep();
+	if (g_canopenIn[0] != 0x2211)
+		fail("short RPDO taken");
+
+	/* expedited SDO */
+	if (sdoRead(0x1018, 2, &value) || value != 0x1114)
+		fail("wrong product code");
+	if (sdoRead(0x2001, 1, &value) || value != 0x1234)
+		fail("wrong process data read");
+	if (sdoRead(0x2000, 4, &value) || value != 0x8877)
+		fail("wrong process data read");
+	if (sdoRead(0x9999, 0, &value) != SDO_ABORT_NOT_EXISTS)
+		fail("missing object read");
+	if (sdoWriteValue(0x2001, 1, 0, 2) != SDO_ABORT_READONLY)
+		fail("read only object written");
+	if (sdoWriteValue(0x1A00, 0, 5, 1) != SDO_ABORT_VALUE_RANGE)
+		fail("too many mapped objects accepted");
+	if (sdoWriteValue(0x1A00, 1, 0x20010120, 4) != SDO_ABORT_PARAINCOMP)
+		fail("mapping of the wrong length accepted");
+
+	/* TPDO on every second SYNC; the write wakes the task up */
+	if (sdoWriteValue(0x1800, 2, 2, 1))
+		fail("transmission type not written");
+	if (uxQueueMessagesWaiting(canopenQueue) != 1)
+		fail("the node task wasn't woken up");
+	nodeStep();
+	busCount = 0;
+	for (i = 0; i < 6; i++)
+	{
+		masterSend(COB_SYNC, NULL, 0);
+		nodeStep();
+	}
+	runTicks(500);
+	if (busFrames(COB_TPDO1 + CANOPEN_NODE_ID) != 3)
+		fail("wrong TPDO on SYNC");
+
+	/* remapped TPDO, one object */
+	if (sdoWriteValue(0x1A00, 0, 1, 1) || sdoWriteValue(0x1A00, 1, 0x20010410, 4))
+		fail("TPDO not remapped");
+	nodeStep();
+	busCount = 0;
+	masterSend(COB_SYNC, NULL, 0);
+	masterSend(COB_SYNC, NULL, 0);
+	nodeStep();
+	if (busFrames(COB_TPDO1 + CANOPEN_NODE_ID) != 1 || busLog[busCount - 1].dlc != 2
+			|| busLog[busCount - 1].data[1] != 0xAB)
+		fail("wrong remapped TPDO");
+
+	/* segmented SDO: the domain written and read back, too long refused,
+	 * the device name */
+	for (i = 0; i < (int) sizeof(buff); i++)
+		buff[i] = i * 7;
+	if (sdoDownload(0x2100, 0, buff, 20) || domainLength != 20
+			|| memcmp(domain, buff, 20))
+		fail("segmented download failed");
+	memset(buff, 0, sizeof(buff));
+	if (sdoUpload(0x2100, 0, buff, sizeof(buff)) != 20 || memcmp(domain, buff, 20))
+		fail("segmented upload failed");
+	if (sdoDownload(0x2100, 0, buff, CANOPEN_DOMAIN_SIZE + 6) != SDO_ABORT_VALUE_RANGE)
+		fail("too long download accepted");
+	if (sdoUpload(0x1008, 0, buff, sizeof(buff)) != (int) strlen(deviceName)
+			|| memcmp(buff, deviceName, strlen(deviceName)))
+		fail("wrong device name");
+
+	/* heartbeat every 200 ms */
+	if (sdoWriteValue(0x1017, 0, 200, 2))
+		fail("heartbeat time not written");
+	busCount = 0;
+	runTicks(1000);
+	if (busFrames(COB_HEARTBEAT + CANOPEN_NODE_ID) != 5)
+		fail("wrong heartbeat period");
+
+	/* stopped: no PDO, then reset of the communication and of the node */
+	masterSend(COB_NMT, stop, 2);
+	busCount = 0;
+	runTicks(400);
+	if (busFrames(COB_TPDO1 + CANOPEN_NODE_ID) != 0
+			|| busLog[busCount - 1].data[0] != NMT_STOPPED)
+		fail("PDO sent when stopped");
+	masterSend(COB_NMT, resetComm, 2);
+	busCount = 0;
+	nodeStep();
+	for (i = 0; i < busCount && busLog[i].data[0] != NMT_BOOTUP; i++)
+		;
+	if (i == busCount || canopenGetState() != NMT_PRE_OPERATIONAL)
+		fail("no boot-up after a communication reset");
+	masterSend(COB_NMT, resetNode, 2);
+	nodeStep();
+	if (simResets != 1)
+		fail("no reset of the node");
+	if (canRxFree != (1 << CAN_RX_BUFFERS) - 1)
+		fail("receive buffers lost");
+}
+
+int main(void)
+{
+	/* the tick timer lists, as vTaskStartScheduler() does */
+	xTimerCreateTimerTask();
+
+	testBitTiming();
+	testDriver();
+	testNode();
+	testLoad();
+	printf("test_can: ok\n");
+	return 0;
+}
@@ -0,0 +1,189 @@
+/*
+ * test_divide.c
+ *
+ * Host test of the division helpers: the reciprocal multiplication of
+ * udivByConst() for a set of constant divisors, udivConstInit() and
+ * udivConst() for random divisors of every size, and the signed division
+ * of divide.c, all against the native division. The unsigned run time of
+ * divide.S is target code; the test provides a reference one. The module
+ * source is included, as the other tests.
+ *
+ * Created on: 18 Oct 2026 (LNP)
+ *
+ * (c) 2026 Lixco Microsystems <lix@paulian.net>
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "../../src/divide.c"
+
+#define RANDOM_DIVISORS 200000
+#define RANDOM_DIVIDENDS 50
+
+static uint64_t rng = 88172645463325252ULL;
+
+/**
+ * @brief	Stop the test.
+ * @param	msg: what went wrong.
+ * @param	n: dividend.
+ * @param	d: divisor.
+ */
+static void fail(const char *msg, uint32_t n, uint32_t d)
+{
+	printf("test_divide: %s, %lu / %lu\n", msg, (unsigned long) n, (unsigned long) d);
+	exit(1);
+}
+
+/**
+ * @brief	Pseudo random numbers, xorshift.
+ * @return	the next number.
+ */
+static uint32_t rnd(void)
+{
+	rng ^= rng << 13;
+	rng ^= rng >> 7;
+	rng ^= rng << 17;
+	return (uint32_t) rng;
+}
+
+/**
+ * @brief	Random number of a random size, 1 to 32 bits.
+ * @return	the number.
+ */
+static uint32_t rndSized(void)
+{
+	return rnd() >> (rnd() % 32);
+}
+
+/**
+ * @brief	Reference unsigned run time, in place of divide.S.
+ */
+uint64_t __aeabi_uidivmod(uint32_t n, uint32_t d)
+{
+	return ((uint64_t) (n % d) << 32) | (n / d);
+}
+
+/**
+ * @brief	Dividends around the multiples of d, the ends of the range and
+ * 			random ones.
+ * @param	i: index of the dividend, 0 to RANDOM_DIVIDENDS - 1.
+ * @param	d: divisor.
+ * @return	the dividend.
+ */
+static uint32_t dividend(int i, uint32_t d)
+{
+	switch (i)
+	{
+	case 0:
+		return 0;
+	case 1:
+		return 0xFFFFFFFF;
+	case 2:
+		return d - 1;
+	case 3:
+		return d;
+	case 4:
+		return 0xFFFFFFFF / d * d - 1;
+	case 5:
+		return 0xFFFFFFFF / d * d;
+	default:
+		return i & 1 ? rndSized() : rnd() % (0xFFFFFFFF / d) * d - (i & 2);
+	}
+}
+
+/* every dividend, divided by a constant d */
+#define CHECK_CONST(d) \
+	for (i = 0; i < RANDOM_DIVIDENDS * 100; i++) \
+	{ \
+		n = dividend(i % RANDOM_DIVIDENDS, d); \
+		if (udivByConst(n, d) != n / (d)) \
+			fail("udivByConst() wrong", n, d); \
+	}
+
+/**
+ * @brief	Division by the constants of the firmware, and by the edge cases:
+ * 			powers of two, 1, 3, the largest divisors.
+ */
+static void testConst(void)
+{
+	uint32_t i, n;
+
+	CHECK_CONST(1);
+	CHECK_CONST(2);
+	CHECK_CONST(3);
+	CHECK_CONST(7);
+	CHECK_CONST(10);
+	CHECK_CONST(24);
+	CHECK_CONST(60);
+	CHECK_CONST(100);
+	CHECK_CONST(641);
+	CHECK_CONST(1000);
+	CHECK_CONST(1024);
+	CHECK_CONST(1000000);
+	CHECK_CONST(0x7FFFFFFF);
+	CHECK_CONST(0x80000000);
+	CHECK_CONST(0x80000001);
+	CHECK_CONST(0xFFFFFFFF);
+}
+
+/**
+ * @brief	Prepared divisors of every size.
+ */
+static void testPrepared(void)
+{
+	udiv_const_t dc;
+	uint32_t d, n;
+	int k, i;
+
+	for (k = 0; k < RANDOM_DIVISORS; k++)
+	{
+		d = k < 32 ? 1UL << k : k < 64 ? 0xFFFFFFFF >> (k - 32) : rndSized();
+		if (!d)
+			d = 1;
+		udivConstInit(&dc, d);
+		for (i = 0; i < RANDOM_DIVIDENDS; i++)
+		{
+			n = dividend(i, d);
+			if (udivConst(&dc, n) != n / d)
+				fail("udivConst() wrong", n, d);
+		}
+	}
+}
+
+/**
+ * @brief	Signed division: the quotient is rounded toward zero, the
+ * 			remainder has the sign of the dividend, as in C.
+ */
+static void testSigned(void)
+{
+	int32_t n, d, q, r;
+	int64_t res;
+	int k;
+
+	for (k = 0; k < RANDOM_DIVISORS * 10; k++)
+	{
+		n = (int32_t) (k < 4 ? 0x80000000 + k : rndSized());
+		if ((rnd() & 1) && n != INT32_MIN)
+			n = -n;
+		d = (int32_t) rndSized();
+		if ((rnd() & 1) && d != INT32_MIN)
+			d = -d;
+		if (!d || (d == -1 && n == INT32_MIN))
+			d = 3;
+		res = __aeabi_idivmod(n, d);
+		q = (int32_t) res;
+		r = (int32_t) (res >> 32);
+		if (q != n / d || r != n % d || __aeabi_idiv(n, d) != q)
+			fail("signed division wrong", (uint32_t) n, (uint32_t) d);
+	}
+}
+
+int main(void)
+{
+	testConst();
+	testPrepared();
+	testSigned();
+	printf("test_divide: ok\n");
+	return 0;
+}
@@ -0,0 +1,429 @@
+/*
+ * test_dsp.c
+ *
+ * Host test of the fixed point kernels against double precision references:
+ * the FIR filter, the moving average and the CIC decimator must give the
+ * exact rounded result, the biquads stay within a few LSB of the reference,
+ * the level detector close to the RMS and peak of a sine. The ADC
+ * conversion and dspReadAdc() across the wrap of a simulated ADC ring are
+ * checked too. Built with -DDSP_BENCH, it also times each kernel on the
+ * host ("make bench"). The module source is included, as the other tests.
+ *
+ * Created on: 18 Oct 2026 (LNP)
+ *
+ * (c) 2026 Lixco Microsystems <lix@paulian.net>
+ */
+
+#include <math.h>
+#include <time.h>
+
+#include "../../src/dsp.c"
+
+#define N 4096					/* samples per test */
+#define FIR_TAPS 31
+#define BQ_STAGES 2
+#define ADC_RING 100
+
+static q15_t in15[N], out15[N];
+static q31_t in31[N], out31[N];
+static double ref[N];
+static uint64_t rng = 88172645463325252ULL;
+
+/* simulated ADC ring, read by dspReadAdc() */
+static uint16_t adcRing[ADC_RING];
+static int adcTail, adcAvail;
+
+/**
+ * @brief	Stop the test.
+ * @param	msg: what went wrong.
+ */
+static void fail(const char *msg)
+{
+	printf("test_dsp: %s\n", msg);
+	exit(1);
+}
+
+/**
+ * @brief	Pseudo random numbers, xorshift.
+ * @return	the next number.
+ */
+static uint32_t rnd(void)
+{
+	rng ^= rng << 13;
+	rng ^= rng >> 7;
+	rng ^= rng << 17;
+	return (uint32_t) rng;
+}
+
+/**
+ * @brief	Contiguous samples of the simulated ADC ring.
+ * @param	data: set to the oldest sample.
+ * @return	the number of samples up to the end of the ring.
+ */
+int adcPeek(const uint16_t **data)
+{
+	*data = &adcRing[adcTail];
+	return adcAvail < ADC_RING - adcTail ? adcAvail : ADC_RING - adcTail;
+}
+
+/**
+ * @brief	Release samples of the simulated ADC ring.
+ * @param	count: number of samples.
+ */
+void adcConsume(int count)
+{
+	adcTail = (adcTail + count) % ADC_RING;
+	adcAvail -= count;
+}
+
+/**
+ * @brief	Fill the input with noise, and with a full scale step in the
+ * 			middle.
+ * @param	amp: noise amplitude, 0 to 1.
+ */
+static void noise(double amp)
+{
+	int i;
+
+	for (i = 0; i < N; i++)
+	{
+		in15[i] = (q15_t) ((int32_t) (rnd() >> 16) - 0x8000) * amp;
+		if (i >= N / 2 && i < N / 2 + 64)
+			in15[i] = amp * INT16_MAX;
+	}
+}
+
+/**
+ * @brief	Biquad coefficients of a low pass filter (audio EQ cookbook), in
+ * 			Q14, the same for all the stages.
+ * @param	c: 5 * BQ_STAGES coefficients.
+ * @param	fc: cut-off frequency over the sample rate.
+ */
+static void lowpass(q15_t *c, double fc)
+{
+	double w = 2 * M_PI * fc, alpha = sin(w) / (2 * M_SQRT1_2);
+	double a0 = 1 + alpha;
+	int s;
+
+	for (s = 0; s < BQ_STAGES; s++, c += 5)
+	{
+		c[0] = Q14((1 - cos(w)) / 2 / a0);
+		c[1] = Q14((1 - cos(w)) / a0);
+		c[2] = c[0];
+		c[3] = Q14(-2 * cos(w) / a0);
+		c[4] = Q14((1 - alpha) / a0);
+	}
+}
+
+/**
+ * @brief	Double precision biquad cascade, with the quantized coefficients.
+ * @param	c: 5 * BQ_STAGES Q14 coefficients.
+ * @param	x: input, full scale 1.0, filtered in place.
+ */
+static void biquadRef(const q15_t *c, double *x)
+{
+	double x1, x2, y1, y2, y;
+	int s, i;
+
+	for (s = 0; s < BQ_STAGES; s++, c += 5)
+	{
+		x1 = x2 = y1 = y2 = 0;
+		for (i = 0; i < N; i++)
+		{
+			y = (c[0] * x[i] + c[1] * x1 + c[2] * x2 - c[3] * y1 - c[4] * y2)
+					/ 16384.0;
+			x2 = x1;
+			x1 = x[i];
+			y2 = y1;
+			y1 = y;
+			x[i] = y;
+		}
+	}
+}
+
+/**
+ * @brief	FIR low pass filter, windowed sinc: the output is the rounded
+ * 			exact sum, and blocks of any length give the same result.
+ */
+static void testFir(void)
+{
+	static q15_t coeffs[FIR_TAPS], state[2 * FIR_TAPS];
+	dsp_fir_t fir;
+	double t, acc;
+	int i, k, done, n;
+
+	for (k = 0; k < FIR_TAPS; k++)
+	{
+		t = k - (FIR_TAPS - 1) / 2.0;
+		coeffs[k] = Q15(0.25 * (t ? sin(M_PI * t / 4) / (M_PI * t / 4) : 1)
+				* (0.54 - 0.46 * cos(2 * M_PI * k / (FIR_TAPS - 1))));
+	}
+	noise(0.9);
+	dspFirInit(&fir, coeffs, state, FIR_TAPS);
+	for (done = 0; done < N; done += n)
+	{
+		n = 1 + rnd() % 100;
+		if (n > N - done)
+			n = N - done;
+		dspFirQ15(&fir, in15 + done, out15 + done, n);
+	}
+
+	for (i = 0; i < N; i++)
+	{
+		for (acc = 0, k = 0; k < FIR_TAPS && k <= i; k++)
+			acc += (double) coeffs[k] * in15[i - k];
+		acc = floor(acc / 32768 + 0.5);
+		if (acc > INT16_MAX)
+			acc = INT16_MAX;
+		else if (acc < INT16_MIN)
+			acc = INT16_MIN;
+		if (out15[i] != acc)
+			fail("FIR output differs from the reference");
+	}
+}
+
+/**
+ * @brief	Q15 and Q31 biquad cascades: error against the reference, the
+ * 			Q31 one with a cut-off frequency where the Q15 one is too noisy.
+ */
+static void testBiquad(void)
+{
+	static q15_t coeffs[5 * BQ_STAGES], state15[4 * BQ_STAGES];
+	static q31_t state31[4 * BQ_STAGES];
+	dsp_biquad_t bq;
+	dsp_biquad32_t bq32;
+	double err, max;
+	int i;
+
+	lowpass(coeffs, 0.05);
+	noise(0.5);
+	dspBiquadInit(&bq, coeffs, state15, BQ_STAGES);
+	dspBiquadQ15(&bq, in15, out15, N / 2);
+	dspBiquadQ15(&bq, in15 + N / 2, out15 + N / 2, N / 2);
+	for (i = 0; i < N; i++)
+		ref[i] = in15[i] / 32768.0;
+	biquadRef(coeffs, ref);
+	for (max = 0, i = 0; i < N; i++)
+	{
+		err = fabs(out15[i] - ref[i] * 32768);
+		if (err > max)
+			max = err;
+	}
+	printf("test_dsp: Q15 biquad, max error %.2f LSB\n", max);
+	if (max > 8)
+		fail("Q15 biquad error too large");
+
+	/* poles close to the unit circle, negative values (the scaling of the
+	 * output must not shift them) */
+	lowpass(coeffs, 0.01);
+	for (i = 0; i < N; i++)
+		in31[i] = (q31_t) in15[i] * 65536 - (1 << 29);
+	dspBiquad32Init(&bq32, coeffs, state31, BQ_STAGES);
+	dspBiquadQ31(&bq32, in31, out31, N);
+	for (i = 0; i < N; i++)
+		ref[i] = in31[i] / 2147483648.0;
+	biquadRef(coeffs, ref);
+	for (max = 0, i = 0; i < N; i++)
+	{
+		err = fabs(out31[i] / 2147483648.0 - ref[i]);
+		if (err > max)
+			max = err;
+	}
+	printf("test_dsp: Q31 biquad, max error %.3f Q15 LSB\n", max * 32768);
+	if (max * 32768 > 0.1)
+		fail("Q31 biquad error too large");
+}
+
+/**
+ * @brief	Moving average and CIC decimator: exact against the sums in
+ * 			double, rounded down, including full scale inputs.
+ */
+static void testAvgCic(void)
+{
+	static q15_t hist[1 << 5];
+	dsp_avg_t avg;
+	dsp_cic_t cic;
+	double sum;
+	int i, k, n, stage;
+
+	noise(1.0);
+	if (dspAvgInit(&avg, hist, 16) != ERROR || dspAvgInit(&avg, hist, 5) != SUCCESS)
+		fail("wrong dspAvgInit() result");
+	dspAvgQ15(&avg, in15, out15, N);
+	for (i = 0; i < N; i++)
+	{
+		for (sum = 0, k = 0; k < 32 && k <= i; k++)
+			sum += in15[i - k];
+		if (out15[i] != floor(sum / 32))
+			fail("moving average differs from the reference");
+	}
+
+	/* full scale negative inputs, the integrators wrap */
+	for (i = N / 4; i < N / 2; i++)
+		in15[i] = INT16_MIN;
+	if (dspCicInit(&cic, 3, 6) != ERROR || dspCicInit(&cic, 3, 4) != SUCCESS)
+		fail("wrong dspCicInit() result");
+	n = dspCicQ15(&cic, in15, out15, N / 3);
+	n += dspCicQ15(&cic, in15 + N / 3, out15 + n, N - N / 3);
+	if (n != N / 16)
+		fail("wrong number of CIC outputs");
+	for (i = 0; i < N; i++)
+		ref[i] = in15[i];
+	for (stage = 0; stage < 3; stage++)
+	{
+		for (i = N - 1; i >= 0; i--)
+		{
+			for (sum = 0, k = 0; k < 16 && k <= i; k++)
+				sum += ref[i - k];
+			ref[i] = sum;
+		}
+	}
+	for (i = 0; i < n; i++)
+	{
+		if (out15[i] != floor(ref[16 * i + 15] / 4096))
+			fail("CIC output differs from the reference");
+	}
+}
+
+/**
+ * @brief	Level detector on a sine, square root, ADC conversion and reads
+ * 			across the wrap of the ADC ring.
+ */
+static void testLevelAdc(void)
+{
+	static const uint16_t adc[] = { 0, 512, 1023 };
+	static const q15_t q15[] = { INT16_MIN, 0, 32704 };
+	dsp_level_t level;
+	uint32_t x;
+	q15_t out[3];
+	int i, n;
+
+	for (i = 0; i < N; i++)
+		in15[i] = Q15(0.5 * sin(2 * M_PI * i / 50.5));
+	dspLevelInit(&level, 8);
+	dspLevelQ15(&level, in15, N);
+	if (fabs(dspLevelRms(&level) / 32768.0 - 0.5 * M_SQRT1_2) > 0.005
+			|| level.peak > Q15(0.5) || level.peak < Q15(0.45))
+		fail("wrong RMS or peak level");
+
+	for (i = 0; i < 1000000; i++)
+	{
+		x = i < 1000 ? (uint32_t) i : i < 2000 ? 0xFFFFFFFF - i : rnd();
+		if (dspSqrt(x) != (uint32_t) floor(sqrt((double) x)))
+			fail("wrong square root");
+	}
+
+	dspAdcToQ15(adc, out, 3);
+	for (i = 0; i < 3; i++)
+	{
+		if (out[i] != q15[i])
+			fail("wrong ADC sample conversion");
+	}
+
+	for (i = 0; i < ADC_RING; i++)
+		adcRing[i] = i * 10;
+	adcTail = 90;
+	adcAvail = 30;
+	n = dspReadAdc(out15, N);
+	if (n != 30 || adcAvail || adcTail != 20)
+		fail("the ADC ring wasn't read across its wrap");
+	for (i = 0; i < n; i++)
+	{
+		if (out15[i] != (q15_t) ((adcRing[(90 + i) % ADC_RING] << 6) - 0x8000))
+			fail("wrong ADC samples");
+	}
+}
+
+#ifdef DSP_BENCH
+/**
+ * @brief	Time of a kernel run over a block, on the host.
+ * @param	name: kernel name.
+ * @param	start: time before the runs.
+ * @param	runs: number of runs over the block.
+ */
+static void benchReport(const char *name, const struct timespec *start, int runs)
+{
+	struct timespec end;
+
+	clock_gettime(CLOCK_MONOTONIC, &end);
+	printf("%-22s%8.2f ns/sample\n", name,
+			((end.tv_sec - start->tv_sec) * 1e9 + end.tv_nsec - start->tv_nsec)
+			/ ((double) runs * N));
+}
+
+/**
+ * @brief	Time each kernel on the host; the ratios between the kernels are
+ * 			the useful part, the target runs them some 20 to 50 times slower.
+ */
+static void bench(void)
+{
+	static q15_t coeffs[5 * BQ_STAGES], fcoeffs[FIR_TAPS], state[2 * FIR_TAPS],
+			hist[1 << 5];
+	static q31_t state31[4 * BQ_STAGES];
+	dsp_fir_t fir;
+	dsp_biquad_t bq;
+	dsp_biquad32_t bq32;
+	dsp_avg_t avg;
+	dsp_cic_t cic;
+	dsp_level_t level;
+	struct timespec start;
+	volatile uint32_t sink = 0;
+	int i, runs = 200;
+
+	noise(0.5);
+	for (i = 0; i < N; i++)
+		in31[i] = (q31_t) in15[i] * 65536;
+	for (i = 0; i < FIR_TAPS; i++)
+		fcoeffs[i] = Q15(1.0 / FIR_TAPS);
+	lowpass(coeffs, 0.05);
+	dspFirInit(&fir, fcoeffs, state, FIR_TAPS);
+	dspBiquadInit(&bq, coeffs, state, BQ_STAGES);
+	dspBiquad32Init(&bq32, coeffs, state31, BQ_STAGES);
+	dspAvgInit(&avg, hist, 5);
+	dspCicInit(&cic, 3, 4);
+	dspLevelInit(&level, 8);
+
+	clock_gettime(CLOCK_MONOTONIC, &start);
+	for (i = 0; i < runs; i++)
+		dspFirQ15(&fir, in15, out15, N);
+	benchReport("FIR, 31 taps", &start, runs);
+	clock_gettime(CLOCK_MONOTONIC, &start);
+	for (i = 0; i < runs; i++)
+		dspBiquadQ15(&bq, in15, out15, N);
+	benchReport("biquad Q15, 2 stages", &start, runs);
+	clock_gettime(CLOCK_MONOTONIC, &start);
+	for (i = 0; i < runs; i++)
+		dspBiquadQ31(&bq32, in31, out31, N);
+	benchReport("biquad Q31, 2 stages", &start, runs);
+	clock_gettime(CLOCK_MONOTONIC, &start);
+	for (i = 0; i < runs; i++)
+		dspAvgQ15(&avg, in15, out15, N);
+	benchReport("moving average", &start, runs);
+	clock_gettime(CLOCK_MONOTONIC, &start);
+	for (i = 0; i < runs; i++)
+		dspCicQ15(&cic, in15, out15, N);
+	benchReport("CIC, order 3, R 16", &start, runs);
+	clock_gettime(CLOCK_MONOTONIC, &start);
+	for (i = 0; i < runs; i++)
+		dspLevelQ15(&level, in15, N);
+	sink += level.ms;
+	benchReport("level detector", &start, runs);
+	clock_gettime(CLOCK_MONOTONIC, &start);
+	for (i = 0; i < runs * N; i++)
+		sink += dspSqrt(i * 2654435761u);
+	benchReport("square root", &start, runs);
+}
+#endif
+
+int main(void)
+{
+	testFir();
+	testBiquad();
+	testAvgCic();
+	testLevelAdc();
+	printf("test_dsp: ok\n");
+#ifdef DSP_BENCH
+	bench();
+#endif
+	return 0;
+}
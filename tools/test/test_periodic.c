@@ -0,0 +1,138 @@
+/*
+ * test_periodic.c
+ *
+ * Host test of the periodic task statistics: runs with known release, start
+ * and end times go through the accounting of periodic.c, across the wrap of
+ * the microseconds low word, and the load generator shares the load between
+ * its tasks. The module source is included, so that the test reaches its
+ * static functions and data.
+ *
+ * Created on: 18 Oct 2026 (LNP)
+ *
+ * (c) 2026 Lixco Microsystems <lix@paulian.net>
+ */
+
+#include <string.h>
+
+#include "../../src/periodic.c"
+
+#define PERIOD_US 10000
+#define DEADLINE_US 8000
+
+/**
+ * @brief	Time base of the target, not used by the accounting.
+ */
+uint64_t clockMicros(void)
+{
+	return 0;
+}
+
+/**
+ * @brief	Boot profiler of the target, nothing to do here.
+ */
+void bootDone(void)
+{
+}
+
+/**
+ * @brief	Stop the test.
+ * @param	msg: what went wrong.
+ */
+static void fail(const char *msg)
+{
+	printf("test_periodic: %s\n", msg);
+	exit(1);
+}
+
+/**
+ * @brief	Nothing to do, the work function of the created tasks.
+ * @param	param: not used.
+ */
+static void work(void *param)
+{
+	(void) param;
+}
+
+/**
+ * @brief	Account runs with known lateness and execution times, starting
+ * 			just before the microseconds wrap, and check the statistics.
+ */
+static void testAccounting(void)
+{
+	/* lateness and execution time of each run, us */
+	static const uint32_t late[] = { 20, 5, 300, 40, 0, 7900, 100, 60 };
+	static const uint32_t exec[] = { 1000, 1200, 900, 1000, 8001, 200, 7950, 1000 };
+	periodic_t per;
+	uint32_t release = 0xFFFF0000, avg = 0;
+	int i, misses = 0;
+
+	memset(&per, 0, sizeof(per));
+	per.stats.period = PERIOD_US;
+	per.stats.deadline = DEADLINE_US;
+	for (i = 0; i < (int) (sizeof(late) / sizeof(late[0])); i++)
+	{
+		perAccount(&per, release, release + late[i],
+				release + late[i] + exec[i]);
+		if (late[i] + exec[i] > DEADLINE_US)
+			misses++;
+		avg = i ? avg + (((int32_t) (exec[i] - avg)) >> PERIODIC_AVG_SHIFT)
+				: exec[i];
+		release += PERIOD_US;
+	}
+
+	if (per.stats.releases != sizeof(late) / sizeof(late[0]))
+		fail("wrong number of releases");
+	if (per.stats.jitter != 7900)
+		fail("wrong release jitter");
+	if (per.stats.misses != (uint32_t) misses || misses != 3)
+		fail("wrong number of deadline misses");
+	if (per.stats.exec_max != 8001)
+		fail("wrong max execution time");
+	if (per.stats.exec_avg != avg)
+		fail("wrong average execution time");
+
+	/* a start before the nominal release (tick rounding) is a negative
+	 * lateness, it widens the jitter */
+	perAccount(&per, release, release - 50, release + 100);
+	if (per.stats.jitter != 7950)
+		fail("early start not accounted");
+}
+
+/**
+ * @brief	The load generator spreads the load evenly, keeps its tasks on a
+ * 			second call and refuses more than 100 %.
+ */
+static void testLoad(void)
+{
+	uint32_t total;
+	int i;
+
+	if (periodicLoad(101) != ERROR)
+		fail("a load over 100 % was accepted");
+	if (periodicLoad(60) != SUCCESS || perCount != PERIODIC_LOAD_TASKS)
+		fail("the load generator didn't start");
+	for (i = 0, total = 0; i < PERIODIC_LOAD_TASKS; i++)
+		total += perLoadSpin[i] * 1000 / (perLoadPeriod[i] * PERIODIC_US_PER_TICK);
+	if (total != 600)
+		fail("wrong load");
+	if (periodicLoad(90) != SUCCESS || perCount != PERIODIC_LOAD_TASKS)
+		fail("the load generator started again");
+	if (perLoadSpin[0] != 1500)
+		fail("the load didn't change");
+
+	/* the rest of the table still takes a task, then it is full */
+	if (periodicCreate("extra", work, NULL, 10, 20, 1, 64) != ERROR)
+		fail("a deadline after the period was accepted");
+	if (periodicCreate("extra", work, NULL, 10, 0, 1, 64) != SUCCESS)
+		fail("a task couldn't be created");
+	if (periodicCreate("extra", work, NULL, 10, 0, 1, 64) != ERROR)
+		fail("too many tasks were created");
+}
+
+int main(void)
+{
+	testAccounting();
+	testLoad();
+	printf("test_periodic: ok\n");
+	return 0;
+}
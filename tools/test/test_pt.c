@@ -0,0 +1,224 @@
+/*
+ * test_pt.c
+ *
+ * Host test of the protothreads: delays, PT_WAIT_UNTIL() checked at every
+ * tick, event waits ended by an event or by their timeout, events posted
+ * before the wait, yields, and the sleep time of the scheduler task. One
+ * pass of the scheduler task is run at a time, while the test moves the
+ * tick. The module source is included, so that the test reaches its static
+ * functions and data.
+ *
+ * Created on: 18 Oct 2026 (LNP)
+ *
+ * (c) 2026 Lixco Microsystems <lix@paulian.net>
+ */
+
+#include "../../src/pt.c"
+#include "timers.h"
+
+#define EV_A 1
+#define EV_B 4
+#define EV_C 8
+#define TEST_TICKS 20
+
+/* a protothread and what it saw */
+typedef struct
+{
+	pt_t pt;
+	int count;
+	portTickType at[4];
+	uint32_t ev[4];
+} thread_t;
+
+static thread_t delayer, waiter, eventer, yielder, sleeper;
+static volatile int flag;
+
+/**
+ * @brief	Stop the test.
+ * @param	msg: what went wrong.
+ */
+static void fail(const char *msg)
+{
+	printf("test_pt: %s (tick %u)\n", msg, (unsigned) xTaskGetTickCount());
+	exit(1);
+}
+
+/**
+ * @brief	Wait 5 ticks, then end.
+ */
+static int delayFn(pt_t *pt)
+{
+	thread_t *t = (thread_t *) pt;
+
+	PT_BEGIN(pt);
+	PT_DELAY(pt, 5);
+	t->at[0] = xTaskGetTickCount();
+	PT_END(pt);
+}
+
+/**
+ * @brief	Wait until the flag is set, then end.
+ */
+static int waitFn(pt_t *pt)
+{
+	thread_t *t = (thread_t *) pt;
+
+	PT_BEGIN(pt);
+	PT_WAIT_UNTIL(pt, flag);
+	t->at[0] = xTaskGetTickCount();
+	PT_END(pt);
+}
+
+/**
+ * @brief	Wait for event A with a timeout, twice, then for event B which is
+ * 			posted before the wait, then exit.
+ */
+static int eventFn(pt_t *pt)
+{
+	thread_t *t = (thread_t *) pt;
+
+	PT_BEGIN(pt);
+	PT_WAIT_EVENT(pt, EV_A, 10);
+	t->at[0] = xTaskGetTickCount();
+	t->ev[0] = PT_EVENTS(pt);
+	PT_WAIT_EVENT(pt, EV_A, 10);
+	t->at[1] = xTaskGetTickCount();
+	t->ev[1] = PT_EVENTS(pt);
+	PT_WAIT_EVENT(pt, EV_B, portMAX_DELAY);
+	t->at[2] = xTaskGetTickCount();
+	t->ev[2] = PT_EVENTS(pt);
+	PT_EXIT(pt);
+	t->count = -1;				/* not reached */
+	PT_END(pt);
+}
+
+/**
+ * @brief	Yield three times, then end.
+ */
+static int yieldFn(pt_t *pt)
+{
+	thread_t *t = (thread_t *) pt;
+
+	PT_BEGIN(pt);
+	while (t->count < 3)
+	{
+		t->count++;
+		PT_YIELD(pt);
+	}
+	PT_END(pt);
+}
+
+/**
+ * @brief	Wait 100 ticks, then for event C for ever.
+ */
+static int sleepFn(pt_t *pt)
+{
+	thread_t *t = (thread_t *) pt;
+
+	PT_BEGIN(pt);
+	PT_DELAY(pt, 100);
+	t->at[0] = xTaskGetTickCount();
+	PT_WAIT_EVENT(pt, EV_C, portMAX_DELAY);
+	t->ev[0] = PT_EVENTS(pt);
+	PT_END(pt);
+}
+
+/**
+ * @brief	Run the scheduler task passes of the current tick, as long as a
+ * 			protothread is ready.
+ * @return	the sleep time after the last pass.
+ */
+static portTickType runTick(void)
+{
+	portTickType timeout;
+	int passes = 0;
+
+	while ((timeout = ptRun()) == 0)
+	{
+		if (++passes > 10)
+			fail("a protothread stays ready");
+	}
+	return timeout;
+}
+
+/**
+ * @brief	Run the protothreads over a few ticks, posting events and setting
+ * 			the flag at known ticks.
+ */
+static void testWaits(void)
+{
+	portTickType now, timeout;
+
+	ptStart(&delayer.pt, delayFn);
+	ptStart(&waiter.pt, waitFn);
+	ptStart(&eventer.pt, eventFn);
+	ptStart(&yielder.pt, yieldFn);
+
+	for (now = 0; now < TEST_TICKS; now++)
+	{
+		if (now == 7)
+			flag = 1;			/* no notification, found at the tick */
+		if (now == 12)
+			ptPost(&eventer.pt, EV_B);	/* not waited for yet */
+		if (now == 13)
+			ptPost(&eventer.pt, EV_A);
+		timeout = runTick();
+		if (now == 0 && (yielder.count != 3 || timeout != 1))
+			fail("wrong yields or sleep time");
+		xTaskIncrementTick();
+	}
+
+	if (delayer.at[0] != 5)
+		fail("PT_DELAY() ended at the wrong tick");
+	if (waiter.at[0] != 7)
+		fail("PT_WAIT_UNTIL() ended at the wrong tick");
+	if (eventer.at[0] != 10 || eventer.ev[0] != 0)
+		fail("the event wait didn't time out");
+	if (eventer.at[1] != 13 || eventer.ev[1] != EV_A)
+		fail("the posted event didn't end the wait");
+	if (eventer.at[2] != 13 || eventer.ev[2] != EV_B)
+		fail("the event posted before the wait was lost");
+	if (eventer.count != 0 || eventer.pt.events != 0)
+		fail("PT_EXIT() didn't exit");
+	if (ptList != NULL)
+		fail("the finished protothreads are still scheduled");
+}
+
+/**
+ * @brief	The scheduler task sleeps until the end of the delay, then for
+ * 			ever while the protothread waits for an event only.
+ */
+static void testSleep(void)
+{
+	portTickType start = xTaskGetTickCount();
+	int i;
+
+	ptStart(&sleeper.pt, sleepFn);
+	if (runTick() != 100)
+		fail("wrong sleep time during a delay");
+	for (i = 0; i < 40; i++)
+		xTaskIncrementTick();
+	if (ptRun() != 60)
+		fail("wrong sleep time later in the delay");
+	for (i = 0; i < 60; i++)
+		xTaskIncrementTick();
+	if (runTick() != portMAX_DELAY || sleeper.at[0] != start + 100)
+		fail("wrong sleep time during an event wait");
+	ptPost(&sleeper.pt, EV_C | EV_A);
+	runTick();
+	if (sleeper.ev[0] != EV_C || ptList != NULL)
+		fail("the event wait didn't end");
+}
+
+int main(void)
+{
+	/* the tick timer lists, as vTaskStartScheduler() does */
+	xTimerCreateTimerTask();
+	if (ptInit(tskIDLE_PRIORITY + 1, configMINIMAL_STACK_SIZE) != SUCCESS)
+		fail("ptInit() failed");
+
+	testWaits();
+	testSleep();
+	printf("test_pt: ok\n");
+	return 0;
+}
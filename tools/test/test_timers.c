@@ -0,0 +1,215 @@
+/*
+ * test_timers.c
+ *
+ * Host test of the software timers: the tick timers (xTimerCreateTick())
+ * against a model, with random start, stop and period changes across the
+ * tick wrap-around, and the timer service task handling all the timers
+ * expired at the same time in one pass. The kernel sources are included, so
+ * that the test reaches their static functions and data.
+ *
+ * Created on: 18 Oct 2026 (LNP)
+ *
+ * (c) 2026 Lixco Microsystems <lix@paulian.net>
+ */
+
+#include "../../FreeRTOS/tasks.c"
+#include "../../FreeRTOS/timers.c"
+
+#define TICK_TIMERS 50
+#define TICK_STEPS 2000000
+#define MAX_PERIOD 300
+#define DAEMON_TIMERS 8
+
+static TimerHandle_t tickTimer[TICK_TIMERS];
+static int64_t tickDue[TICK_TIMERS];		/* expected expiry, -1 if stopped */
+static uint32_t tickPeriod[TICK_TIMERS];
+static int tickReload[TICK_TIMERS];
+static long tickCalls;
+
+static int daemonCalls[DAEMON_TIMERS];
+static TCB_t idleTcb;
+static uint64_t rng = 88172645463325252ULL;
+
+/**
+ * @brief	Pseudo random numbers, xorshift.
+ * @return	the next number.
+ */
+static uint32_t rnd(void)
+{
+	rng ^= rng << 13;
+	rng ^= rng >> 7;
+	rng ^= rng << 17;
+	return (uint32_t) rng;
+}
+
+/**
+ * @brief	Stop the test.
+ * @param	msg: what went wrong.
+ */
+static void fail(const char *msg)
+{
+	printf("test_timers: %s (tick %08x)\n", msg, (unsigned) xTickCount);
+	exit(1);
+}
+
+/**
+ * @brief	Tick timer callback: check that it runs on time and update the
+ * 			model; sometimes stop the timer from the callback.
+ * @param	xTimer: the timer.
+ */
+static void tickCallback(TimerHandle_t xTimer)
+{
+	int i = (int) (intptr_t) pvTimerGetTimerID(xTimer);
+
+	if (tickDue[i] != (int64_t) xTickCount)
+		fail("tick timer expired at the wrong time");
+	tickCalls++;
+	tickDue[i] = tickReload[i] ? (int64_t) (TickType_t) (xTickCount + tickPeriod[i])
+			: -1;
+	if (rnd() % 50 == 0)
+	{
+		xTimerStop(xTimer, 0);
+		tickDue[i] = -1;
+	}
+}
+
+/**
+ * @brief	Tick timers against the model, starting just before the tick
+ * 			count wraps.
+ */
+static void testTickTimers(void)
+{
+	uint32_t r;
+	long n;
+	int i;
+
+	xTickCount = 0xFFFFF000;
+	for (i = 0; i < TICK_TIMERS; i++)
+	{
+		tickPeriod[i] = 1 + rnd() % MAX_PERIOD;
+		tickReload[i] = rnd() & 1;
+		tickDue[i] = -1;
+		tickTimer[i] = xTimerCreateTick("tick", tickPeriod[i], tickReload[i],
+				(void *) (intptr_t) i, tickCallback);
+		if (!tickTimer[i])
+			fail("xTimerCreateTick() failed");
+	}
+
+	for (n = 0; n < TICK_STEPS; n++)
+	{
+		i = rnd() % TICK_TIMERS;
+		r = rnd() % 100;
+		if (r < 2)
+		{
+			xTimerStart(tickTimer[i], 0);
+			tickDue[i] = (TickType_t) (xTickCount + tickPeriod[i]);
+		}
+		else if (r < 3)
+		{
+			xTimerStop(tickTimer[i], 0);
+			tickDue[i] = -1;
+		}
+		else if (r < 4)
+		{
+			tickPeriod[i] = 1 + rnd() % MAX_PERIOD;
+			xTimerChangePeriod(tickTimer[i], tickPeriod[i], 0);
+			tickDue[i] = (TickType_t) (xTickCount + tickPeriod[i]);
+		}
+		else
+		{
+			xTaskIncrementTick();
+			for (i = 0; i < TICK_TIMERS; i++)
+			{
+				/* a due time in the past was missed */
+				if (tickDue[i] >= 0
+						&& (TickType_t) (tickDue[i] - xTickCount) > 0x80000000)
+					fail("tick timer missed");
+				if ((xTimerIsTimerActive(tickTimer[i]) != pdFALSE)
+						!= (tickDue[i] >= 0))
+					fail("tick timer state differs from the model");
+			}
+		}
+	}
+	if (xTimerQueue != NULL)
+		fail("tick timers created the service task queue");
+}
+
+/**
+ * @brief	Daemon timer callback: count the calls.
+ * @param	xTimer: the timer.
+ */
+static void daemonCallback(TimerHandle_t xTimer)
+{
+	daemonCalls[(intptr_t) pvTimerGetTimerID(xTimer)]++;
+}
+
+/**
+ * @brief	Run the service task loop once, as prvTimerTask() does, when a
+ * 			timer expired (it would block otherwise).
+ */
+static void daemonStep(void)
+{
+	TickType_t next;
+	BaseType_t empty;
+
+	next = prvGetNextExpireTime(&empty);
+	if (!empty && next <= xTaskGetTickCount())
+		prvProcessTimerOrBlockTask(next, empty);
+	prvProcessReceivedCommands();
+}
+
+/**
+ * @brief	Timers of the service task expiring at the same tick are all
+ * 			handled by one pass, later ones are left alone; the auto reload
+ * 			ones expire again one period later.
+ */
+static void testDaemonBatch(void)
+{
+	TimerHandle_t timer[DAEMON_TIMERS];
+	int i, k;
+
+	xTickCount = 1000;
+	for (i = 0; i < DAEMON_TIMERS; i++)
+	{
+		/* the last one expires later than the others */
+		timer[i] = xTimerCreate("daemon", i < DAEMON_TIMERS - 1 ? 10 : 25,
+				i & 1, (void *) (intptr_t) i, daemonCallback);
+		if (!timer[i] || xTimerStart(timer[i], 0) != pdPASS)
+			fail("daemon timer creation failed");
+	}
+	prvProcessReceivedCommands();
+
+	for (k = 0; k < 10; k++)
+		xTaskIncrementTick();
+	daemonStep();
+	for (i = 0; i < DAEMON_TIMERS; i++)
+	{
+		if (daemonCalls[i] != (i < DAEMON_TIMERS - 1))
+			fail("the expired timers weren't handled in one pass");
+	}
+
+	for (k = 0; k < 10; k++)
+	{
+		xTaskIncrementTick();
+		daemonStep();
+	}
+	for (i = 0; i < DAEMON_TIMERS - 1; i++)
+	{
+		if (daemonCalls[i] != 1 + (i & 1))
+			fail("wrong number of daemon timer expiries");
+	}
+	if (daemonCalls[DAEMON_TIMERS - 1] != 0)
+		fail("the later daemon timer expired");
+}
+
+int main(void)
+{
+	idleTcb.uxPriority = tskIDLE_PRIORITY;
+	pxCurrentTCB = &idleTcb;
+	prvInitialiseTaskLists();
+
+	testTickTimers();
+	testDaemonBatch();
+	printf("test_timers: ok, %ld tick timer expiries\n", tickCalls);
+	return 0;
+}